@@ -0,0 +1,46 @@
+; Общие константы раскладки загрузочного образа
+; ------------------------------------------------------------------------------
+;	Образ дискеты:
+;		LBA 0                       - загрузочный сектор (bootsect.asm)
+;		LBA 1..STAGE2_SECTORS       - второй этап загрузчика (stage2.asm)
+;		LBA KERNEL_LBA..            - ядро, начинается с заголовка
+;		сразу за ядром              - initrd: сектор заголовка и архив
+;	Заголовок ядра (kernel_entry.asm, первые байты образа):
+;		+0  dd KERNEL_MAGIC
+;		+4  dd размер образа в секторах
+;		+8  dd адрес точки входа
+;		+12 dd начало .bss
+;		+16 dd конец .bss
+;	Заголовок initrd (initrd.asm, целый сектор):
+;		+0  dd INITRD_MAGIC
+;		+4  dd размер архива в байтах (архив начинается со следующего сектора)
+;	Информация для ядра (BOOT_INFO_ADDR, передается в EBX, см. boot_info.h):
+;		+0  dd количество записей карты памяти E820
+;		+4  dd физический адрес initrd (0 - нет)
+;		+8  dd размер initrd в байтах
+;		+16 записи E820 по 24 байта (не больше E820_MAX_ENTRIES)
+; ------------------------------------------------------------------------------
+
+STAGE2_OFFSET    equ 0x7e00         ; Второй этап грузится сразу за загрузочным сектором
+STAGE2_SECTORS   equ 8              ; Размер второго этапа (8 * 512 = 4 KB)
+
+KERNEL_LBA       equ 1 + STAGE2_SECTORS
+KERNEL_LOAD_ADDR equ 0x100000       ; Ядро размещается выше первого мегабайта
+KERNEL_MAGIC     equ 0x4b52_4151    ; "QARK" в памяти
+
+KHDR_MAGIC       equ 0
+KHDR_SECTORS     equ 4
+KHDR_ENTRY       equ 8
+KHDR_BSS_END     equ 16
+
+INITRD_MAGIC     equ 0x4452_4951    ; "QIRD" в памяти
+IHDR_MAGIC       equ 0
+IHDR_SIZE        equ 4
+
+BOOT_INFO_ADDR   equ 0x1000         ; Страница свободной памяти ниже загрузчика
+BI_E820_COUNT    equ 0
+BI_INITRD_ADDR   equ 4
+BI_INITRD_SIZE   equ 8
+BI_E820_ENTRIES  equ 16
+E820_ENTRY_SIZE  equ 24
+E820_MAX_ENTRIES equ 64
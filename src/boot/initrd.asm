@@ -0,0 +1,18 @@
+; Образ initrd: сектор заголовка и архив cpio (newc) из build/initrd.cpio
+; ------------------------------------------------------------------------------
+;	Второй этап загрузчика ищет заголовок в секторе сразу за ядром и
+;	копирует архив на границу страницы за .bss ядра (см. stage2.asm).
+;	Архив дополняется нулями до целого сектора.
+; ------------------------------------------------------------------------------
+
+%include "boot_layout.asm"
+
+    dd INITRD_MAGIC
+    dd archive_end - archive    ; Размер архива в байтах
+    times 512-($-$$) db 0
+
+archive:
+    incbin "initrd.cpio"
+archive_end:
+
+    times (512 - ($-$$) % 512) % 512 db 0
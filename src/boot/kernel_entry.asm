@@ -2,17 +2,94 @@
 ;------------------------------------------------------------------------------
 ; Точка входа в ядро после перехода в защищённый 32-битный режим.
 ; Здесь начинается выполнение кода на уровне ядра ОС.
+; Образ ядра начинается с заголовка (секция .header, формат описан в
+; boot_layout.asm): по нему второй этап загрузчика узнает размер образа
+; и адрес точки входа. Символы _kernel_sectors, _bss_start и _bss_end
+; вычисляет компоновщик (kernel/linker.ld).
+; Ядро скомпоновано для верхней половины (KERNEL_VIRT_BASE + физический
+; адрес), а загрузчик передает управление при выключенной страничной
+; адресации. Поэтому до включения PG код обращается к памяти только по
+; физическим адресам (символ - KERNEL_VIRT_BASE), а переходы относительные.
 ; ------------------------------------------------------------------------------
 
 [bits 32]          ; Указываем, что последующий код предназначен для 32-битного защищённого режима
 
+%include "boot_layout.asm"
+
+KERNEL_VIRT_BASE equ 0xC0000000 ; Должно совпадать с mm/paging.h
+DIRECT_MAP_PDES  equ 192        ; 768 MB прямого отображения страницами 4 MB
+BOOT_STACK_SIZE  equ 0x4000
+
+PDE_BOOT_FLAGS   equ 0x83       ; Present | Write | Large (4 MB)
+CR4_PSE          equ 0x10
+CR0_PG_WP        equ 0x80010000 ; PG и WP (запись в RO-страницы запрещена и ядру)
+
 [extern kmain]     ; Объявляем внешнюю функцию (из kernel.c), которую будем вызывать
                    ; Компилятор C скомпилирует kmain как символ, доступный извне
+[extern _kernel_sectors]
+[extern _bss_start]
+[extern _bss_end]
+
+section .header
+kernel_header:
+    dd KERNEL_MAGIC    ; Сигнатура для проверки загрузчиком
+    dd _kernel_sectors ; Размер образа в секторах
+    dd _start - KERNEL_VIRT_BASE     ; Физический адрес точки входа
+    dd _bss_start - KERNEL_VIRT_BASE ; Границы .bss: в образ она не входит,
+    dd _bss_end - KERNEL_VIRT_BASE   ; поэтому ее нужно обнулить здесь
+
+section .text
+global _start
+_start:
+    ; EBX - физический адрес boot_info_t от загрузчика, код ниже его не портит
+    ; Обнуляем .bss: за образом в памяти лежит мусор
+    mov edi, _bss_start - KERNEL_VIRT_BASE
+    mov ecx, _bss_end - KERNEL_VIRT_BASE
+    sub ecx, edi
+    xor eax, eax
+    cld
+    rep stosb
+
+    ; Каталог страниц: 0-4 MB тождественно (исполняемся здесь до прыжка),
+    ; 0-768 MB еще раз начиная с KERNEL_VIRT_BASE. Все страницы по 4 MB,
+    ; таблицы страниц не нужны. Тождественное окно убирает paging_init()
+    mov edi, boot_page_directory - KERNEL_VIRT_BASE
+    mov dword [edi], PDE_BOOT_FLAGS
+    lea edx, [edi + (KERNEL_VIRT_BASE >> 22) * 4]
+    mov eax, PDE_BOOT_FLAGS
+    mov ecx, DIRECT_MAP_PDES
+.fill_pde:
+    mov [edx], eax
+    add eax, 0x400000
+    add edx, 4
+    loop .fill_pde
+
+    mov eax, cr4
+    or eax, CR4_PSE    ; Страницы 4 MB
+    mov cr4, eax
+    mov cr3, edi
+    mov eax, cr0
+    or eax, CR0_PG_WP
+    mov cr0, eax
+
+    mov eax, .higher_half ; Абсолютный (виртуальный) адрес
+    jmp eax
+.higher_half:
+    mov esp, boot_stack_top ; Стек загрузчика (0x90000) станет недоступен
+    add ebx, KERNEL_VIRT_BASE
+    push ebx           ; Аргумент kmain(boot_info_t *)
+    call kmain         ; Вызываем функцию kmain
+                       ; Здесь фактически передаётся управление ядру, написанному на C
 
-call kmain         ; Вызываем функцию kmain
-                   ; Здесь фактически передаётся управление ядру, написанному на C
+    jmp $              ; Бесконечный цикл: остаёмся здесь после завершения kmain
+                       ; Символ "$" означает текущий адрес, то есть jmp $ — это "прыжок на самого себя"
+                       ; Нужно для предотвращения "проваливания" в непредсказуемую область памяти,
+                       ; если kmain вдруг вернётся (что не предполагается)
 
-jmp $              ; Бесконечный цикл: остаёмся здесь после завершения kmain
-                   ; Символ "$" означает текущий адрес, то есть jmp $ — это "прыжок на самого себя"
-                   ; Нужно для предотвращения "проваливания" в непредсказуемую область памяти,
-                   ; если kmain вдруг вернётся (что не предполагается)
+section .bss align=4096
+global boot_page_directory
+boot_page_directory:
+    resb 4096          ; Каталог страниц ядра (mm/paging.c)
+boot_stack:
+    resb BOOT_STACK_SIZE
+boot_stack_top:
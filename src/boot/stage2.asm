@@ -0,0 +1,385 @@
+; Второй этап загрузчика: загрузка ядра выше 1 MB
+; ------------------------------------------------------------------------------
+;	1. Включает линию A20, без нее адреса выше 1 MB заворачиваются в ноль.
+;	2. Переходит в unreal mode: на мгновение включает защищенный режим,
+;	загружает в DS/ES 4-гигабайтный сегмент данных из GDT и возвращается в
+;	реальный режим. Процессор хранит лимит в скрытой части сегментного
+;	регистра, поэтому BIOS остается доступен, а 32-битные адреса работают.
+;	3. Читает первый сектор ядра и берет размер образа из заголовка
+;	(см. boot_layout.asm) вместо фиксированного числа секторов.
+;	4. Читает ядро крупными блоками в буфер ниже 1 MB и копирует каждый
+;	блок на место через "a32 rep movsd":
+;		- INT 13h AH=42h (расширенное чтение по LBA), до 127 секторов за вызов;
+;		- если расширений нет - INT 13h AH=02h по целой дорожке за вызов.
+;	5. Если за ядром лежит initrd, тем же способом копирует его за .bss
+;	ядра и записывает адрес и размер в BOOT_INFO_ADDR.
+;	6. Собирает карту памяти INT 15h E820 в BOOT_INFO_ADDR.
+;	7. Переключается в защищенный режим и прыгает на точку входа ядра,
+;	передавая адрес информации о загрузке в EBX.
+; ------------------------------------------------------------------------------
+
+[org 0x7e00]
+
+%include "boot_layout.asm"
+
+BOUNCE_SEG      equ 0x1000      ; Буфер чтения 0x10000-0x1ffff: 64 KB,
+BOUNCE_ADDR     equ 0x10000     ; выровнен, не пересекает границу DMA
+EDD_MAX_SECTORS equ 127         ; Предел AH=42h у многих BIOS
+DISK_RETRIES    equ 3           ; Попыток чтения CHS (дискеты ошибаются)
+
+[bits 16]
+stage2_start:
+    mov [BOOT_DRIVE], dl
+
+    mov bx, MSG_STAGE2
+    call print_string
+
+    call enable_a20
+    call enter_unreal
+    call detect_disk
+
+    ; Первый сектор ядра - заголовок с размером образа
+    mov eax, KERNEL_LBA
+    mov ecx, 1
+    call read_chunk
+    call enter_unreal
+
+    mov esi, BOUNCE_ADDR
+    cmp dword [esi + KHDR_MAGIC], KERNEL_MAGIC
+    jne bad_kernel
+
+    mov ecx, [esi + KHDR_SECTORS]
+    mov [sectors_left], ecx
+    mov dword [load_lba], KERNEL_LBA
+    mov dword [load_dest], KERNEL_LOAD_ADDR
+
+    mov bx, MSG_LOAD_KERNEL
+    call print_string
+    call load_image
+
+    call load_initrd
+    call detect_memory
+    call switch_to_pm           ; Из switch.asm, возвращается в BEGIN_PM
+    jmp $
+
+; ------------------------------------------------------------------------------
+; Чтение образа выше 1 MB через буфер
+; Вход: sectors_left, load_lba, load_dest
+; Выход: load_lba - сектор за образом
+; ------------------------------------------------------------------------------
+load_image:
+    mov ecx, [sectors_left]
+    test ecx, ecx
+    jz .done
+
+    mov eax, [load_lba]
+    call read_chunk             ; ECX = сколько секторов реально прочитано
+    add [load_lba], ecx
+    sub [sectors_left], ecx
+
+    push ecx
+    call enter_unreal           ; BIOS мог перезагрузить сегментные регистры
+    pop ecx
+
+    mov esi, BOUNCE_ADDR
+    mov edi, [load_dest]
+    shl ecx, 7                  ; Сектор = 128 двойных слов
+    cld
+    a32 rep movsd               ; DS:ESI -> ES:EDI с 32-битными адресами
+    mov [load_dest], edi
+    jmp load_image
+.done:
+    ret
+
+; ------------------------------------------------------------------------------
+; Загрузка initrd, если за ядром лежит его заголовок (см. boot_layout.asm)
+; Архив кладется на границу страницы за .bss ядра: ядро обнуляет .bss
+; при старте и затерло бы все, что лежит вплотную к образу
+; ------------------------------------------------------------------------------
+load_initrd:
+    mov dword [BOOT_INFO_ADDR + BI_INITRD_ADDR], 0
+    mov dword [BOOT_INFO_ADDR + BI_INITRD_SIZE], 0
+
+    mov eax, [load_lba]
+    mov ecx, 1
+    call read_chunk
+    call enter_unreal
+
+    mov esi, BOUNCE_ADDR
+    cmp dword [esi + IHDR_MAGIC], INITRD_MAGIC
+    jne .done
+
+    mov ecx, [esi + IHDR_SIZE]
+    mov edi, [dword KERNEL_LOAD_ADDR + KHDR_BSS_END]
+    add edi, 0xfff
+    and edi, ~0xfff
+    mov [BOOT_INFO_ADDR + BI_INITRD_ADDR], edi
+    mov [BOOT_INFO_ADDR + BI_INITRD_SIZE], ecx
+    mov [load_dest], edi
+
+    add ecx, 511
+    shr ecx, 9
+    mov [sectors_left], ecx
+    inc dword [load_lba]        ; Архив - со следующего за заголовком сектора
+
+    mov bx, MSG_LOAD_INITRD
+    call print_string
+    call load_image
+.done:
+    ret
+
+; ------------------------------------------------------------------------------
+; Включение линии A20: сначала через BIOS, затем через "быстрый" порт 0x92
+; ------------------------------------------------------------------------------
+enable_a20:
+    mov ax, 0x2401
+    int 0x15
+    in al, 0x92
+    or al, 0x02                 ; Бит 1 - A20
+    and al, 0xfe                ; Бит 0 - сброс процессора, не трогаем
+    out 0x92, al
+    ret
+
+; ------------------------------------------------------------------------------
+; Сбор карты физической памяти через INT 15h, EAX=E820h
+; ------------------------------------------------------------------------------
+detect_memory:
+    mov dword [BOOT_INFO_ADDR + BI_E820_COUNT], 0
+    mov di, BOOT_INFO_ADDR + BI_E820_ENTRIES    ; ES:DI - буфер записи (ES = 0)
+    xor ebx, ebx                                ; Значение продолжения: начало
+
+.next:
+    mov dword [di + 20], 1      ; Расширенные атрибуты ACPI 3.0 по умолчанию "валидна"
+    mov eax, 0xe820
+    mov edx, 0x534d4150         ; "SMAP"
+    mov ecx, E820_ENTRY_SIZE
+    int 0x15
+    jc .done                    ; CF после первой записи - конец списка
+    cmp eax, 0x534d4150
+    jne .done
+
+    mov ecx, [di + 8]           ; Записи нулевой длины пропускаем
+    or ecx, [di + 12]
+    jz .skip
+
+    add di, E820_ENTRY_SIZE
+    inc dword [BOOT_INFO_ADDR + BI_E820_COUNT]
+    cmp dword [BOOT_INFO_ADDR + BI_E820_COUNT], E820_MAX_ENTRIES
+    jae .done
+
+.skip:
+    test ebx, ebx               ; EBX = 0 - последняя запись
+    jnz .next
+.done:
+    ret
+
+; ------------------------------------------------------------------------------
+; Переход в unreal mode: DS и ES получают лимит 4 GB при нулевой базе
+; ------------------------------------------------------------------------------
+enter_unreal:
+    push eax
+    push bx
+    cli
+    push ds
+    push es
+
+    lgdt [gdt_descriptor]
+    mov eax, cr0
+    or al, 1
+    mov cr0, eax
+    jmp $+2                     ; Сброс конвейера после смены режима
+
+    mov bx, DATA_SEG            ; Загружаем дескриптор с лимитом 4 GB
+    mov ds, bx
+    mov es, bx
+
+    and al, 0xfe                ; Обратно в реальный режим,
+    mov cr0, eax                ; лимит остается в кэше дескриптора
+
+    pop es
+    pop ds
+    sti
+    pop bx
+    pop eax
+    ret
+
+; ------------------------------------------------------------------------------
+; Определение способа чтения: расширения INT 13h и геометрия для CHS
+; ------------------------------------------------------------------------------
+detect_disk:
+    mov ah, 0x41                ; Проверка расширений EDD
+    mov bx, 0x55aa
+    mov dl, [BOOT_DRIVE]
+    int 0x13
+    jc .geometry
+    cmp bx, 0xaa55
+    jne .geometry
+    test cx, 1                  ; Бит 0 - пакетный доступ (AH=42h)
+    jz .geometry
+    mov byte [edd_supported], 1
+
+.geometry:
+    push es                     ; Для дискет AH=08h портит ES:DI
+    xor di, di
+    mov ah, 0x08
+    mov dl, [BOOT_DRIVE]
+    int 0x13
+    pop es
+    jc .done                    ; Оставляем геометрию дискеты 1.44 MB
+
+    and cx, 0x3f                ; Биты 0-5 CL - последний сектор дорожки
+    mov [sectors_per_track], cx
+    movzx dx, dh                ; DH - последняя головка
+    inc dx
+    mov [heads], dx
+.done:
+    ret
+
+; ------------------------------------------------------------------------------
+; Чтение блока секторов в буфер BOUNCE_ADDR
+; Вход:  EAX - LBA первого сектора, ECX - сколько секторов нужно (>0)
+; Выход: ECX - сколько прочитано (не больше размера буфера или дорожки)
+; ------------------------------------------------------------------------------
+read_chunk:
+    cmp byte [edd_supported], 1
+    jne read_chunk_chs
+
+    cmp ecx, EDD_MAX_SECTORS
+    jbe .count_ok
+    mov ecx, EDD_MAX_SECTORS
+.count_ok:
+    mov [dap_count], cx
+    mov [dap_lba], eax
+    mov word [dap_offset], 0
+    mov word [dap_segment], BOUNCE_SEG
+
+    push eax
+    push ecx
+    mov si, dap
+    mov ah, 0x42
+    mov dl, [BOOT_DRIVE]
+    int 0x13
+    pop ecx
+    pop eax
+    jnc .done
+
+    mov byte [edd_supported], 0 ; Расширения есть, но не работают -
+    jmp read_chunk_chs          ; дальше читаем по дорожкам
+.done:
+    ret
+
+read_chunk_chs:
+    mov [chs_wanted], ecx
+
+    xor edx, edx
+    movzx ebx, word [sectors_per_track]
+    div ebx                     ; EAX = номер дорожки, EDX = сектор на ней
+    mov [chs_sector], dl
+
+    movzx ecx, word [sectors_per_track]
+    sub ecx, edx                ; Читаем до конца дорожки,
+    cmp ecx, [chs_wanted]       ; но не больше, чем просили
+    jbe .count_ok
+    mov ecx, [chs_wanted]
+.count_ok:
+    mov [chs_count], cl
+
+    xor edx, edx
+    movzx ebx, word [heads]
+    div ebx                     ; EAX = цилиндр, EDX = головка
+
+    mov dh, dl                  ; Головка
+    mov ch, al                  ; Младшие 8 бит цилиндра
+    shl ah, 6                   ; Биты 8-9 цилиндра -> биты 6-7 CL
+    mov cl, [chs_sector]
+    inc cl                      ; Сектора нумеруются с 1
+    or cl, ah
+    mov al, [chs_count]
+    mov ah, 0x02
+    mov dl, [BOOT_DRIVE]
+
+    mov bx, BOUNCE_SEG
+    mov es, bx
+    xor bx, bx
+    mov di, DISK_RETRIES
+
+.retry:
+    pusha
+    int 0x13
+    jnc .ok
+    xor ah, ah                  ; Сброс контроллера и повтор
+    mov dl, [BOOT_DRIVE]
+    int 0x13
+    popa
+    dec di
+    jnz .retry
+    jmp disk_failed
+
+.ok:
+    popa
+    xor bx, bx
+    mov es, bx
+    movzx ecx, byte [chs_count]
+    ret
+
+disk_failed:
+    xor bx, bx
+    mov es, bx
+    mov bx, MSG_DISK_ERROR
+    call print_string
+    jmp $
+
+bad_kernel:
+    mov bx, MSG_BAD_KERNEL
+    call print_string
+    jmp $
+
+; Подключаемые модули
+%include "print_string.asm"
+%include "print_string_pm.asm"
+%include "switch.asm"
+%include "gdt.asm"
+
+; ------------ Код защищенного режима (32-битный) ------------
+[bits 32]
+BEGIN_PM:
+    mov ebx, MSG_PROT_MODE      ; Сообщение в защищенном режиме
+    call print_string_pm
+
+    mov eax, [KERNEL_LOAD_ADDR + KHDR_ENTRY]
+    mov ebx, BOOT_INFO_ADDR     ; Информация о загрузке для kmain()
+    call eax                    ; Передаем управление ядру
+    jmp $                       ; Резервный бесконечный цикл
+
+; ------------ Данные программы ------------
+BOOT_DRIVE:         db 0
+edd_supported:      db 0
+sectors_per_track:  dw 18       ; Геометрия по умолчанию: дискета 1.44 MB
+heads:              dw 2
+
+sectors_left:       dd 0
+load_lba:           dd 0
+load_dest:          dd 0
+
+chs_wanted:         dd 0
+chs_sector:         db 0
+chs_count:          db 0
+
+; Пакет адреса диска для INT 13h AH=42h
+align 4
+dap:
+                    db 0x10     ; Размер пакета
+                    db 0
+dap_count:          dw 0        ; Количество секторов
+dap_offset:         dw 0        ; Буфер: смещение
+dap_segment:        dw 0        ;        сегмент
+dap_lba:            dq 0        ; Номер первого сектора
+
+MSG_STAGE2:         db "Stage 2 started", 0
+MSG_LOAD_KERNEL:    db "Loading kernel above 1 MB...", 0
+MSG_LOAD_INITRD:    db "Loading initrd...", 0
+MSG_PROT_MODE:      db "Switched to PROTECTED MODE", 0
+MSG_DISK_ERROR:     db "Kernel read error! :(", 0
+MSG_BAD_KERNEL:     db "Bad kernel header! :(", 0
+
+times STAGE2_SECTORS*512-($-$$) db 0 ; Второй этап занимает ровно STAGE2_SECTORS
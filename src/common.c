@@ -10,54 +10,8 @@
 #include "common.h"
 #include "drivers/screen.h"
 #include "drivers/print.h"
-
-/**
- * @brief Копирует данные между буферами памяти
- * @param[in] src Указатель на источник данных (read-only)
- * @param[out] dst Указатель на приемник данных
- * @param[in] len Количество байт для копирования
- *
- * @note Особенности:
- * - Побайтовое копирование без оптимизаций
- * - Поддерживает длину до 4GB (U32_MAX)
- *
- * @warning:
- * - Не проверяет валидность указателей
- * - Не обрабатывает перекрывающиеся области памяти
- * - Для больших блоков используйте оптимизированную версию
- */
-void memcpy(const u8 *src, u8 *dst, const u32 len) {
-    u32 i = 0;
-    while (i < len) {
-	    dst[i] = src[i];
-        i++;
-    }
-}
-
-/**
- * @brief Сравнивает две строки
- * @param[in] s1 Первая строка для сравнения
- * @param[in] s2 Вторая строка для сравнения
- * @return Разницу ASCII-кодов первых различных символов:
- *         - 0: строки идентичны
- *         - >0: s1 > s2
- *         - <0: s1 < s2
- *
- * @note Сравнение прекращается при:
- * - Обнаружении первого несовпадения
- * - Достижении конца любой из строк
- *
- */
-int strcmp(const char *s1, const char *s2) {
-    // Пока символы совпадают и не достигнут конец строки
-    while (*s1 && (*s1 == *s2)) {
-        s1++;
-        s2++;
-    }
-
-    // Возвращаем разницу между ASCII-кодами символов
-    return *(const unsigned char*)s1 - *(const unsigned char*)s2;
-}
+#include "fs/vfs.h"
+#include "kernel/command.h"
 
 /**
  * @brief Выводит строку с цветовыми атрибутами
@@ -84,23 +38,13 @@ void kprint_colored(u8 *str, u8 attr) {
 /**
  * @brief Выводит ASCII-арт коровы
  *
- * @note Использует многострочный массив:
- * - 5 строк ASCII-арта
- * - Цветовая схема: синий текст на белом фоне (0x01)
+ * @note Рисунок лежит в initrd (/cow.txt) и печатается прямо из памяти
+ * архива. Цветовая схема: синий текст на черном фоне (0x01)
  *
  */
 void print_cow() {
-    const char *cow_art[] = {
-        "  ^__^                             \n",
-        "  (oo)\\_______                     \n",
-        "  (__)\\       )\\/\\                \n",
-        "      ||----w |                    \n",
-        "      ||     ||                    \n"
-    };
-
-    // Печатаем каждую строку ASCII-арта
-    for (int i = 0; i < sizeof(cow_art) / sizeof(cow_art[0]); i++) {
-        colored_print(0x01, "%s", cow_art[i]);
+    if (vfs_print_file(COW_ART_PATH, 0x01) != 0) {
+        colored_print(0x04, "%s not found (no initrd?)\n", COW_ART_PATH);
     }
 }
 
@@ -156,4 +100,18 @@ void print_rick_and_morty() {
     }
 }
 
+static s32 cmd_cow(u32 argc, char **argv) {
+    printf("\n");
+    print_cow();
+    return 0;
+}
+
+static s32 cmd_rimo(u32 argc, char **argv) {
+    print_rick_and_morty();
+    return 0;
+}
+
+COMMAND("cow", cmd_cow, "", "Show ASCII art cow");
+COMMAND("rimo", cmd_rimo, "", "Rick and Morty art");
+
 /** @} */ // Конец группы common
\ No newline at end of file
@@ -5,6 +5,8 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+typedef unsigned long long u64;
+typedef long long s64;
 typedef unsigned int u32;
 typedef int s32;
 typedef unsigned short u16;
@@ -12,8 +14,28 @@ typedef short s16;
 typedef unsigned char u8;
 typedef char s8;
 
-void memcpy(const u8 *src, u8 *dst, u32 len);
-int strcmp(const char *s1, const char *s2);
+/**
+ * @brief Делит 64-битное число на 32-битное
+ * @param[in,out] value Делимое, заменяется частным
+ * @param[in] base Делитель
+ * @return Остаток
+ *
+ * @note Две инструкции DIV по 32 бита вместо вызова __udivdi3 из libgcc,
+ *       которой во freestanding-сборке нет
+ */
+static inline u32 div64(u64 *value, const u32 base) {
+    u32 high = (u32) (*value >> 32);
+    u32 low = (u32) *value;
+    u32 rem = high % base;
+
+    high /= base;
+    __asm__("divl %2" : "+a" (low), "+d" (rem) : "rm" (base));
+    *value = ((u64) high << 32) | low;
+    return rem;
+}
+
+#define COW_ART_PATH "/cow.txt"
+
 void print_cow();
 void print_rick_and_morty();
 
@@ -0,0 +1,31 @@
+; Переключение контекста потоков ядра
+; ------------------------------------------------------------------------------
+;	switch_context(u32 *old_esp, u32 new_esp)
+;	Сохраняет на стеке текущего потока регистры, которые по cdecl обязан
+;	сохранять вызываемый (EBX, ESI, EDI, EBP), запоминает ESP в *old_esp и
+;	переходит на стек нового потока. EIP сохранять не нужно: он уже лежит
+;	на стеке как адрес возврата из switch_context.
+;	Остальные регистры и EFLAGS сохраняет вызывающий код (sched.c).
+; ------------------------------------------------------------------------------
+
+[bits 32]
+
+global switch_context
+
+switch_context:
+	mov eax, [esp + 4]      ; old_esp
+	mov edx, [esp + 8]      ; new_esp
+
+	push ebp
+	push ebx
+	push esi
+	push edi
+
+	mov [eax], esp
+	mov esp, edx
+
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
+	ret
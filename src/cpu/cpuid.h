@@ -0,0 +1,64 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef CPUID_H
+#define CPUID_H
+
+#include "../common.h"
+
+// CPUID.01h:EDX
+#define CPUID_FEAT_EDX_TSC   (1 << 4)
+#define CPUID_FEAT_EDX_PSE   (1 << 3)
+#define CPUID_FEAT_EDX_MSR   (1 << 5)
+#define CPUID_FEAT_EDX_APIC  (1 << 9)
+#define CPUID_FEAT_EDX_SEP   (1 << 11)
+#define CPUID_FEAT_EDX_PGE   (1 << 13)
+
+// CPUID.01h:ECX
+#define CPUID_FEAT_ECX_TSC_DEADLINE (1 << 24)
+
+// CPUID.07h.0:EBX
+#define CPUID_EXT_EBX_ERMS   (1 << 9)
+
+/**
+ * Выполнение инструкции CPUID.
+ *
+ * @param leaf    Номер листа (EAX)
+ * @param subleaf Номер подлиста (ECX)
+ * @param a,b,c,d Результаты EAX, EBX, ECX, EDX
+ */
+static inline void cpuid(u32 leaf, u32 subleaf, u32 *a, u32 *b, u32 *c, u32 *d) {
+    __asm__ volatile("cpuid"
+        : "=a" (*a), "=b" (*b), "=c" (*c), "=d" (*d)
+        : "a" (leaf), "c" (subleaf));
+}
+
+/**
+ * Максимальный поддерживаемый базовый лист CPUID.
+ */
+static inline u32 cpuid_max_leaf() {
+    u32 a, b, c, d;
+    cpuid(0, 0, &a, &b, &c, &d);
+    return a;
+}
+
+/**
+ * Флаги возможностей CPUID.01h:EDX.
+ */
+static inline u32 cpuid_features_edx() {
+    u32 a, b, c, d;
+    cpuid(1, 0, &a, &b, &c, &d);
+    return d;
+}
+
+/**
+ * Флаги возможностей CPUID.01h:ECX.
+ */
+static inline u32 cpuid_features_ecx() {
+    u32 a, b, c, d;
+    cpuid(1, 0, &a, &b, &c, &d);
+    return c;
+}
+
+#endif //CPUID_H
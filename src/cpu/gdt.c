@@ -0,0 +1,121 @@
+/**
+* @file gdt.c
+ * @brief Глобальные таблицы дескрипторов процессоров
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup gdt Таблица дескрипторов
+ * @{
+ */
+
+#include "gdt.h"
+#include "../kernel/smp.h"
+
+/**
+ * @brief Своя таблица у каждого процессора
+ * @details Таблицы различаются только базой сегмента GDT_PERCPU, поэтому
+ * один и тот же селектор в %gs у каждого процессора указывает на его запись
+ * percpu[], и дескриптором TSS: у каждого процессора свой стек ядра для
+ * входа из кольца 3.
+ */
+static gdt_entry_t gdt[SMP_MAX_CPUS][GDT_ENTRIES];
+static gdt_register_t gdt_reg[SMP_MAX_CPUS];
+static tss_t tss[SMP_MAX_CPUS];
+
+/**
+ * @brief Заполняет дескриптор сегмента
+ * @param[in] cpu    Номер процессора (таблицы)
+ * @param[in] n      Номер дескриптора
+ * @param[in] base   Базовый адрес
+ * @param[in] limit  Лимит (20 бит)
+ * @param[in] access Байт доступа (P, DPL, S, тип)
+ * @param[in] flags  Флаги G, D/B (старшие 4 бита)
+ */
+void gdt_set_gate(const u32 cpu, const u32 n, const u32 base, const u32 limit,
+                  const u8 access, const u8 flags) {
+    gdt_entry_t *entry = &gdt[cpu][n];
+
+    entry->limit_low = limit & 0xFFFF;
+    entry->base_low = base & 0xFFFF;
+    entry->base_mid = (base >> 16) & 0xFF;
+    entry->access = access;
+    entry->granularity = (flags & 0xF0) | ((limit >> 16) & 0x0F);
+    entry->base_high = (base >> 24) & 0xFF;
+}
+
+/**
+ * @brief Собирает и загружает GDT процессора, перезагружает сегментные регистры
+ * @param[in] cpu Номер процессора; его запись percpu[] становится доступна
+ *                через %gs
+ *
+ * @note Вызывает сам процессор: загрузочный - из gdt_init(), AP - из
+ *       ap_main() (smp.c)
+ */
+void gdt_init_cpu(const u32 cpu) {
+    percpu_t *pc = &percpu[cpu];
+
+    pc->self = pc;
+    pc->id = cpu;
+
+    gdt_set_gate(cpu, 0, 0, 0, 0, 0);
+    gdt_set_gate(cpu, 1, 0, 0xFFFFF, 0x9A, 0xC0); // Код ядра: 4 GB, 32 бита
+    gdt_set_gate(cpu, 2, 0, 0xFFFFF, 0x92, 0xC0); // Данные ядра
+    gdt_set_gate(cpu, 3, 0, 0xFFFFF, 0xFA, 0xC0); // Код пользователя: DPL 3
+    gdt_set_gate(cpu, 4, 0, 0xFFFFF, 0xF2, 0xC0); // Данные пользователя
+    gdt_set_gate(cpu, 5, (u32) pc, sizeof(percpu_t) - 1, 0x92, 0x40); // Данные процессора
+
+    tss[cpu].ss0 = GDT_KERNEL_DATA;
+    tss[cpu].iomap_base = sizeof(tss_t);
+    gdt_set_gate(cpu, 6, (u32) &tss[cpu], sizeof(tss_t) - 1, 0x89, 0x00); // Свободный 32-битный TSS
+
+    gdt_reg[cpu].limit = sizeof(gdt[cpu]) - 1;
+    gdt_reg[cpu].base = (u32) &gdt[cpu];
+
+    __asm__ volatile(
+        "lgdt (%0)\n\t"
+        "ljmp %1, $1f\n\t"          // Дальний переход перезагружает CS
+        "1:\n\t"
+        "mov %2, %%ax\n\t"
+        "mov %%ax, %%ds\n\t"
+        "mov %%ax, %%es\n\t"
+        "mov %%ax, %%fs\n\t"
+        "mov %%ax, %%ss\n\t"
+        "mov %3, %%ax\n\t"
+        "mov %%ax, %%gs\n\t"
+        "mov %4, %%ax\n\t"
+        "ltr %%ax"
+        : : "r" (&gdt_reg[cpu]), "i" (GDT_KERNEL_CODE), "i" (GDT_KERNEL_DATA), "i" (GDT_PERCPU),
+            "i" (GDT_TSS)
+        : "eax", "memory");
+}
+
+/**
+ * @brief Задает стек ядра для входа из кольца 3 на своем процессоре
+ * @param[in] esp0 Вершина стека: кадр прерывания кладется ниже
+ *
+ * @note Планировщик вызывает при переключении на поток, исполняющий
+ *       пользовательский код
+ */
+void tss_set_stack(const u32 esp0) {
+    tss[smp_cpu_id()].esp0 = esp0;
+}
+
+/**
+ * @brief Адрес поля esp0 в TSS процессора (для MSR_SYSENTER_ESP)
+ */
+u32 tss_stack_slot(const u32 cpu) {
+    return (u32) &tss[cpu].esp0;
+}
+
+/**
+ * @brief Загружает GDT загрузочного процессора
+ *
+ * @note Таблица загрузчика лежит в первом мегабайте, который после
+ *       paging_init() больше не отображен, поэтому ядро обязано
+ *       перейти на собственную копию до этого. До вызова не работают
+ *       smp_cpu_id() и все, что от него зависит (трассировка)
+ */
+void gdt_init() {
+    gdt_init_cpu(0);
+}
+
+/** @} */ // Конец группы gdt
@@ -0,0 +1,70 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef GDT_H
+#define GDT_H
+
+#include "../common.h"
+
+#define GDT_ENTRIES 7
+
+/**
+ * Порядок кода и данных ядра, затем кода и данных пользователя задан
+ * SYSENTER/SYSEXIT: селекторы считаются от MSR_SYSENTER_CS как +8, +16, +24
+ */
+#define GDT_KERNEL_CODE 0x08    // Совпадают с CODE_SEG/DATA_SEG загрузчика,
+#define GDT_KERNEL_DATA 0x10    // поэтому смена таблицы незаметна коду
+#define GDT_USER_CODE   0x18    // Кольцо 3: те же плоские 4 GB, DPL = 3
+#define GDT_USER_DATA   0x20
+#define GDT_PERCPU      0x28    // %gs: запись percpu[] процессора (kernel/smp.h)
+#define GDT_TSS         0x30    // TSS процессора: стек ядра для входа из кольца 3
+
+#define GDT_RPL_USER    3       // Добавляется к селекторам пользователя
+
+/**
+ * @brief Дескриптор сегмента (8 байт, формат описан в boot/gdt.asm)
+ */
+typedef struct {
+    u16 limit_low;
+    u16 base_low;
+    u8 base_mid;
+    u8 access;
+    u8 granularity;     // Флаги (старшие 4 бита) | лимит 16-19
+    u8 base_high;
+} __attribute__((packed)) gdt_entry_t;
+
+/**
+ * @brief Значение для инструкции LGDT
+ */
+typedef struct {
+    u16 limit;
+    u32 base;
+} __attribute__((packed)) gdt_register_t;
+
+/**
+ * @brief Сегмент состояния задачи
+ * @details Аппаратное переключение задач не используется: процессору
+ * нужны только ss0:esp0 - стек ядра при прерывании из кольца 3, а
+ * SYSENTER берет esp0 отсюда же (kernel/syscall.c).
+ */
+typedef struct {
+    u32 prev_tss;
+    u32 esp0, ss0;
+    u32 esp1, ss1;
+    u32 esp2, ss2;
+    u32 cr3, eip, eflags;
+    u32 eax, ecx, edx, ebx, esp, ebp, esi, edi;
+    u32 es, cs, ss, ds, fs, gs;
+    u32 ldt;
+    u16 trap;
+    u16 iomap_base;     // За пределами TSS: все порты закрыты для кольца 3
+} __attribute__((packed)) tss_t;
+
+void gdt_init();
+void gdt_init_cpu(u32 cpu);
+void gdt_set_gate(u32 cpu, u32 n, u32 base, u32 limit, u8 access, u8 flags);
+void tss_set_stack(u32 esp0);
+u32 tss_stack_slot(u32 cpu);
+
+#endif //GDT_H
@@ -0,0 +1,43 @@
+/**
+* @file idt.c
+ * @brief Таблица дескрипторов прерываний (IDT)
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup idt Таблица прерываний
+ * @{
+ */
+
+#include "idt.h"
+
+static idt_gate_t idt[IDT_ENTRIES];
+static idt_register_t idt_reg;
+
+/**
+ * @brief Заполняет шлюз прерывания
+ * @param[in] n       Номер вектора (0-255)
+ * @param[in] handler Адрес обработчика
+ * @param[in] flags   Байт типа/атрибутов (обычно IDT_GATE_INT32)
+ *
+ * @note Изменения вступают в силу сразу: процессор читает IDT
+ *       при каждом прерывании, повторный LIDT не требуется
+ */
+void set_idt_gate(const u8 n, const u32 handler, const u8 flags) {
+    idt[n].low_offset = handler & 0xFFFF;
+    idt[n].sel = KERNEL_CS;
+    idt[n].always0 = 0;
+    idt[n].flags = flags;
+    idt[n].high_offset = (handler >> 16) & 0xFFFF;
+}
+
+/**
+ * @brief Загружает IDT в регистр IDTR
+ *
+ * @warning Вызывать до разрешения прерываний (sti)
+ */
+void load_idt() {
+    idt_reg.base = (u32) &idt;
+    idt_reg.limit = IDT_ENTRIES * sizeof(idt_gate_t) - 1;
+    __asm__ volatile("lidt (%0)" : : "r" (&idt_reg) : "memory");
+}
+
+/** @} */ // Конец группы idt
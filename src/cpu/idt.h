@@ -0,0 +1,38 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef IDT_H
+#define IDT_H
+
+#include "../common.h"
+
+#define KERNEL_CS 0x08      // Селектор сегмента кода ядра (CODE_SEG из gdt.asm)
+#define IDT_ENTRIES 256     // Количество векторов прерываний x86
+
+#define IDT_GATE_INT32 0x8E // P=1, DPL=0, 32-битный шлюз прерывания
+#define IDT_GATE_TRAP32_USER 0xEF // P=1, DPL=3, 32-битный шлюз ловушки (int 0x80)
+
+/**
+ * @brief Дескриптор шлюза прерывания (8 байт)
+ */
+typedef struct {
+    u16 low_offset;  // Младшие 16 бит адреса обработчика
+    u16 sel;         // Селектор сегмента кода
+    u8 always0;      // Зарезервировано, всегда 0
+    u8 flags;        // P | DPL | 0 | тип шлюза
+    u16 high_offset; // Старшие 16 бит адреса обработчика
+} __attribute__((packed)) idt_gate_t;
+
+/**
+ * @brief Значение для инструкции LIDT
+ */
+typedef struct {
+    u16 limit;
+    u32 base;
+} __attribute__((packed)) idt_register_t;
+
+void set_idt_gate(u8 n, u32 handler, u8 flags);
+void load_idt();
+
+#endif //IDT_H
@@ -0,0 +1,112 @@
+; Точки входа обработчиков прерываний
+; ------------------------------------------------------------------------------
+;	Процессор при прерывании кладет на стек EFLAGS, CS, EIP (и для части
+;	исключений - код ошибки), после чего передает управление по адресу из IDT.
+;	Каждая заглушка ниже выравнивает кадр (кладет фиктивный код ошибки, если
+;	процессор его не положил), добавляет номер вектора и прыгает в общий код,
+;	который сохраняет регистры и вызывает isr_handler(registers_t *) из isr.c.
+;	В GS ядро держит селектор GDT_PERCPU, через который находит данные своего
+;	процессора (kernel/smp.h). Из кольца 3 GS приходит обнуленным, поэтому
+;	селектор загружается при каждом входе; восстанавливать его не нужно:
+;	IRET в кольцо 3 сам обнуляет GS с сегментом уровня ядра.
+; ------------------------------------------------------------------------------
+
+[bits 32]
+
+[extern isr_handler]
+
+KERNEL_DS equ 0x10      ; DATA_SEG из gdt.asm
+PERCPU_GS equ 0x28      ; GDT_PERCPU из gdt.h
+
+; Заглушка для векторов без кода ошибки
+%macro ISR_NOERR 1
+isr_stub_%1:
+	push dword 0            ; Фиктивный код ошибки
+	push dword %1           ; Номер вектора
+	jmp isr_common_stub
+%endmacro
+
+; Заглушка для векторов, где процессор сам кладет код ошибки
+%macro ISR_ERR 1
+isr_stub_%1:
+	push dword %1           ; Номер вектора
+	jmp isr_common_stub
+%endmacro
+
+; Общая часть: сохраняем контекст и вызываем C-обработчик
+isr_common_stub:
+	pusha                   ; EDI, ESI, EBP, ESP, EBX, EDX, ECX, EAX
+	mov ax, ds
+	push eax                ; Сохраняем сегмент данных прерванного кода
+
+	mov ax, KERNEL_DS       ; Переключаемся на сегменты ядра
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov ax, PERCPU_GS
+	mov gs, ax
+
+	cld                     ; ABI требует DF=0 при вызове C-кода
+	push esp                ; Аргумент: указатель на registers_t
+	call isr_handler
+	add esp, 4
+
+	pop eax                 ; Восстанавливаем сегменты
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+
+	popa
+	add esp, 8              ; Убираем номер вектора и код ошибки
+	iret
+
+; Исключения процессора (0-31)
+ISR_NOERR 0
+ISR_NOERR 1
+ISR_NOERR 2
+ISR_NOERR 3
+ISR_NOERR 4
+ISR_NOERR 5
+ISR_NOERR 6
+ISR_NOERR 7
+ISR_ERR   8
+ISR_NOERR 9
+ISR_ERR   10
+ISR_ERR   11
+ISR_ERR   12
+ISR_ERR   13
+ISR_ERR   14
+ISR_NOERR 15
+ISR_NOERR 16
+ISR_ERR   17
+ISR_NOERR 18
+ISR_NOERR 19
+ISR_NOERR 20
+ISR_ERR   21
+ISR_NOERR 22
+ISR_NOERR 23
+ISR_NOERR 24
+ISR_NOERR 25
+ISR_NOERR 26
+ISR_NOERR 27
+ISR_NOERR 28
+ISR_NOERR 29
+ISR_ERR   30
+ISR_NOERR 31
+
+; Аппаратные прерывания PIC (IRQ0-15 -> векторы 32-47) и все остальные
+; векторы: локальный APIC (0xF0-0xFF) и программные прерывания (int 0x80)
+%assign i 32
+%rep 224
+ISR_NOERR %[i]
+%assign i i+1
+%endrep
+
+; Таблица адресов заглушек для isr_install()
+global isr_stub_table
+isr_stub_table:
+%assign i 0
+%rep 256
+	dd isr_stub_%[i]
+%assign i i+1
+%endrep
@@ -0,0 +1,97 @@
+/**
+* @file isr.c
+ * @brief Диспетчеризация исключений и аппаратных прерываний
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup isr Обработчики прерываний
+ * @{
+ */
+
+#include "isr.h"
+#include "idt.h"
+#include "pic.h"
+#include "lapic.h"
+#include "../drivers/print.h"
+#include "../kernel/user.h"
+
+/**
+ * @brief Адреса точек входа из interrupt.asm (по одной на вектор)
+ */
+extern u32 isr_stub_table[ISR_STUB_COUNT];
+
+static isr_t interrupt_handlers[IDT_ENTRIES];
+
+static const char *exception_messages[] = {
+    "Division By Zero", "Debug", "Non Maskable Interrupt", "Breakpoint",
+    "Overflow", "Out of Bounds", "Invalid Opcode", "No Coprocessor",
+    "Double Fault", "Coprocessor Segment Overrun", "Bad TSS",
+    "Segment Not Present", "Stack Fault", "General Protection Fault",
+    "Page Fault", "Reserved", "x87 Floating Point", "Alignment Check",
+    "Machine Check", "SIMD Floating Point", "Virtualization", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Security", "Reserved"
+};
+
+/**
+ * @brief Устанавливает IDT и переназначает PIC
+ *
+ * @note После вызова все IRQ замаскированы; прерывания
+ *       остаются запрещенными до явного sti
+ */
+void isr_install() {
+    u32 i = 0;
+    while (i < ISR_STUB_COUNT) {
+        set_idt_gate(i, isr_stub_table[i], IDT_GATE_INT32);
+        i++;
+    }
+
+    pic_remap(PIC1_OFFSET, PIC2_OFFSET);
+    load_idt();
+}
+
+/**
+ * @brief Регистрирует обработчик для вектора
+ * @param[in] n       Номер вектора (для IRQ - IRQ0..IRQ15)
+ * @param[in] handler Функция-обработчик
+ */
+void register_interrupt_handler(const u8 n, const isr_t handler) {
+    interrupt_handlers[n] = handler;
+}
+
+/**
+ * @brief Общая точка входа из isr_common_stub
+ * @param[in,out] regs Сохраненные регистры прерванного кода
+ *
+ * @note Для IRQ сигнал EOI отправляется до вызова обработчика,
+ *       чтобы обработчик мог не возвращаться сразу (переключение задач).
+ *       Векторы локального APIC подтверждаются в APIC, кроме ложного.
+ *       Необработанное исключение в кольце 3 снимает программу, в ядре -
+ *       останавливает процессор.
+ */
+void isr_handler(registers_t *regs) {
+    const u32 n = regs->int_no;
+
+    if (n >= IRQ0 && n <= IRQ15) {
+        pic_send_eoi(n - IRQ0);
+    } else if (n >= LAPIC_VECTOR_BASE && n != LAPIC_SPURIOUS_VECTOR) {
+        lapic_eoi();
+    }
+
+    if (interrupt_handlers[n] != 0) {
+        interrupt_handlers[n](regs);
+        return;
+    }
+
+    if (n < 32 && (regs->cs & 3)) {
+        user_kill(regs, exception_messages[n]);
+    }
+    if (n < 32) {
+        colored_print(0x04, "\nException %d: %s (err %x, eip %x)\n",
+                      n, exception_messages[n], regs->err_code, regs->eip);
+        while (1) {
+            __asm__ volatile("cli; hlt");
+        }
+    }
+}
+
+/** @} */ // Конец группы isr
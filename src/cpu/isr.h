@@ -0,0 +1,48 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef ISR_H
+#define ISR_H
+
+#include "../common.h"
+
+#define ISR_STUB_COUNT 256  // Исключения 0-31, IRQ 0-15 и векторы APIC
+
+#define IRQ0  32
+#define IRQ1  33
+#define IRQ2  34
+#define IRQ3  35
+#define IRQ4  36
+#define IRQ5  37
+#define IRQ6  38
+#define IRQ7  39
+#define IRQ8  40
+#define IRQ9  41
+#define IRQ10 42
+#define IRQ11 43
+#define IRQ12 44
+#define IRQ13 45
+#define IRQ14 46
+#define IRQ15 47
+
+/**
+ * @brief Состояние регистров, сохраненное isr_common_stub (interrupt.asm)
+ * @details Порядок полей соответствует порядку на стеке:
+ * сегмент данных, pusha, номер вектора и код ошибки, затем кадр,
+ * который процессор кладет сам при входе в прерывание.
+ */
+typedef struct {
+    u32 ds;
+    u32 edi, esi, ebp, esp, ebx, edx, ecx, eax; // pusha
+    u32 int_no, err_code;                       // Кладет заглушка
+    u32 eip, cs, eflags, useresp, ss;           // Кладет процессор
+} registers_t;
+
+typedef void (*isr_t)(registers_t *regs);
+
+void isr_install();
+void register_interrupt_handler(u8 n, isr_t handler);
+void isr_handler(registers_t *regs);
+
+#endif //ISR_H
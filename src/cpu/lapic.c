@@ -0,0 +1,166 @@
+/**
+* @file lapic.c
+ * @brief Локальный APIC: включение, EOI и межпроцессорные прерывания
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup lapic Локальный APIC
+ * @{
+ */
+
+#include "lapic.h"
+#include "cpuid.h"
+#include "msr.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/timer.h"
+#include "../mm/pmm.h"
+#include "../mm/paging.h"
+
+/**
+ * @brief Регистры APIC в окне ioremap()
+ * @details У каждого процессора по этому физическому адресу видны
+ * собственные регистры, поэтому одно отображение годится для всех.
+ */
+static volatile u32 *lapic = 0;
+
+static inline u32 lapic_read(const u32 reg) {
+    return lapic[reg / 4];
+}
+
+static inline void lapic_write(const u32 reg, const u32 value) {
+    lapic[reg / 4] = value;
+}
+
+/**
+ * @brief Отображает регистры локального APIC и включает его на BSP
+ * @param[in] phys Адрес из MADT; 0 - взять из MSR_APIC_BASE
+ * @return 0 или -1, если APIC нет
+ */
+s32 lapic_init(u32 phys) {
+    const u32 features = cpuid_features_edx();
+
+    if (!(features & CPUID_FEAT_EDX_APIC)) {
+        return -1;
+    }
+    if (features & CPUID_FEAT_EDX_MSR) {
+        const u64 base = rdmsr(MSR_APIC_BASE);
+        if (phys == 0) {
+            phys = (u32) base & ~(PAGE_SIZE - 1);
+        }
+        if (!(base & MSR_APIC_BASE_ENABLE)) {
+            wrmsr(MSR_APIC_BASE, base | MSR_APIC_BASE_ENABLE);
+        }
+    }
+    if (phys == 0) {
+        return -1;
+    }
+
+    lapic = ioremap(phys, PAGE_SIZE, PTE_NOCACHE | PTE_PWT);
+    if (lapic == 0) {
+        return -1;
+    }
+    lapic_enable();
+    return 0;
+}
+
+/**
+ * @brief Включает APIC текущего процессора
+ * @note Вызывает каждый процессор для себя. Порог приоритета 0 - принимаются
+ *       все векторы; ложные прерывания приходят на LAPIC_SPURIOUS_VECTOR
+ */
+void lapic_enable() {
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+    lapic_write(LAPIC_ESR, 0);  // Запись фиксирует и сбрасывает ошибки
+    lapic_write(LAPIC_ESR, 0);
+}
+
+/**
+ * @brief Отображен ли локальный APIC
+ */
+u8 lapic_present() {
+    return lapic != 0;
+}
+
+/**
+ * @brief APIC ID текущего процессора
+ */
+u32 lapic_id() {
+    return lapic_read(LAPIC_ID) >> 24;
+}
+
+/**
+ * @brief Сообщает APIC об окончании обработки прерывания
+ */
+void lapic_eoi() {
+    lapic_write(LAPIC_EOI, 0);
+}
+
+/**
+ * @brief Посылает межпроцессорное прерывание
+ * @param[in] apic_id APIC ID получателя (не используется с ICR_ALL_BUT_SELF)
+ * @param[in] command Тип доставки, флаги и вектор для ICR_LOW
+ *
+ * @note Запись ICR_LOW отправляет IPI, поэтому пара регистров пишется при
+ *       запрещенных прерываниях; затем ожидается доставка
+ */
+void lapic_send_ipi(const u32 apic_id, const u32 command) {
+    const u32 flags = irq_save();
+
+    lapic_write(LAPIC_ICR_HIGH, apic_id << 24);
+    lapic_write(LAPIC_ICR_LOW, command);
+    while (lapic_read(LAPIC_ICR_LOW) & ICR_PENDING) {
+        __asm__ volatile("pause");
+    }
+    irq_restore(flags);
+}
+
+/**
+ * @brief Измеряет частоту счетчика таймера APIC по TSC
+ * @param[in] ms Длительность замера
+ * @return Частота счетчика (после LAPIC_TIMER_DIV16) в кГц, 0 - не удалось
+ *
+ * @note Нужен откалиброванный TSC (udelay()). Прерывание на время
+ *       замера замаскировано
+ */
+u32 lapic_timer_calibrate(const u32 ms) {
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIV16);
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED | LVT_TIMER_ONESHOT | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INITIAL, 0xFFFFFFFF);
+    udelay(ms * 1000);
+    const u32 elapsed = 0xFFFFFFFF - lapic_read(LAPIC_TIMER_CURRENT);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+    return elapsed / ms;
+}
+
+/**
+ * @brief Настраивает LVT таймера на LAPIC_TIMER_VECTOR
+ * @param[in] mode LVT_TIMER_ONESHOT или LVT_TIMER_DEADLINE
+ * @note Счетчик не запускается: это делают lapic_timer_start() и
+ *       lapic_timer_deadline()
+ */
+void lapic_timer_mode(const u32 mode) {
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIV16);
+    lapic_write(LAPIC_LVT_TIMER, mode | LAPIC_TIMER_VECTOR);
+    if (mode == LVT_TIMER_DEADLINE) {
+        // Запись в LVT должна завершиться до первой записи срока
+        __asm__ volatile("mfence" : : : "memory");
+    }
+}
+
+/**
+ * @brief Однократное прерывание через count тактов счетчика
+ * @note Новая запись заменяет прежний срок, 0 останавливает таймер
+ */
+void lapic_timer_start(const u32 count) {
+    lapic_write(LAPIC_TIMER_INITIAL, count);
+}
+
+/**
+ * @brief Прерывание, когда TSC достигнет значения tsc
+ * @note Срок в прошлом срабатывает сразу, 0 отменяет прерывание
+ */
+void lapic_timer_deadline(const u64 tsc) {
+    wrmsr(MSR_TSC_DEADLINE, tsc);
+}
+
+/** @} */ // Конец группы lapic
@@ -0,0 +1,67 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef LAPIC_H
+#define LAPIC_H
+
+#include "../common.h"
+
+// Регистры локального APIC (смещения от базы, доступ 32-битный)
+#define LAPIC_ID        0x020
+#define LAPIC_VERSION   0x030
+#define LAPIC_TPR       0x080   // Порог приоритета задач
+#define LAPIC_EOI       0x0B0
+#define LAPIC_SVR       0x0F0   // Вектор ложного прерывания и бит включения
+#define LAPIC_ESR       0x280   // Ошибки доставки
+#define LAPIC_ICR_LOW   0x300   // Команда межпроцессорного прерывания
+#define LAPIC_ICR_HIGH  0x310   // Биты 24-31 - APIC ID получателя
+#define LAPIC_LVT_TIMER 0x320
+#define LAPIC_LVT_LINT0 0x350
+#define LAPIC_LVT_LINT1 0x360
+#define LAPIC_LVT_ERROR 0x370
+#define LAPIC_TIMER_INITIAL 0x380 // Начальное значение счетчика таймера
+#define LAPIC_TIMER_CURRENT 0x390
+#define LAPIC_TIMER_DIVIDE  0x3E0
+
+#define LAPIC_SVR_ENABLE 0x100
+
+// Поля ICR
+#define ICR_FIXED        0x00000
+#define ICR_INIT         0x00500
+#define ICR_STARTUP      0x00600
+#define ICR_PENDING      0x01000 // Предыдущее IPI еще не доставлено
+#define ICR_ASSERT       0x04000
+#define ICR_LEVEL        0x08000
+#define ICR_ALL_BUT_SELF 0xC0000
+
+#define LVT_MASKED 0x10000
+
+// Режимы таймера (биты 17-18 LVT_TIMER)
+#define LVT_TIMER_ONESHOT  0x00000
+#define LVT_TIMER_PERIODIC 0x20000
+#define LVT_TIMER_DEADLINE 0x40000  // Срок - значение TSC в MSR_TSC_DEADLINE
+
+#define LAPIC_TIMER_DIV16 0x3       // Делитель частоты шины для счетчика
+
+/**
+ * Векторы локального APIC: выше векторов PIC, приоритет APIC растет
+ * со старшей тетрадой вектора. Ложное прерывание (SPURIOUS) не требует EOI.
+ */
+#define LAPIC_VECTOR_BASE     0xF0
+#define LAPIC_TIMER_VECTOR    0xF0
+#define IPI_CALL_VECTOR       0xF1   // smp_call(): у процессора есть работа
+#define LAPIC_SPURIOUS_VECTOR 0xFF
+
+s32 lapic_init(u32 phys);
+void lapic_enable();
+u8 lapic_present();
+u32 lapic_id();
+void lapic_eoi();
+void lapic_send_ipi(u32 apic_id, u32 command);
+u32 lapic_timer_calibrate(u32 ms);
+void lapic_timer_mode(u32 mode);
+void lapic_timer_start(u32 count);
+void lapic_timer_deadline(u64 tsc);
+
+#endif //LAPIC_H
@@ -0,0 +1,33 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef MSR_H
+#define MSR_H
+
+#include "../common.h"
+
+#define MSR_APIC_BASE 0x1B          // Адрес и включение локального APIC
+#define MSR_APIC_BASE_ENABLE (1 << 11)
+#define MSR_APIC_BASE_BSP    (1 << 8)
+#define MSR_TSC_DEADLINE 0x6E0      // Срок таймера APIC в режиме TSC-deadline
+
+/**
+ * Чтение модельно-специфичного регистра.
+ *
+ * @note Нужен CPUID_FEAT_EDX_MSR; несуществующий регистр вызывает #GP
+ */
+static inline u64 rdmsr(const u32 msr) {
+    u64 value;
+    __asm__ volatile("rdmsr" : "=A" (value) : "c" (msr));
+    return value;
+}
+
+/**
+ * Запись модельно-специфичного регистра.
+ */
+static inline void wrmsr(const u32 msr, const u64 value) {
+    __asm__ volatile("wrmsr" : : "c" (msr), "A" (value) : "memory");
+}
+
+#endif //MSR_H
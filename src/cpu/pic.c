@@ -0,0 +1,80 @@
+/**
+* @file pic.c
+ * @brief Программируемый контроллер прерываний 8259A
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup pic Контроллер прерываний 8259
+ * @{
+ */
+
+#include "pic.h"
+#include "../drivers/asm_io.h"
+
+/**
+ * @brief Переназначает векторы IRQ ведущего и ведомого контроллеров
+ * @param[in] offset1 Первый вектор ведущего контроллера (IRQ0)
+ * @param[in] offset2 Первый вектор ведомого контроллера (IRQ8)
+ *
+ * @note После BIOS IRQ0-7 попадают на векторы 0x08-0x0F и пересекаются
+ *       с исключениями процессора, поэтому их нужно сдвинуть.
+ *       Все линии, кроме каскадной IRQ2, маскируются: драйверы сами
+ *       открывают свои IRQ через pic_unmask().
+ */
+void pic_remap(const u8 offset1, const u8 offset2) {
+    // ICW1: начать инициализацию, будет ICW4
+    port_byte_out(PIC1_COMMAND, 0x11);
+    port_byte_out(PIC2_COMMAND, 0x11);
+    // ICW2: базовые векторы
+    port_byte_out(PIC1_DATA, offset1);
+    port_byte_out(PIC2_DATA, offset2);
+    // ICW3: ведомый подключен к IRQ2 ведущего
+    port_byte_out(PIC1_DATA, 0x04);
+    port_byte_out(PIC2_DATA, 0x02);
+    // ICW4: режим 8086
+    port_byte_out(PIC1_DATA, 0x01);
+    port_byte_out(PIC2_DATA, 0x01);
+
+    port_byte_out(PIC1_DATA, 0xFB);
+    port_byte_out(PIC2_DATA, 0xFF);
+}
+
+/**
+ * @brief Сообщает контроллеру об окончании обработки IRQ
+ * @param[in] irq Номер линии (0-15)
+ *
+ * @note Для IRQ8-15 EOI нужно отправить обоим контроллерам
+ */
+void pic_send_eoi(const u8 irq) {
+    if (irq >= 8) {
+        port_byte_out(PIC2_COMMAND, PIC_EOI);
+    }
+    port_byte_out(PIC1_COMMAND, PIC_EOI);
+}
+
+/**
+ * @brief Запрещает линию IRQ
+ * @param[in] irq Номер линии (0-15)
+ */
+void pic_mask(u8 irq) {
+    u16 port = PIC1_DATA;
+    if (irq >= 8) {
+        port = PIC2_DATA;
+        irq -= 8;
+    }
+    port_byte_out(port, port_byte_in(port) | (1 << irq));
+}
+
+/**
+ * @brief Разрешает линию IRQ
+ * @param[in] irq Номер линии (0-15)
+ */
+void pic_unmask(u8 irq) {
+    u16 port = PIC1_DATA;
+    if (irq >= 8) {
+        port = PIC2_DATA;
+        irq -= 8;
+    }
+    port_byte_out(port, port_byte_in(port) & ~(1 << irq));
+}
+
+/** @} */ // Конец группы pic
@@ -0,0 +1,25 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef PIC_H
+#define PIC_H
+
+#include "../common.h"
+
+#define PIC1_COMMAND 0x20   // Ведущий контроллер: команды
+#define PIC1_DATA    0x21   // Ведущий контроллер: маска прерываний
+#define PIC2_COMMAND 0xA0   // Ведомый контроллер: команды
+#define PIC2_DATA    0xA1   // Ведомый контроллер: маска прерываний
+
+#define PIC_EOI      0x20   // Команда "конец прерывания"
+
+#define PIC1_OFFSET  0x20   // IRQ0-7  -> векторы 32-39
+#define PIC2_OFFSET  0x28   // IRQ8-15 -> векторы 40-47
+
+void pic_remap(u8 offset1, u8 offset2);
+void pic_send_eoi(u8 irq);
+void pic_mask(u8 irq);
+void pic_unmask(u8 irq);
+
+#endif //PIC_H
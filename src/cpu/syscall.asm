@@ -0,0 +1,178 @@
+; Вход в ядро из кольца 3 и переход в кольцо 3
+; ------------------------------------------------------------------------------
+;	sysenter_entry - точка входа SYSENTER (MSR_SYSENTER_EIP). Процессор
+;	загружает CS/SS ядра, ESP из MSR_SYSENTER_ESP и запрещает прерывания;
+;	больше ничего не сохраняется. В MSR лежит адрес поля esp0 в TSS, поэтому
+;	первая инструкция переходит на стек ядра текущего потока. Адрес возврата
+;	и стек программа передает в EDX и ECX - SYSEXIT берет их оттуда же.
+;
+;	user_enter/user_exit - вход в программу через IRET и возврат в ядро.
+;	user_enter() сохраняет EFLAGS и регистры, которые обязан сохранить
+;	вызываемый, запоминает ESP и делает его esp0: кадры из кольца 3 ложатся
+;	ниже. user_exit() (системный вызов exit или исключение программы)
+;	возвращает ESP на это место и выходит из user_enter() с кодом
+;	завершения. EFLAGS восстанавливается: исключения приходят через шлюз
+;	прерывания с IF = 0, и без этого ядро продолжило бы без прерываний.
+; ------------------------------------------------------------------------------
+
+[bits 32]
+
+[extern syscall_dispatch]
+[extern tss_set_stack]
+
+KERNEL_DS equ 0x10      ; GDT_KERNEL_DATA
+USER_CS   equ 0x1B      ; GDT_USER_CODE | 3
+USER_DS   equ 0x23      ; GDT_USER_DATA | 3
+PERCPU_GS equ 0x28      ; GDT_PERCPU
+EFLAGS_IF equ 0x202     ; IF и обязательный бит 1
+
+global sysenter_entry
+global user_enter
+global user_exit
+
+section .text
+
+sysenter_entry:
+	mov esp, [esp]          ; esp0 текущего потока
+	push ecx                ; ESP программы
+	push edx                ; EIP программы
+
+	mov cx, KERNEL_DS
+	mov ds, cx
+	mov es, cx
+	mov fs, cx
+	mov cx, PERCPU_GS
+	mov gs, cx
+	cld
+	sti                     ; Вызов может спать и вытесняться
+
+	push edi                ; Аргументы syscall_dispatch() справа налево
+	push esi
+	push ebx
+	push eax
+	call syscall_dispatch   ; EBX, ESI, EDI, EBP сохраняются по cdecl
+	add esp, 16
+
+	cli                     ; Сегменты программы до SYSEXIT без прерываний
+	mov cx, USER_DS
+	mov ds, cx
+	mov es, cx
+	mov fs, cx
+	xor cx, cx
+	mov gs, cx              ; Селектор ядра программе не оставляем
+	pop edx
+	pop ecx
+	sti                     ; STI действует после следующей инструкции
+	sysexit
+
+; s32 user_enter(u32 eip, u32 esp, u32 *kernel_esp)
+user_enter:
+	pushf
+	push ebp
+	push ebx
+	push esi
+	push edi
+
+	mov eax, [esp + 32]     ; kernel_esp
+	mov [eax], esp
+	push esp
+	call tss_set_stack
+	add esp, 4
+
+	mov eax, [esp + 24]     ; eip
+	mov edx, [esp + 28]     ; esp
+	mov cx, USER_DS
+	mov ds, cx
+	mov es, cx
+	mov fs, cx              ; GS обнулит IRET: DPL сегмента ниже кольца 3
+
+	push dword USER_DS      ; Кадр IRET со сменой уровня: SS, ESP, EFLAGS, CS, EIP
+	push edx
+	push dword EFLAGS_IF
+	push dword USER_CS
+	push eax
+
+	xor eax, eax            ; Регистры ядра программе не видны
+	xor ebx, ebx
+	xor ecx, ecx
+	xor edx, edx
+	xor esi, esi
+	xor edi, edi
+	xor ebp, ebp
+	iret
+
+; void user_exit(u32 kernel_esp, s32 code)
+user_exit:
+	mov eax, [esp + 8]      ; Код завершения - результат user_enter()
+	mov esp, [esp + 4]
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
+	popf
+	ret
+
+; Программа для sysbench (syscall.c)
+; ------------------------------------------------------------------------------
+;	Копируется на страницу пользователя, поэтому не зависит от адреса
+;	загрузки. Вершина стека - 16 байт для обмена с ядром: на входе [esp] = 1,
+;	если SYSENTER доступен; на выходе там такты SYSCALL_BENCH_ITERS вызовов
+;	через int 0x80 (+0) и через SYSENTER (+8).
+; ------------------------------------------------------------------------------
+
+SYS_EXIT    equ 0
+SYS_GETTID  equ 2
+BENCH_ITERS equ 10000   ; SYSCALL_BENCH_ITERS из syscall.h
+
+global user_bench_start
+global user_bench_end
+
+user_bench_start:
+	mov ebp, esp
+	mov ebx, [ebp]          ; Флаг SYSENTER
+	call .base
+.base:
+	pop esi                 ; Собственный адрес для адреса возврата SYSEXIT
+
+	rdtsc
+	mov [ebp], eax
+	mov [ebp + 4], edx
+	mov edi, BENCH_ITERS
+.int80:
+	mov eax, SYS_GETTID
+	int 0x80
+	dec edi
+	jnz .int80
+	rdtsc
+	sub eax, [ebp]
+	sbb edx, [ebp + 4]
+	mov [ebp], eax
+	mov [ebp + 4], edx
+
+	mov dword [ebp + 8], 0
+	mov dword [ebp + 12], 0
+	test ebx, ebx
+	jz .done
+	rdtsc
+	mov [ebp + 8], eax
+	mov [ebp + 12], edx
+	mov edi, BENCH_ITERS
+.sysenter:
+	mov eax, SYS_GETTID
+	mov ecx, esp
+	lea edx, [esi + .sysenter_ret - .base]
+	sysenter
+.sysenter_ret:
+	dec edi
+	jnz .sysenter
+	rdtsc
+	sub eax, [ebp + 8]
+	sbb edx, [ebp + 12]
+	mov [ebp + 8], eax
+	mov [ebp + 12], edx
+
+.done:
+	mov eax, SYS_EXIT
+	xor ebx, ebx
+	int 0x80
+user_bench_end:
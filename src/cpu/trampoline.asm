@@ -0,0 +1,100 @@
+; Трамплин запуска прикладных процессоров (AP)
+; ------------------------------------------------------------------------------
+;	После INIT-SIPI-SIPI процессор стартует в реальном режиме с CS = вектор
+;	SIPI * 0x100, IP = 0. smp_init() копирует код между trampoline_start и
+;	trampoline_end на физический адрес TRAMPOLINE_ADDR (первый мегабайт,
+;	граница страницы) и заполняет поля данных в конце копии.
+;	Код выполняется не там, где скомпонован, поэтому все адреса считаются
+;	через TADDR(): смещение метки от trampoline_start + TRAMPOLINE_ADDR.
+;	Дальше повторяется путь загрузчика (switch.asm): своя плоская GDT,
+;	бит PE, дальний переход в 32-битный код. Затем включаются возможности
+;	CR4 загрузочного процессора (PSE, PGE) и страничная адресация с
+;	временным каталогом: это копия каталога ядра, в которой первые 4 MB
+;	отображены тождественно, иначе следующая за включением PG инструкция
+;	оказалась бы не отображена. Наконец, процессор переходит на свой стек
+;	и в ap_main() (smp.c) в верхней половине; ap_main() загружает каталог
+;	ядра, собственную GDT и IDT.
+; ------------------------------------------------------------------------------
+
+TRAMPOLINE_ADDR equ 0x8000          ; Должен совпадать с TRAMPOLINE_ADDR из smp.h
+CR0_PE          equ 0x00000001
+CR0_PG_WP       equ 0x80010000      ; Как в kernel_entry.asm
+
+%define TADDR(label) (TRAMPOLINE_ADDR + ((label) - trampoline_start))
+
+TRAMP_CODE_SEG equ tramp_gdt_code - tramp_gdt
+TRAMP_DATA_SEG equ tramp_gdt_data - tramp_gdt
+
+global trampoline_start
+global trampoline_end
+global trampoline_cr3
+global trampoline_cr4
+global trampoline_stack
+global trampoline_entry
+
+section .text
+
+[bits 16]
+
+trampoline_start:
+	cli
+	cld
+	xor ax, ax              ; CS указывает на трамплин, а данные
+	mov ds, ax              ; адресуются от нуля через TADDR()
+
+	lgdt [TADDR(tramp_gdt_descriptor)]
+
+	mov eax, cr0
+	or eax, CR0_PE
+	mov cr0, eax
+
+	jmp dword TRAMP_CODE_SEG:TADDR(tramp_pm)
+
+[bits 32]
+
+tramp_pm:
+	mov ax, TRAMP_DATA_SEG
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+	mov ss, ax
+
+	mov eax, [TADDR(trampoline_cr4)]
+	mov cr4, eax            ; PSE нужен до включения PG: каталог на страницах 4 MB
+	mov eax, [TADDR(trampoline_cr3)]
+	mov cr3, eax
+
+	mov eax, cr0
+	or eax, CR0_PG_WP
+	mov cr0, eax
+
+	mov esp, [TADDR(trampoline_stack)]
+	xor ebp, ebp            ; Конец цепочки кадров для профилировщика
+	mov eax, [TADDR(trampoline_entry)]
+	jmp eax                 ; ap_main() не возвращается
+
+; Плоская GDT трамплина: те же дескрипторы, что и в boot/gdt.asm
+align 8
+tramp_gdt:
+	dd 0x0, 0x0
+tramp_gdt_code:
+	dw 0xffff, 0x0
+	db 0x0, 10011010b, 11001111b, 0x0
+tramp_gdt_data:
+	dw 0xffff, 0x0
+	db 0x0, 10010010b, 11001111b, 0x0
+tramp_gdt_end:
+
+tramp_gdt_descriptor:
+	dw tramp_gdt_end - tramp_gdt - 1
+	dd TADDR(tramp_gdt)
+
+; Поля, которые заполняет smp_init() в копии трамплина
+align 4
+trampoline_cr3:   dd 0      ; Физический адрес временного каталога страниц
+trampoline_cr4:   dd 0      ; CR4 загрузочного процессора
+trampoline_stack: dd 0      ; Вершина стека процессора (виртуальный адрес)
+trampoline_entry: dd 0      ; ap_main
+
+trampoline_end:
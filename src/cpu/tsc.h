@@ -0,0 +1,34 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef TSC_H
+#define TSC_H
+
+#include "../common.h"
+
+/**
+ * Чтение счетчика тактов процессора.
+ *
+ * @note Процессор может выполнить RDTSC раньше предшествующих инструкций.
+ *       Для замеров коротких участков используйте rdtsc_ordered().
+ */
+static inline u64 rdtsc() {
+    u64 value;
+    __asm__ volatile("rdtsc" : "=A" (value));
+    return value;
+}
+
+/**
+ * Чтение счетчика тактов после завершения всех предыдущих инструкций.
+ *
+ * @note LFENCE дожидается выполнения предыдущих инструкций (Intel, AMD с
+ *       LFENCE serializing), поэтому RDTSC не забегает вперед
+ */
+static inline u64 rdtsc_ordered() {
+    u64 value;
+    __asm__ volatile("lfence; rdtsc" : "=A" (value) : : "memory");
+    return value;
+}
+
+#endif //TSC_H
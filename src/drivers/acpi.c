@@ -0,0 +1,161 @@
+/**
+* @file acpi.c
+ * @brief Поиск таблиц ACPI и разбор MADT
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup acpi Таблицы ACPI
+ * @{
+ */
+
+#include "acpi.h"
+#include "print.h"
+#include "../string.h"
+#include "../mm/pmm.h"
+#include "../mm/paging.h"
+
+static const acpi_sdt_header_t *rsdt;
+
+/**
+ * @brief Сумма байт по модулю 256 (у правильной таблицы равна 0)
+ */
+static u8 acpi_checksum(const void *data, u32 len) {
+    const u8 *p = data;
+    u8 sum = 0;
+
+    while (len--) {
+        sum += *p++;
+    }
+    return sum;
+}
+
+/**
+ * @brief Ищет RSDP на 16-байтных границах физического диапазона
+ * @note Диапазоны лежат в первом мегабайте, то есть в прямом отображении
+ */
+static const acpi_rsdp_t *rsdp_scan(const u32 start, const u32 end) {
+    u32 addr;
+
+    for (addr = start; addr + sizeof(acpi_rsdp_t) <= end; addr += 16) {
+        const acpi_rsdp_t *rsdp = PHYS_TO_VIRT(addr);
+        if (memcmp(rsdp->signature, "RSD PTR ", 8) == 0
+            && acpi_checksum(rsdp, sizeof(*rsdp)) == 0) {
+            return rsdp;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Отображает системную таблицу целиком и проверяет ее сумму
+ * @param[in] phys Физический адрес заголовка
+ * @return Таблица или 0
+ *
+ * @note Сначала отображается заголовок, чтобы узнать длину. Таблицы BIOS
+ *       обычно лежат в конце ОЗУ внутри прямого отображения, тогда
+ *       ioremap() не тратит страниц окна
+ */
+static const acpi_sdt_header_t *acpi_map_table(const u32 phys) {
+    const acpi_sdt_header_t *header = ioremap(phys, sizeof(acpi_sdt_header_t), 0);
+
+    if (header == 0 || header->length < sizeof(acpi_sdt_header_t)) {
+        return 0;
+    }
+    header = ioremap(phys, header->length, 0);
+    if (header == 0 || acpi_checksum(header, header->length) != 0) {
+        return 0;
+    }
+    return header;
+}
+
+/**
+ * @brief Находит RSDP и корневую таблицу RSDT
+ * @return 0 или -1, если ACPI нет
+ *
+ * @note RSDP ищется в первом килобайте EBDA, затем в ПЗУ BIOS
+ *       0xE0000-0xFFFFF, как требует спецификация для систем с BIOS
+ */
+s32 acpi_init() {
+    const u32 ebda = (u32) *(u16 *) PHYS_TO_VIRT(ACPI_EBDA_SEGMENT) << 4;
+    const acpi_rsdp_t *rsdp = 0;
+
+    if (ebda >= 0x80000 && ebda < 0xA0000) {
+        rsdp = rsdp_scan(ebda, ebda + 1024);
+    }
+    if (rsdp == 0) {
+        rsdp = rsdp_scan(ACPI_BIOS_START, ACPI_BIOS_END);
+    }
+    if (rsdp == 0) {
+        return -1;
+    }
+
+    rsdt = acpi_map_table(rsdp->rsdt_address);
+    if (rsdt == 0 || memcmp(rsdt->signature, "RSDT", 4) != 0) {
+        colored_print(0x04, "acpi: bad RSDT at %p\n", rsdp->rsdt_address);
+        rsdt = 0;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ищет таблицу по сигнатуре среди ссылок RSDT
+ * @param[in] signature Четыре символа, например "APIC"
+ * @return Отображенная таблица с верной суммой или 0
+ */
+const acpi_sdt_header_t *acpi_find_table(const char *signature) {
+    if (rsdt == 0) {
+        return 0;
+    }
+
+    const u32 *entries = (const u32 *) (rsdt + 1);
+    const u32 count = (rsdt->length - sizeof(acpi_sdt_header_t)) / 4;
+    u32 i;
+
+    for (i = 0; i < count; i++) {
+        const acpi_sdt_header_t *header = acpi_map_table(entries[i]);
+        if (header && memcmp(header->signature, signature, 4) == 0) {
+            return header;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Собирает из MADT адрес локального APIC и список процессоров
+ * @param[out] info Результат; процессоры - в порядке записей MADT,
+ *                  первым BIOS обычно ставит загрузочный
+ * @return 0 или -1, если MADT нет
+ *
+ * @note Выключенные процессоры (без MADT_LAPIC_ENABLED) пропускаются;
+ *       записи сверх ACPI_MAX_CPUS отбрасываются
+ */
+s32 acpi_parse_madt(acpi_madt_info_t *info) {
+    const acpi_madt_t *madt = (const acpi_madt_t *) acpi_find_table("APIC");
+
+    memset(info, 0, sizeof(*info));
+    if (madt == 0) {
+        return -1;
+    }
+    info->lapic_address = madt->lapic_address;
+
+    const u8 *entry = (const u8 *) (madt + 1);
+    const u8 *end = (const u8 *) madt + madt->header.length;
+
+    while (entry + 2 <= end && entry[1] >= 2 && entry + entry[1] <= end) {
+        if (entry[0] == MADT_LAPIC) {
+            const madt_lapic_t *lapic = (const madt_lapic_t *) entry;
+            if ((lapic->flags & MADT_LAPIC_ENABLED) && info->cpu_count < ACPI_MAX_CPUS) {
+                info->apic_ids[info->cpu_count++] = lapic->apic_id;
+            }
+        } else if (entry[0] == MADT_LAPIC_OVERRIDE) {
+            const u64 address = *(const u64 *) (entry + 4);
+            if (address >> 32 == 0) {
+                info->lapic_address = (u32) address;
+            }
+        }
+        entry += entry[1];
+    }
+    return 0;
+}
+
+/** @} */ // Конец группы acpi
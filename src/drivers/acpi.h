@@ -0,0 +1,83 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef ACPI_H
+#define ACPI_H
+
+#include "../common.h"
+
+#define ACPI_MAX_CPUS 16            // Процессоров, которые запоминает разбор MADT
+
+#define ACPI_EBDA_SEGMENT 0x40E     // Слово BDA: сегмент EBDA
+#define ACPI_BIOS_START   0xE0000   // Область поиска RSDP в ПЗУ BIOS
+#define ACPI_BIOS_END     0x100000
+
+// Типы записей MADT
+#define MADT_LAPIC          0   // Локальный APIC процессора
+#define MADT_LAPIC_OVERRIDE 5   // 64-битный адрес локального APIC
+
+#define MADT_LAPIC_ENABLED 0x01 // Процессор исправен и может быть запущен
+
+/**
+ * @brief Указатель на корневую таблицу (RSDP), версия 1.0
+ * @details Для ACPI 2.0+ за ним следуют длина и адрес XSDT; 32-битному
+ * ядру хватает RSDT, который обязан присутствовать и там.
+ */
+typedef struct {
+    char signature[8];      // "RSD PTR "
+    u8 checksum;            // Сумма первых 20 байт = 0
+    char oem_id[6];
+    u8 revision;
+    u32 rsdt_address;
+} __attribute__((packed)) acpi_rsdp_t;
+
+/**
+ * @brief Общий заголовок системных таблиц (RSDT, MADT, ...)
+ */
+typedef struct {
+    char signature[4];
+    u32 length;             // Длина таблицы вместе с заголовком
+    u8 revision;
+    u8 checksum;            // Сумма всех байт таблицы = 0
+    char oem_id[6];
+    char oem_table_id[8];
+    u32 oem_revision;
+    u32 creator_id;
+    u32 creator_revision;
+} __attribute__((packed)) acpi_sdt_header_t;
+
+/**
+ * @brief Таблица MADT ("APIC"): за заголовком идут записи переменной длины
+ */
+typedef struct {
+    acpi_sdt_header_t header;
+    u32 lapic_address;      // Физический адрес регистров локального APIC
+    u32 flags;              // Бит 0 - есть пара 8259 (PIC)
+} __attribute__((packed)) acpi_madt_t;
+
+/**
+ * @brief Запись MADT типа 0: процессор
+ */
+typedef struct {
+    u8 type;
+    u8 length;
+    u8 processor_id;
+    u8 apic_id;
+    u32 flags;              // MADT_LAPIC_ENABLED
+} __attribute__((packed)) madt_lapic_t;
+
+/**
+ * @brief Процессоры и локальный APIC из MADT
+ */
+typedef struct {
+    u32 lapic_address;
+    u32 cpu_count;
+    u8 apic_ids[ACPI_MAX_CPUS];
+} acpi_madt_info_t;
+
+s32 acpi_init();
+const acpi_sdt_header_t *acpi_find_table(const char *signature);
+s32 acpi_parse_madt(acpi_madt_info_t *info);
+
+#endif //ACPI_H
@@ -51,7 +51,7 @@ void port_byte_out(unsigned short port, unsigned char data) {
  * - Адресация портов осуществляется через DX
  * - Поддерживает операции с 16-битными устройствами (например, PCI)
  */
-unsigned char port_word_in(unsigned short port) {
+unsigned short port_word_in(unsigned short port) {
     unsigned short result;
     __asm__("in %%dx, %%ax" : "=a" (result) : "d" (port));
     return result;
@@ -71,4 +71,49 @@ void port_word_out(unsigned short port, unsigned short data) {
     __asm__("out %%ax, %%dx" : : "a" (data), "d" (port));
 }
 
+/**
+ * Чтение 32-битного слова из порта ввода-вывода
+ * @param port 16-битный адрес порта
+ * @return Считанное значение
+ *
+ * @note Нужно для конфигурационного пространства PCI (порт 0xCFC)
+ */
+u32 port_dword_in(unsigned short port) {
+    u32 result;
+    __asm__ volatile("in %%dx, %%eax" : "=a" (result) : "d" (port));
+    return result;
+}
+
+/**
+ * Запись 32-битного слова в порт ввода-вывода
+ * @param port 16-битный адрес порта
+ * @param data Значение для записи
+ */
+void port_dword_out(unsigned short port, u32 data) {
+    __asm__ volatile("out %%eax, %%dx" : : "a" (data), "d" (port));
+}
+
+/**
+ * Чтение блока 16-битных слов из одного порта (REP INSW)
+ * @param port Порт данных устройства
+ * @param buffer Приемник
+ * @param count Количество слов
+ *
+ * @note Одна инструкция на весь блок вместо вызова port_word_in() на
+ *       каждое слово (сектор ATA - 256 слов)
+ */
+void port_words_in(unsigned short port, void *buffer, u32 count) {
+    __asm__ volatile("rep insw" : "+D" (buffer), "+c" (count) : "d" (port) : "memory");
+}
+
+/**
+ * Запись блока 16-битных слов в один порт (REP OUTSW)
+ * @param port Порт данных устройства
+ * @param buffer Источник
+ * @param count Количество слов
+ */
+void port_words_out(unsigned short port, const void *buffer, u32 count) {
+    __asm__ volatile("rep outsw" : "+S" (buffer), "+c" (count) : "d" (port) : "memory");
+}
+
 /** @} */ // Конец группы io_ports
@@ -14,10 +14,18 @@ unsigned char port_byte_in(unsigned short port);
 
 void port_byte_out(unsigned short port, unsigned char data);
 
-unsigned char port_word_in(unsigned short port);
+unsigned short port_word_in(unsigned short port);
 
 void port_word_out(unsigned short port, unsigned short data);
 
+u32 port_dword_in(unsigned short port);
+
+void port_dword_out(unsigned short port, u32 data);
+
+void port_words_in(unsigned short port, void *buffer, u32 count);
+
+void port_words_out(unsigned short port, const void *buffer, u32 count);
+
 
 /**
  * Чтение статуса контроллера клавиатуры.
@@ -40,6 +48,53 @@ static u8 read_scancode() {
     return port_byte_in(0x60); // Чтение из порта данных клавиатуры (0x60)
 }
 
+/**
+ * Разрешение аппаратных прерываний (инструкция STI).
+ */
+static inline void interrupts_enable() {
+    __asm__ volatile("sti" : : : "memory");
+}
+
+/**
+ * Запрет аппаратных прерываний (инструкция CLI).
+ */
+static inline void interrupts_disable() {
+    __asm__ volatile("cli" : : : "memory");
+}
+
+/**
+ * Разрешение прерываний и останов до ближайшего из них.
+ *
+ * @note STI откладывает прием прерываний на одну инструкцию, поэтому пара
+ *       "sti; hlt" атомарна: прерывание, пришедшее между проверкой условия
+ *       под CLI и HLT, разбудит процессор, а не потеряется.
+ */
+static inline void wait_for_interrupt() {
+    __asm__ volatile("sti; hlt" : : : "memory");
+}
+
+/**
+ * Запрет прерываний с сохранением прежнего состояния.
+ *
+ * @return Значение EFLAGS до запрета (для irq_restore())
+ */
+static inline u32 irq_save() {
+    u32 flags;
+    __asm__ volatile("pushf; pop %0; cli" : "=r" (flags) : : "memory");
+    return flags;
+}
+
+/**
+ * Восстановление состояния прерываний, сохраненного irq_save().
+ *
+ * @param flags Значение EFLAGS из irq_save()
+ */
+static inline void irq_restore(u32 flags) {
+    if (flags & 0x200) { // IF
+        __asm__ volatile("sti" : : : "memory");
+    }
+}
+
 /**
  * Выключение системы через ACPI (работает в QEMU и некоторых эмуляторах).
  *
@@ -0,0 +1,532 @@
+/**
+* @file ata.c
+ * @brief Драйвер дисков ATA: PIO и bus-master DMA через контроллер PCI IDE
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup ata Диски ATA
+ * @{
+ */
+
+#include "ata.h"
+#include "pci.h"
+#include "asm_io.h"
+#include "print.h"
+#include "../string.h"
+#include "../cpu/isr.h"
+#include "../cpu/pic.h"
+#include "../mm/pmm.h"
+#include "../mm/paging.h"
+#include "../kernel/sched.h"
+#include "../kernel/ktimer.h"
+
+/**
+ * @brief Канал IDE: до двух дисков, одна команда за раз
+ */
+typedef struct {
+    u16 io;
+    u16 ctrl;
+    u16 bmide;                  ///< Порты bus-master (0 - только PIO)
+    u8 irq;
+    ata_prd_t *prdt;            ///< Таблица PRD (страница из PMM)
+    u8 busy;                    ///< Канал занят командой
+    wait_queue_t lock_wait;     ///< Ждут освобождения канала
+    volatile u8 irq_pending;
+    volatile u8 irq_timeout;    ///< Прерывание не пришло за ATA_IRQ_TIMEOUT_MS
+    volatile u8 status;         ///< Статус устройства из последнего IRQ
+    volatile u8 bm_status;
+    wait_queue_t irq_wait;      ///< Ждет завершения команды
+} ata_channel_t;
+
+/**
+ * @brief Диск на канале
+ */
+typedef struct {
+    ata_channel_t *channel;
+    u8 slave;
+    u8 lba48;
+    u8 dma;
+    char model[41];
+    block_device_t blk;
+} ata_drive_t;
+
+static ata_channel_t channels[2];
+static ata_drive_t drives[4];
+
+static s32 ata_read(block_device_t *dev, u32 lba, u32 count, void *buffer);
+static s32 ata_write(block_device_t *dev, u32 lba, u32 count, const void *buffer);
+
+static const block_ops_t ata_ops = {ata_read, ata_write};
+
+/**
+ * @brief Пауза ~400 нс: четыре чтения альтернативного статуса
+ */
+static void ata_delay(const ata_channel_t *ch) {
+    u32 i;
+    for (i = 0; i < 4; i++) {
+        port_byte_in(ch->ctrl);
+    }
+}
+
+/**
+ * @brief Ждет снятия BSY
+ * @return Статус или -1 по таймауту
+ */
+static s32 ata_wait_ready(const ata_channel_t *ch) {
+    u32 i;
+
+    for (i = 0; i < ATA_TIMEOUT; i++) {
+        const u8 status = port_byte_in(ch->ctrl);
+        if (!(status & ATA_SR_BSY)) {
+            return status;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Ждет готовности к обмену данными (DRQ) при PIO
+ * @return 0 или -1 (ошибка устройства, таймаут)
+ */
+static s32 ata_wait_drq(const ata_channel_t *ch) {
+    u32 i;
+
+    for (i = 0; i < ATA_TIMEOUT; i++) {
+        const u8 status = port_byte_in(ch->ctrl);
+        if (status & (ATA_SR_ERR | ATA_SR_DF)) {
+            return -1;
+        }
+        if (!(status & ATA_SR_BSY) && (status & ATA_SR_DRQ)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Обработчик IRQ14/15
+ * @details Чтение регистра статуса снимает INTRQ устройства, запись
+ * BM_SR_IRQ сбрасывает флаг прерывания контроллера. В native-режиме
+ * каналы могут делить линию: канал с bus-master без BM_SR_IRQ ее не
+ * поднимал и пропускается
+ */
+static void ata_callback(registers_t *regs) {
+    u32 i;
+
+    for (i = 0; i < 2; i++) {
+        ata_channel_t *ch = &channels[i];
+        if (ch->io == 0 || (u32) (IRQ0 + ch->irq) != regs->int_no) {
+            continue;
+        }
+        if (ch->bmide) {
+            ch->bm_status = port_byte_in(ch->bmide + BM_STATUS);
+            if (!(ch->bm_status & BM_SR_IRQ)) {
+                continue;
+            }
+            port_byte_out(ch->bmide + BM_STATUS, ch->bm_status | BM_SR_IRQ);
+        }
+        ch->status = port_byte_in(ch->io + ATA_REG_STATUS);
+        ch->irq_pending = 1;
+        wait_queue_wake_all(&ch->irq_wait);
+    }
+}
+
+/**
+ * @brief Таймер ata_wait_irq(): прерывание потеряно
+ */
+static void ata_irq_expired(void *arg) {
+    ata_channel_t *ch = arg;
+
+    ch->irq_timeout = 1;
+    wait_queue_wake_all(&ch->irq_wait);
+}
+
+/**
+ * @brief Ждет прерывания о завершении этапа команды
+ * @return 0 или -1 (устройство сообщило об ошибке или прерывание не
+ *         пришло за ATA_IRQ_TIMEOUT_MS)
+ */
+static s32 ata_wait_irq(ata_channel_t *ch) {
+    ktimer_t timer;
+
+    timer_setup(&timer, ata_irq_expired, ch, 0);
+    const u32 flags = irq_save();
+    ch->irq_timeout = 0;
+    timer_add(&timer, ATA_IRQ_TIMEOUT_MS, 0);
+    while (!ch->irq_pending && !ch->irq_timeout) {
+        wait_queue_sleep(&ch->irq_wait);
+    }
+    timer_del(&timer);
+    const u8 pending = ch->irq_pending;
+    ch->irq_pending = 0;
+    irq_restore(flags);
+
+    if (!pending) {
+        colored_print(0x04, "ata: IRQ %u timeout (status 0x%x)\n", ch->irq,
+                      port_byte_in(ch->io + ATA_REG_STATUS));
+        return -1;
+    }
+    return (ch->status & (ATA_SR_ERR | ATA_SR_DF)) ? -1 : 0;
+}
+
+static void channel_lock(ata_channel_t *ch) {
+    const u32 flags = irq_save();
+    while (ch->busy) {
+        wait_queue_sleep(&ch->lock_wait);
+    }
+    ch->busy = 1;
+    irq_restore(flags);
+}
+
+static void channel_unlock(ata_channel_t *ch) {
+    ch->busy = 0;
+    wait_queue_wake_all(&ch->lock_wait);
+}
+
+/**
+ * @brief Выбирает диск, загружает адрес и счетчик, подает команду
+ * @param[in] drive Диск
+ * @param[in] lba Первый сектор
+ * @param[in] count Секторов (1..ATA_MAX_SECTORS)
+ * @param[in] cmd28,cmd48 Команда для 28- и 48-битной адресации
+ * @return 0 или -1, если устройство не освободилось
+ *
+ * @note LBA48 используется, только если адрес не помещается в 28 бит:
+ *       для него регистры пишутся дважды
+ */
+static s32 ata_issue(const ata_drive_t *drive, const u32 lba, const u32 count,
+                     const u8 cmd28, const u8 cmd48) {
+    const ata_channel_t *ch = drive->channel;
+
+    if (ata_wait_ready(ch) < 0) {
+        return -1;
+    }
+
+    if (lba + count > 0x0FFFFFFF && drive->lba48) {
+        port_byte_out(ch->io + ATA_REG_DRIVE, 0x40 | (drive->slave << 4));
+        ata_delay(ch);
+        port_byte_out(ch->io + ATA_REG_SECCOUNT, (count >> 8) & 0xFF);
+        port_byte_out(ch->io + ATA_REG_LBA0, lba >> 24);
+        port_byte_out(ch->io + ATA_REG_LBA1, 0);
+        port_byte_out(ch->io + ATA_REG_LBA2, 0);
+        port_byte_out(ch->io + ATA_REG_SECCOUNT, count & 0xFF);
+        port_byte_out(ch->io + ATA_REG_LBA0, lba & 0xFF);
+        port_byte_out(ch->io + ATA_REG_LBA1, (lba >> 8) & 0xFF);
+        port_byte_out(ch->io + ATA_REG_LBA2, (lba >> 16) & 0xFF);
+        port_byte_out(ch->io + ATA_REG_COMMAND, cmd48);
+        return 0;
+    }
+
+    port_byte_out(ch->io + ATA_REG_DRIVE, 0xE0 | (drive->slave << 4) | ((lba >> 24) & 0x0F));
+    ata_delay(ch);
+    port_byte_out(ch->io + ATA_REG_SECCOUNT, count & 0xFF); // 0 - 256 секторов
+    port_byte_out(ch->io + ATA_REG_LBA0, lba & 0xFF);
+    port_byte_out(ch->io + ATA_REG_LBA1, (lba >> 8) & 0xFF);
+    port_byte_out(ch->io + ATA_REG_LBA2, (lba >> 16) & 0xFF);
+    port_byte_out(ch->io + ATA_REG_COMMAND, cmd28);
+    return 0;
+}
+
+/**
+ * @brief Заполняет таблицу PRD для буфера
+ * @param[in,out] ch Канал
+ * @param[in] buffer Виртуальный адрес буфера (четный)
+ * @param[in] bytes Размер
+ * @return 0 или -1 (буфер не отображен или нечетный адрес)
+ *
+ * Буфер разбирается по страницам через таблицы страниц, физически
+ * смежные страницы сливаются в одну запись, пока та не упрется в
+ * границу 64 KB. Буфер из прямого отображения обычно занимает 1-3 записи.
+ */
+static s32 ata_build_prdt(ata_channel_t *ch, const void *buffer, u32 bytes) {
+    u32 virt = (u32) buffer;
+    u32 n = 0;
+    u32 length = 0;
+
+    if (virt & 1) {
+        return -1;
+    }
+
+    while (bytes > 0) {
+        const u32 phys = paging_translate(virt);
+        u32 chunk = PAGE_SIZE - (virt & (PAGE_SIZE - 1));
+        if (chunk > bytes) {
+            chunk = bytes;
+        }
+        if (phys == 0) {
+            return -1;
+        }
+
+        if (n > 0 && ch->prdt[n - 1].phys + length == phys
+            && (ch->prdt[n - 1].phys >> 16) == ((phys + chunk - 1) >> 16)) {
+            length += chunk;
+        } else {
+            if (n > 0) {
+                ch->prdt[n - 1].bytes = length & 0xFFFF; // 64 KB -> 0
+            }
+            if (n == PAGE_SIZE / sizeof(ata_prd_t)) {
+                return -1;
+            }
+            ch->prdt[n].phys = phys;
+            ch->prdt[n].flags = 0;
+            n++;
+            length = chunk;
+        }
+        virt += chunk;
+        bytes -= chunk;
+    }
+
+    ch->prdt[n - 1].bytes = length & 0xFFFF;
+    ch->prdt[n - 1].flags = ATA_PRD_EOT;
+    return 0;
+}
+
+/**
+ * @brief Одна команда DMA
+ * @return 0, -1 (ошибка) или 1 (буфер не подходит для DMA - нужен PIO)
+ */
+static s32 ata_dma(ata_drive_t *drive, const u32 lba, const u32 count, void *buffer, const u8 write) {
+    ata_channel_t *ch = drive->channel;
+    const u16 bm = ch->bmide;
+    const u8 dir = write ? 0 : BM_CMD_READ;
+
+    if (ata_build_prdt(ch, buffer, count * SECTOR_SIZE) != 0) {
+        return 1;
+    }
+
+    port_byte_out(bm + BM_COMMAND, 0);
+    port_dword_out(bm + BM_PRDT, VIRT_TO_PHYS(ch->prdt));
+    port_byte_out(bm + BM_STATUS, port_byte_in(bm + BM_STATUS) | BM_SR_IRQ | BM_SR_ERR);
+    port_byte_out(bm + BM_COMMAND, dir);
+
+    ch->irq_pending = 0;
+    if (write) {
+        if (ata_issue(drive, lba, count, ATA_CMD_WRITE_DMA, ATA_CMD_WRITE_DMA_EXT) != 0) {
+            return -1;
+        }
+    } else if (ata_issue(drive, lba, count, ATA_CMD_READ_DMA, ATA_CMD_READ_DMA_EXT) != 0) {
+        return -1;
+    }
+    port_byte_out(bm + BM_COMMAND, dir | BM_CMD_START);
+
+    const s32 result = ata_wait_irq(ch);
+    port_byte_out(bm + BM_COMMAND, 0);
+    return (result != 0 || (ch->bm_status & BM_SR_ERR)) ? -1 : 0;
+}
+
+/**
+ * @brief Одна команда PIO: прерывание на каждый сектор, данные REP INSW/OUTSW
+ */
+static s32 ata_pio(ata_drive_t *drive, const u32 lba, const u32 count, void *buffer, const u8 write) {
+    ata_channel_t *ch = drive->channel;
+    u16 *words = buffer;
+    u32 i;
+
+    ch->irq_pending = 0;
+    if (write) {
+        if (ata_issue(drive, lba, count, ATA_CMD_WRITE_PIO, ATA_CMD_WRITE_PIO_EXT) != 0) {
+            return -1;
+        }
+        for (i = 0; i < count; i++) {
+            if (ata_wait_drq(ch) != 0) {
+                return -1;
+            }
+            port_words_out(ch->io + ATA_REG_DATA, words, SECTOR_SIZE / 2);
+            words += SECTOR_SIZE / 2;
+            if (ata_wait_irq(ch) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    if (ata_issue(drive, lba, count, ATA_CMD_READ_PIO, ATA_CMD_READ_PIO_EXT) != 0) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (ata_wait_irq(ch) != 0) {
+            return -1;
+        }
+        port_words_in(ch->io + ATA_REG_DATA, words, SECTOR_SIZE / 2);
+        words += SECTOR_SIZE / 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief Передача любого размера: делится на команды по ATA_MAX_SECTORS
+ */
+static s32 ata_transfer(ata_drive_t *drive, u32 lba, u32 count, u8 *buffer, const u8 write) {
+    ata_channel_t *ch = drive->channel;
+    s32 result = 0;
+
+    channel_lock(ch);
+    while (count > 0 && result == 0) {
+        const u32 n = count < ATA_MAX_SECTORS ? count : ATA_MAX_SECTORS;
+
+        result = drive->dma ? ata_dma(drive, lba, n, buffer, write) : 1;
+        if (result == 1) {
+            result = ata_pio(drive, lba, n, buffer, write);
+        }
+        lba += n;
+        count -= n;
+        buffer += n * SECTOR_SIZE;
+    }
+
+    // Данные из кэша записи диска - на носитель
+    const u8 flush = drive->lba48 ? ATA_CMD_FLUSH_EXT : ATA_CMD_FLUSH;
+    if (write && result == 0) {
+        ch->irq_pending = 0;
+        result = ata_issue(drive, 0, 0, flush, flush) == 0 ? ata_wait_irq(ch) : -1;
+    }
+    channel_unlock(ch);
+    return result;
+}
+
+static s32 ata_read(block_device_t *dev, const u32 lba, const u32 count, void *buffer) {
+    return ata_transfer(dev->priv, lba, count, buffer, 0);
+}
+
+static s32 ata_write(block_device_t *dev, const u32 lba, const u32 count, const void *buffer) {
+    return ata_transfer(dev->priv, lba, count, (u8 *) buffer, 1);
+}
+
+/**
+ * @brief Опрашивает диск командой IDENTIFY
+ * @return 0 - диск ATA найден и описан, -1 - нет диска (или ATAPI)
+ *
+ * @note Выполняется опросом статуса: прерывания канала в это время запрещены
+ */
+static s32 ata_identify(ata_drive_t *drive) {
+    const ata_channel_t *ch = drive->channel;
+    u16 id[256];
+    u32 i;
+
+    port_byte_out(ch->io + ATA_REG_DRIVE, 0xA0 | (drive->slave << 4));
+    ata_delay(ch);
+    port_byte_out(ch->io + ATA_REG_SECCOUNT, 0);
+    port_byte_out(ch->io + ATA_REG_LBA0, 0);
+    port_byte_out(ch->io + ATA_REG_LBA1, 0);
+    port_byte_out(ch->io + ATA_REG_LBA2, 0);
+    port_byte_out(ch->io + ATA_REG_COMMAND, ATA_CMD_IDENTIFY);
+
+    const u8 status = port_byte_in(ch->io + ATA_REG_STATUS);
+    if (status == 0 || status == 0xFF || ata_wait_ready(ch) < 0) {
+        return -1;
+    }
+    // Сигнатура ATAPI/SATA в LBA1/LBA2 - это не наш диск
+    if (port_byte_in(ch->io + ATA_REG_LBA1) || port_byte_in(ch->io + ATA_REG_LBA2)) {
+        return -1;
+    }
+    if (ata_wait_drq(ch) != 0) {
+        return -1;
+    }
+    port_words_in(ch->io + ATA_REG_DATA, id, 256);
+    port_byte_in(ch->io + ATA_REG_STATUS);
+
+    // Модель: слова 27-46, байты в словах переставлены
+    for (i = 0; i < 20; i++) {
+        drive->model[i * 2] = id[27 + i] >> 8;
+        drive->model[i * 2 + 1] = id[27 + i] & 0xFF;
+    }
+    for (i = 40; i > 0 && (drive->model[i - 1] == ' ' || drive->model[i - 1] == 0); i--) {
+        drive->model[i - 1] = 0;
+    }
+
+    drive->lba48 = (id[83] >> 10) & 1;
+    drive->blk.sectors = drive->lba48 ? (id[100] | ((u32) id[101] << 16))
+                                      : (id[60] | ((u32) id[61] << 16));
+    drive->dma = ch->bmide != 0 && ((id[49] >> 8) & 1);
+    return drive->blk.sectors ? 0 : -1;
+}
+
+/**
+ * @brief Настраивает канал: порты, PRD, прерывание
+ */
+static void ata_channel_init(ata_channel_t *ch, const u16 io, const u16 ctrl, const u16 bmide, const u8 irq) {
+    ch->io = io;
+    ch->ctrl = ctrl;
+    ch->irq = irq;
+    ch->bmide = 0;
+
+    if (port_byte_in(io + ATA_REG_STATUS) == 0xFF) {
+        ch->io = 0; // Плавающая шина: канала нет
+        return;
+    }
+    port_byte_out(ctrl, ATA_CTRL_NIEN);
+
+    if (bmide) {
+        const u32 page = alloc_page();
+        if (page) {
+            ch->prdt = PHYS_TO_VIRT(page);
+            ch->bmide = bmide;
+        }
+    }
+}
+
+/**
+ * @brief Находит контроллер IDE на PCI и диски на его каналах
+ *
+ * Каналы в режиме совместимости (prog-if бит 0/2 сброшен) используют
+ * стандартные порты и IRQ14/15, в native-режиме - BAR0-3 и линию из
+ * конфигурационного пространства. BAR4 - порты bus-master; без PCI
+ * контроллера остаются стандартные порты и PIO.
+ * Найденные диски регистрируются как блочные устройства hda..hdd.
+ */
+void ata_init() {
+    pci_address_t pci;
+    u16 io[2] = {ATA_PRIMARY_IO, ATA_SECONDARY_IO};
+    u16 ctrl[2] = {ATA_PRIMARY_CTRL, ATA_SECONDARY_CTRL};
+    u8 irq[2] = {ATA_PRIMARY_IRQ, ATA_SECONDARY_IRQ};
+    u16 bmide = 0;
+    u32 i;
+
+    if (pci_find_class(PCI_CLASS_STORAGE, PCI_SUBCLASS_IDE, &pci) == 0) {
+        const u8 prog_if = (pci_read(pci, PCI_CLASS) >> 8) & 0xFF;
+        const u32 bar4 = pci_read(pci, PCI_BAR4);
+
+        for (i = 0; i < 2; i++) {
+            if (prog_if & (1 << (i * 2))) {
+                io[i] = pci_read(pci, PCI_BAR0 + i * 8) & ~3;
+                ctrl[i] = (pci_read(pci, PCI_BAR0 + i * 8 + 4) & ~3) + 2;
+                irq[i] = pci_read(pci, PCI_INTERRUPT) & 0xFF;
+            }
+        }
+        if ((prog_if & 0x80) && (bar4 & 1)) {
+            bmide = bar4 & ~3;
+            pci_enable_bus_master(pci);
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        ata_channel_init(&channels[i], io[i], ctrl[i], bmide ? bmide + i * 8 : 0, irq[i]);
+    }
+
+    for (i = 0; i < 4; i++) {
+        ata_drive_t *drive = &drives[i];
+        drive->channel = &channels[i / 2];
+        drive->slave = i & 1;
+        if (drive->channel->io == 0 || ata_identify(drive) != 0) {
+            continue;
+        }
+
+        strcpy(drive->blk.name, "hda");
+        drive->blk.name[2] = 'a' + i;
+        drive->blk.ops = &ata_ops;
+        drive->blk.priv = drive;
+        block_register(&drive->blk);
+        printf("%s: %s, %u MB, %s%s\n", drive->blk.name, drive->model, drive->blk.sectors / 2048,
+               drive->dma ? "DMA" : "PIO", drive->lba48 ? ", LBA48" : "");
+    }
+
+    for (i = 0; i < 2; i++) {
+        ata_channel_t *ch = &channels[i];
+        if (ch->io == 0) {
+            continue;
+        }
+        register_interrupt_handler(IRQ0 + ch->irq, ata_callback);
+        port_byte_out(ch->ctrl, 0); // Разрешаем INTRQ
+        pic_unmask(ch->irq);
+    }
+}
+
+/** @} */ // Конец группы ata
@@ -0,0 +1,78 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef ATA_H
+#define ATA_H
+
+#include "../common.h"
+#include "block.h"
+
+// Порты каналов в режиме совместимости
+#define ATA_PRIMARY_IO     0x1F0
+#define ATA_PRIMARY_CTRL   0x3F6
+#define ATA_PRIMARY_IRQ    14
+#define ATA_SECONDARY_IO   0x170
+#define ATA_SECONDARY_CTRL 0x376
+#define ATA_SECONDARY_IRQ  15
+
+// Регистры канала (смещения от io)
+#define ATA_REG_DATA     0
+#define ATA_REG_ERROR    1
+#define ATA_REG_FEATURES 1
+#define ATA_REG_SECCOUNT 2
+#define ATA_REG_LBA0     3
+#define ATA_REG_LBA1     4
+#define ATA_REG_LBA2     5
+#define ATA_REG_DRIVE    6
+#define ATA_REG_STATUS   7
+#define ATA_REG_COMMAND  7
+
+#define ATA_SR_ERR  0x01
+#define ATA_SR_DRQ  0x08
+#define ATA_SR_DF   0x20
+#define ATA_SR_DRDY 0x40
+#define ATA_SR_BSY  0x80
+
+#define ATA_CTRL_NIEN 0x02  // Запрет INTRQ
+
+#define ATA_CMD_READ_PIO       0x20
+#define ATA_CMD_READ_PIO_EXT   0x24
+#define ATA_CMD_WRITE_PIO      0x30
+#define ATA_CMD_WRITE_PIO_EXT  0x34
+#define ATA_CMD_READ_DMA       0xC8
+#define ATA_CMD_READ_DMA_EXT   0x25
+#define ATA_CMD_WRITE_DMA      0xCA
+#define ATA_CMD_WRITE_DMA_EXT  0x35
+#define ATA_CMD_FLUSH          0xE7
+#define ATA_CMD_FLUSH_EXT      0xEA
+#define ATA_CMD_IDENTIFY       0xEC
+
+// Регистры bus-master IDE (смещения от BAR4, второй канал +8)
+#define BM_COMMAND 0
+#define BM_STATUS  2
+#define BM_PRDT    4
+
+#define BM_CMD_START 0x01
+#define BM_CMD_READ  0x08   // Направление: устройство -> память
+#define BM_SR_ERR    0x02
+#define BM_SR_IRQ    0x04
+
+#define ATA_MAX_SECTORS 256         // Секторов в одной команде
+#define ATA_PRD_EOT     0x8000      // Последняя запись таблицы PRD
+#define ATA_TIMEOUT     1000000     // Опросов статуса до отказа
+#define ATA_IRQ_TIMEOUT_MS 5000     // Ожидание прерывания до отказа
+
+/**
+ * @brief Запись таблицы PRD (Physical Region Descriptor)
+ * @details Участок не должен пересекать границу 64 KB; размер 0 - 64 KB
+ */
+typedef struct {
+    u32 phys;
+    u16 bytes;
+    u16 flags;
+} __attribute__((packed)) ata_prd_t;
+
+void ata_init();
+
+#endif //ATA_H
@@ -0,0 +1,431 @@
+/**
+* @file bcache.c
+ * @brief Кэш блоков: хеш-таблица, LRU, отложенная запись, упреждающее чтение
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup bcache Кэш блоков
+ * @{
+ */
+
+#include "bcache.h"
+#include "print.h"
+#include "asm_io.h"
+#include "../string.h"
+#include "../mm/pmm.h"
+#include "../kernel/sched.h"
+#include "../kernel/ktimer.h"
+#include "../kernel/command.h"
+
+static buffer_t buffers[BCACHE_BUFFERS];
+static buffer_t *hash_table[BCACHE_HASH_SIZE];
+
+static buffer_t *lru_head = 0;  ///< Недавно использованный
+static buffer_t *lru_tail = 0;  ///< Кандидат на вытеснение
+
+static bcache_stats_t stats;
+
+/**
+ * @brief Промежуточный буфер для многоблочных команд
+ * @details Лежит в .bss, то есть в прямом отображении, и годится для DMA
+ */
+static u8 io_buffer[BCACHE_RA_MAX * SECTOR_SIZE] __attribute__((aligned(PAGE_SIZE)));
+
+static u8 cache_busy = 0;
+static wait_queue_t cache_wait;
+
+/**
+ * @brief Захватывает кэш: блокировка спящая, ввод-вывод идет под ней
+ */
+static void cache_lock() {
+    const u32 flags = irq_save();
+    while (cache_busy) {
+        wait_queue_sleep(&cache_wait);
+    }
+    cache_busy = 1;
+    irq_restore(flags);
+}
+
+static void cache_unlock() {
+    cache_busy = 0;
+    wait_queue_wake_all(&cache_wait);
+}
+
+static u32 hash(const block_device_t *dev, const u32 block) {
+    return (block + ((u32) dev >> 4)) & (BCACHE_HASH_SIZE - 1);
+}
+
+static buffer_t *hash_find(const block_device_t *dev, const u32 block) {
+    buffer_t *buf = hash_table[hash(dev, block)];
+
+    while (buf && (buf->dev != dev || buf->block != block)) {
+        buf = buf->hash_next;
+    }
+    return buf;
+}
+
+static void hash_insert(buffer_t *buf) {
+    const u32 i = hash(buf->dev, buf->block);
+    buf->hash_next = hash_table[i];
+    hash_table[i] = buf;
+}
+
+static void hash_remove(const buffer_t *buf) {
+    buffer_t **link = &hash_table[hash(buf->dev, buf->block)];
+
+    while (*link != buf) {
+        link = &(*link)->hash_next;
+    }
+    *link = buf->hash_next;
+}
+
+static void lru_remove(buffer_t *buf) {
+    if (buf->lru_prev) {
+        buf->lru_prev->lru_next = buf->lru_next;
+    } else {
+        lru_head = buf->lru_next;
+    }
+    if (buf->lru_next) {
+        buf->lru_next->lru_prev = buf->lru_prev;
+    } else {
+        lru_tail = buf->lru_prev;
+    }
+}
+
+static void lru_push_front(buffer_t *buf) {
+    buf->lru_prev = 0;
+    buf->lru_next = lru_head;
+    if (lru_head) {
+        lru_head->lru_prev = buf;
+    } else {
+        lru_tail = buf;
+    }
+    lru_head = buf;
+}
+
+static void lru_push_back(buffer_t *buf) {
+    buf->lru_next = 0;
+    buf->lru_prev = lru_tail;
+    if (lru_tail) {
+        lru_tail->lru_next = buf;
+    } else {
+        lru_head = buf;
+    }
+    lru_tail = buf;
+}
+
+/**
+ * @brief Записывает грязный буфер вместе с соседними грязными блоками
+ * @return 0 или -1
+ *
+ * @note От буфера идем назад к началу грязной серии, но не дальше
+ *       BCACHE_RA_MAX - 1 блоков, затем пишем вперед одной командой до
+ *       BCACHE_RA_MAX блоков: сам буфер всегда попадает в запись. Данные
+ *       при ошибке записи теряются: буферы все равно помечаются чистыми.
+ */
+static s32 buffer_flush_run(buffer_t *buf) {
+    block_device_t *dev = buf->dev;
+    buffer_t *run[BCACHE_RA_MAX];
+    u32 block = buf->block;
+    u32 n = 0;
+    u32 i;
+
+    while (block > 0 && buf->block - block < BCACHE_RA_MAX - 1) {
+        const buffer_t *prev = hash_find(dev, block - 1);
+        if (prev == 0 || !prev->dirty) {
+            break;
+        }
+        block--;
+    }
+    while (n < BCACHE_RA_MAX) {
+        buffer_t *next = hash_find(dev, block + n);
+        if (next == 0 || !next->dirty) {
+            break;
+        }
+        run[n] = next;
+        memcpy(io_buffer + n * SECTOR_SIZE, next->data, SECTOR_SIZE);
+        n++;
+    }
+
+    const s32 result = block_write(dev, block, n, io_buffer);
+    if (result != 0) {
+        colored_print(0x04, "bcache: write error %s:%u (%u blocks)\n", dev->name, block, n);
+    }
+    for (i = 0; i < n; i++) {
+        run[i]->dirty = 0;
+    }
+    stats.writebacks += n;
+    return result;
+}
+
+/**
+ * @brief Освобождает самый давно использованный буфер
+ * @return Буфер вне хеша и LRU или 0, если все буферы заняты
+ */
+static buffer_t *buffer_evict() {
+    buffer_t *buf = lru_tail;
+
+    if (buf == 0) {
+        return 0;
+    }
+    if (buf->dirty) {
+        buffer_flush_run(buf);
+    }
+    lru_remove(buf);
+    if (buf->dev) {
+        hash_remove(buf);
+        stats.evictions += buf->valid;
+    }
+    buf->dev = 0;
+    buf->valid = 0;
+    buf->readahead = 0;
+    return buf;
+}
+
+/**
+ * @brief Размер окна упреждающего чтения для промаха по блоку
+ * @details Промах ровно там, где ожидался следующий блок, удваивает окно
+ * (от BCACHE_RA_MIN до BCACHE_RA_MAX); любой другой промах - случайный
+ * доступ, читается только запрошенный блок
+ */
+static u32 readahead_window(block_device_t *dev, const u32 block) {
+    if (block != dev->ra_next || block == 0) {
+        dev->ra_window = 1;
+    } else if (dev->ra_window < BCACHE_RA_MIN) {
+        dev->ra_window = BCACHE_RA_MIN;
+    } else if (dev->ra_window < BCACHE_RA_MAX) {
+        dev->ra_window *= 2;
+    }
+    return dev->ra_window;
+}
+
+/**
+ * @brief Возвращает буфер с содержимым блока
+ * @param[in] dev Устройство
+ * @param[in] block Номер блока (сектора)
+ * @return Буфер со ссылкой (вернуть через brelse) или 0 при ошибке
+ *
+ * @note Попадание - O(1): поиск в хеше и снятие с LRU. При промахе
+ *       одной командой читаются блок и следующие за ним некэшированные
+ *       блоки в пределах окна упреждающего чтения.
+ */
+buffer_t *bread(block_device_t *dev, const u32 block) {
+    buffer_t *run[BCACHE_RA_MAX];
+    u32 count;
+    u32 n = 0;
+    u32 i;
+
+    if (block >= dev->sectors) {
+        return 0;
+    }
+
+    cache_lock();
+    stats.lookups++;
+
+    buffer_t *buf = hash_find(dev, block);
+    if (buf) {
+        stats.hits++;
+        if (buf->readahead) {
+            stats.readahead_hits++;
+            buf->readahead = 0;
+        }
+        if (buf->refcount++ == 0) {
+            lru_remove(buf);
+        }
+        dev->ra_next = block + 1;
+        cache_unlock();
+        return buf;
+    }
+    stats.misses++;
+
+    count = readahead_window(dev, block);
+    if (count > dev->sectors - block) {
+        count = dev->sectors - block;
+    }
+    while (n < count && (n == 0 || hash_find(dev, block + n) == 0)) {
+        run[n] = buffer_evict();
+        if (run[n] == 0) {
+            break;
+        }
+        n++;
+    }
+    if (n == 0) {
+        cache_unlock();
+        colored_print(0x04, "bcache: all buffers in use\n");
+        return 0;
+    }
+
+    // Один блок читается прямо в буфер, серия - через io_buffer
+    const s32 result = block_read(dev, block, n, n == 1 ? run[0]->data : io_buffer);
+    if (result != 0) {
+        for (i = 0; i < n; i++) {
+            lru_push_back(run[i]);
+        }
+        cache_unlock();
+        return 0;
+    }
+
+    for (i = 0; i < n; i++) {
+        buf = run[i];
+        if (n > 1) {
+            memcpy(buf->data, io_buffer + i * SECTOR_SIZE, SECTOR_SIZE);
+        }
+        buf->dev = dev;
+        buf->block = block + i;
+        buf->valid = 1;
+        buf->dirty = 0;
+        buf->readahead = i > 0;
+        hash_insert(buf);
+        if (i > 0) {
+            buf->refcount = 0;
+            lru_push_front(buf);
+        }
+    }
+    stats.readahead += n - 1;
+    dev->ra_next = block + 1;
+
+    buf = run[0];
+    buf->refcount = 1;
+    cache_unlock();
+    return buf;
+}
+
+/**
+ * @brief Помечает буфер измененным: он будет записан при вытеснении,
+ * bcache_sync() или фоновой записью
+ */
+void bdirty(buffer_t *buf) {
+    buf->dirty = 1;
+}
+
+/**
+ * @brief Отпускает буфер, полученный через bread()
+ */
+void brelse(buffer_t *buf) {
+    cache_lock();
+    if (--buf->refcount == 0) {
+        lru_push_front(buf);
+    }
+    cache_unlock();
+}
+
+/**
+ * @brief Копирует блоки через кэш
+ * @param[in] dev Устройство
+ * @param[in] block Первый блок
+ * @param[in] count Число блоков
+ * @param[out] buffer Приемник (count * SECTOR_SIZE байт)
+ * @return 0 или -1
+ */
+s32 bcache_read(block_device_t *dev, const u32 block, const u32 count, void *buffer) {
+    u8 *out = buffer;
+    u32 i;
+
+    for (i = 0; i < count; i++) {
+        buffer_t *buf = bread(dev, block + i);
+        if (buf == 0) {
+            return -1;
+        }
+        memcpy(out + i * SECTOR_SIZE, buf->data, SECTOR_SIZE);
+        brelse(buf);
+    }
+    return 0;
+}
+
+/**
+ * @brief Записывает все грязные буферы устройства
+ * @param[in] dev Устройство или 0 - все устройства
+ * @return 0 или -1, если хотя бы одна запись не удалась
+ */
+s32 bcache_sync(block_device_t *dev) {
+    s32 result = 0;
+    u32 i;
+
+    cache_lock();
+    for (i = 0; i < BCACHE_BUFFERS; i++) {
+        buffer_t *buf = &buffers[i];
+        if (buf->dirty && (dev == 0 || buf->dev == dev) && buffer_flush_run(buf) != 0) {
+            result = -1;
+        }
+    }
+    cache_unlock();
+    return result;
+}
+
+/**
+ * @brief Поток фоновой записи: раз в BCACHE_FLUSH_MS сбрасывает грязные буферы
+ */
+static void bcache_flusher(void *arg) {
+    (void) arg;
+    while (1) {
+        msleep(BCACHE_FLUSH_MS);
+        bcache_sync(0);
+    }
+}
+
+/**
+ * @brief Выделяет буферы одним блоком страниц и запускает фоновую запись
+ *
+ * @note Вызывать после sched_init()
+ */
+void bcache_init() {
+    const u32 pages = BCACHE_BUFFERS * SECTOR_SIZE / PAGE_SIZE;
+    u32 order = 0;
+    u32 i;
+
+    while ((1u << order) < pages) {
+        order++;
+    }
+    const u32 pool = alloc_pages(order);
+    if (pool == 0) {
+        colored_print(0x04, "bcache: no memory for %u buffers\n", BCACHE_BUFFERS);
+        return;
+    }
+
+    for (i = 0; i < BCACHE_BUFFERS; i++) {
+        buffers[i].data = (u8 *) PHYS_TO_VIRT(pool) + i * SECTOR_SIZE;
+        lru_push_back(&buffers[i]);
+    }
+    thread_create("bflush", bcache_flusher, 0, SCHED_PRIO_LOW);
+}
+
+/**
+ * @brief Возвращает снимок счетчиков
+ */
+void bcache_get_stats(bcache_stats_t *out) {
+    *out = stats;
+}
+
+/**
+ * @brief Печатает заполнение и счетчики кэша (команда bcache)
+ */
+void bcache_print_stats() {
+    u32 used = 0;
+    u32 dirty = 0;
+    u32 i;
+
+    for (i = 0; i < BCACHE_BUFFERS; i++) {
+        used += buffers[i].valid;
+        dirty += buffers[i].dirty;
+    }
+
+    printf("Buffers: %u/%u used, %u dirty, %u KB\n", used, BCACHE_BUFFERS, dirty,
+           BCACHE_BUFFERS * SECTOR_SIZE / 1024);
+    printf("Lookups: %u, hits %u (%u%%), misses %u\n", stats.lookups, stats.hits,
+           stats.lookups ? stats.hits * 100 / stats.lookups : 0, stats.misses);
+    printf("Read-ahead: %u blocks, %u used\n", stats.readahead, stats.readahead_hits);
+    printf("Evictions: %u, written back: %u\n", stats.evictions, stats.writebacks);
+}
+
+static s32 cmd_bcache(u32 argc, char **argv) {
+    bcache_print_stats();
+    return 0;
+}
+
+static s32 cmd_sync(u32 argc, char **argv) {
+    return bcache_sync(0);
+}
+
+COMMAND("bcache", cmd_bcache, "", "Buffer cache statistics");
+COMMAND("sync", cmd_sync, "", "Write dirty buffers to disk");
+
+/** @} */ // Конец группы bcache
@@ -0,0 +1,55 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef BCACHE_H
+#define BCACHE_H
+
+#include "../common.h"
+#include "block.h"
+
+#define BCACHE_BUFFERS   512    // Буферов по SECTOR_SIZE: 256 KB
+#define BCACHE_HASH_SIZE 256    // Корзин хеш-таблицы (степень двойки)
+#define BCACHE_RA_MIN    4      // Начальное окно упреждающего чтения
+#define BCACHE_RA_MAX    32     // Предельное окно (блоков за одну команду)
+#define BCACHE_FLUSH_MS  5000   // Период фоновой записи грязных буферов
+
+/**
+ * @brief Буфер кэша: копия одного сектора устройства
+ */
+typedef struct buffer {
+    block_device_t *dev;
+    u32 block;
+    u8 *data;
+    u8 valid;                   ///< Данные прочитаны с устройства
+    u8 dirty;                   ///< Изменен, еще не записан
+    u8 readahead;               ///< Прочитан заранее и еще не запрошен
+    u32 refcount;
+    struct buffer *hash_next;
+    struct buffer *lru_prev;    ///< В списке LRU, только пока refcount == 0
+    struct buffer *lru_next;
+} buffer_t;
+
+/**
+ * @brief Счетчики кэша
+ */
+typedef struct {
+    u32 lookups;
+    u32 hits;
+    u32 misses;
+    u32 readahead;              ///< Блоков прочитано заранее
+    u32 readahead_hits;         ///< Из них потом запрошено
+    u32 evictions;
+    u32 writebacks;             ///< Блоков записано на устройство
+} bcache_stats_t;
+
+void bcache_init();
+buffer_t *bread(block_device_t *dev, u32 block);
+void bdirty(buffer_t *buf);
+void brelse(buffer_t *buf);
+s32 bcache_read(block_device_t *dev, u32 block, u32 count, void *buffer);
+s32 bcache_sync(block_device_t *dev);
+void bcache_get_stats(bcache_stats_t *stats);
+void bcache_print_stats();
+
+#endif //BCACHE_H
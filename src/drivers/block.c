@@ -0,0 +1,108 @@
+/**
+* @file block.c
+ * @brief Общий интерфейс блочных устройств
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup block Блочные устройства
+ * @{
+ */
+
+#include "block.h"
+#include "print.h"
+#include "../string.h"
+#include "../kernel/command.h"
+
+static block_device_t *devices[BLOCK_MAX_DEVICES];
+static u32 device_count = 0;
+
+/**
+ * @brief Регистрирует устройство
+ * @return 0 или -1, если таблица заполнена
+ */
+s32 block_register(block_device_t *dev) {
+    if (device_count == BLOCK_MAX_DEVICES) {
+        return -1;
+    }
+    devices[device_count++] = dev;
+    return 0;
+}
+
+/**
+ * @brief Поиск устройства по имени ("hda", ...)
+ * @return Устройство или 0
+ */
+block_device_t *block_get(const char *name) {
+    u32 i;
+
+    for (i = 0; i < device_count; i++) {
+        if (strcmp(devices[i]->name, name) == 0) {
+            return devices[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Устройство по порядковому номеру регистрации
+ * @return Устройство или 0
+ */
+block_device_t *block_get_index(const u32 index) {
+    return index < device_count ? devices[index] : 0;
+}
+
+/**
+ * @brief Читает секторы с устройства
+ * @param[in] dev Устройство
+ * @param[in] lba Первый сектор
+ * @param[in] count Число секторов
+ * @param[out] buffer Приемник (count * SECTOR_SIZE байт)
+ * @return 0 или -1 (выход за границу устройства, ошибка драйвера)
+ */
+s32 block_read(block_device_t *dev, const u32 lba, const u32 count, void *buffer) {
+    if (count == 0 || lba >= dev->sectors || count > dev->sectors - lba) {
+        return -1;
+    }
+    dev->reads++;
+    dev->read_sectors += count;
+    return dev->ops->read(dev, lba, count, buffer);
+}
+
+/**
+ * @brief Записывает секторы на устройство
+ * @return 0 или -1
+ */
+s32 block_write(block_device_t *dev, const u32 lba, const u32 count, const void *buffer) {
+    if (count == 0 || lba >= dev->sectors || count > dev->sectors - lba || dev->ops->write == 0) {
+        return -1;
+    }
+    dev->writes++;
+    dev->write_sectors += count;
+    return dev->ops->write(dev, lba, count, buffer);
+}
+
+/**
+ * @brief Печатает список устройств (команда lsblk)
+ */
+void block_print_devices() {
+    u32 i;
+
+    if (device_count == 0) {
+        printf("no block devices\n");
+        return;
+    }
+    printf("NAME     SIZE MB    READS  SECTORS   WRITES  SECTORS\n");
+    for (i = 0; i < device_count; i++) {
+        const block_device_t *dev = devices[i];
+        printf("%-8s %7u %8u %8u %8u %8u\n", dev->name, dev->sectors / 2048,
+               dev->reads, dev->read_sectors, dev->writes, dev->write_sectors);
+    }
+}
+
+static s32 cmd_lsblk(u32 argc, char **argv) {
+    block_print_devices();
+    return 0;
+}
+
+COMMAND("lsblk", cmd_lsblk, "", "Block devices and I/O counters");
+
+/** @} */ // Конец группы block
@@ -0,0 +1,49 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include "../common.h"
+
+#define BLOCK_MAX_DEVICES 8
+#define BLOCK_NAME_LEN    8
+#define SECTOR_SIZE       512
+
+typedef struct block_device block_device_t;
+
+/**
+ * @brief Операции драйвера
+ * @details count - число секторов; буфер - любой адрес ядра (драйвер сам
+ * решает, передавать ли его через DMA или через порты)
+ */
+typedef struct {
+    s32 (*read)(block_device_t *dev, u32 lba, u32 count, void *buffer);
+    s32 (*write)(block_device_t *dev, u32 lba, u32 count, const void *buffer);
+} block_ops_t;
+
+/**
+ * @brief Блочное устройство
+ */
+struct block_device {
+    char name[BLOCK_NAME_LEN];
+    u32 sectors;                ///< Размер в секторах по SECTOR_SIZE
+    const block_ops_t *ops;
+    void *priv;                 ///< Данные драйвера
+    u32 reads;                  ///< Счетчики запросов и секторов
+    u32 writes;
+    u32 read_sectors;
+    u32 write_sectors;
+    u32 ra_next;                ///< Ожидаемый следующий блок (см. bcache)
+    u32 ra_window;              ///< Текущее окно упреждающего чтения
+};
+
+s32 block_register(block_device_t *dev);
+block_device_t *block_get(const char *name);
+block_device_t *block_get_index(u32 index);
+s32 block_read(block_device_t *dev, u32 lba, u32 count, void *buffer);
+s32 block_write(block_device_t *dev, u32 lba, u32 count, const void *buffer);
+void block_print_devices();
+
+#endif //BLOCK_H
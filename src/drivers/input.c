@@ -8,6 +8,7 @@
 #include "input.h"
 #include "keyboard.h"
 #include "screen.h"
+#include "serial.h"
 
 /**
  * @brief Считывает строку с клавиатуры с обработкой специальных символов
@@ -19,6 +20,8 @@
  * - Поддерживает обработку Backspace (удаление последнего символа)
  * - Завершает ввод при получении символа новой строки (Enter)
  * - Выводит вводимые символы на экран в реальном времени
+ *   (screen_write() сбрасывает каждое эхо на экран под блокировкой
+ *   экрана) и дублирует эхо в COM1
  * - Гарантирует нуль-терминацию строки
  *
  * @warning
@@ -26,7 +29,7 @@
  * - При max_size = 1 буфер будет сразу завершен нулем
  *
  * @see getchar() Для получения символов с клавиатуры
- * @see putchar() Для отображения символов на экране
+ * @see screen_write() Для отображения символов на экране
  */
 void scanf(char *buffer, u32 max_size) {
     u32 index = 0;
@@ -34,18 +37,21 @@ void scanf(char *buffer, u32 max_size) {
         char c = getchar();
         if (c == '\n') { // Enter
             buffer[index] = '\0';
-            putchar('\n', GREEN_ON_BLACK);
+            screen_write("\n", 1, GREEN_ON_BLACK);
+            serial_write("\n", 1);
             return;
         }
 
         if (c == '\b') { // Backspace
             if (index > 0) {
                 index--;
-                putchar('\b', GREEN_ON_BLACK);
+                screen_write("\b", 1, GREEN_ON_BLACK);
+                serial_write("\b \b", 3);
             }
         } else if (c != 0 && index < max_size - 1) {
             buffer[index++] = c;
-            putchar(c, GREEN_ON_BLACK);
+            screen_write(&c, 1, GREEN_ON_BLACK);
+            serial_write(&c, 1);
         }
     }
 }
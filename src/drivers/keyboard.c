@@ -9,6 +9,40 @@
 
 #include "keyboard.h"
 #include "asm_io.h"
+#include "../cpu/isr.h"
+#include "../cpu/pic.h"
+#include "screen.h"
+#include "../kernel/sched.h"
+#include "../kernel/trace.h"
+
+/**
+ * @brief Кольцевой буфер скан-кодов
+ * @details Один писатель (обработчик IRQ1) и один читатель (getchar()),
+ * поэтому блокировки не нужны: kbd_head меняет только прерывание,
+ * kbd_tail - только читатель. Индексы 8-битные и переполняются
+ * естественным образом, один слот всегда остается свободным.
+ */
+static volatile u8 kbd_buffer[KBD_BUFFER_SIZE];
+static volatile u8 kbd_head = 0; ///< Следующая позиция записи (IRQ1)
+static volatile u8 kbd_tail = 0; ///< Следующая позиция чтения
+
+/**
+ * @brief Счетчик скан-кодов, отброшенных из-за переполнения буфера
+ */
+volatile u32 kbd_dropped = 0;
+
+/**
+ * @brief Готовые символы от других источников ввода (COM1)
+ * @details Такой же кольцевой буфер с одним писателем в прерывании
+ */
+static volatile char char_buffer[KBD_BUFFER_SIZE];
+static volatile u8 char_head = 0;
+static volatile u8 char_tail = 0;
+
+/**
+ * @brief Потоки, ждущие ввода
+ */
+static wait_queue_t kbd_wait;
 
 /**
  * @brief Таблица преобразования базовых скан-кодов в ASCII
@@ -98,33 +132,158 @@ char scancode_to_ascii(u8 scancode) {
     return c;
 }
 
+/**
+ * @brief Обработчик IRQ1: переносит скан-код из контроллера в буфер
+ * @param[in] regs Регистры прерванного кода (не используются)
+ *
+ * @note Выполняется с запрещенными прерываниями и не трогает экран,
+ *       поэтому нажатия не теряются даже во время длинного вывода
+ */
+static void keyboard_callback(registers_t *regs) {
+    const u8 scancode = read_scancode();
+    const u8 next = kbd_head + 1;
+
+    if (next == kbd_tail) {
+        kbd_dropped++;
+        return;
+    }
+
+    kbd_buffer[kbd_head] = scancode;
+    __asm__ volatile("" : : : "memory"); // Данные видны раньше индекса
+    kbd_head = next;
+    wait_queue_wake_all(&kbd_wait);
+}
+
+/**
+ * @brief Добавляет готовый символ во ввод
+ * @param[in] c Символ ASCII
+ *
+ * @note Вызывается из обработчиков прерываний других устройств
+ *       (последовательный порт); getchar() вернет символ наравне с
+ *       нажатиями клавиш
+ */
+void keyboard_push_char(const char c) {
+    const u8 next = char_head + 1;
+
+    if (next == char_tail) {
+        kbd_dropped++;
+        return;
+    }
+
+    char_buffer[char_head] = c;
+    __asm__ volatile("" : : : "memory");
+    char_head = next;
+    wait_queue_wake_all(&kbd_wait);
+}
+
+/**
+ * @brief Инициализирует драйвер клавиатуры
+ *
+ * @note Очищает выходной буфер контроллера, регистрирует обработчик
+ *       IRQ1 и снимает маску линии в PIC. Вызывать после isr_install().
+ */
+void keyboard_init() {
+    while (keyboard_status() & 0x01) {
+        read_scancode();
+    }
+
+    register_interrupt_handler(IRQ1, keyboard_callback);
+    pic_unmask(1);
+}
+
+/**
+ * @brief Проверяет наличие ввода (скан-кодов или готовых символов)
+ * @return 1 - буфер не пуст, 0 - пуст
+ */
+u8 keyboard_has_input() {
+    return kbd_head != kbd_tail || char_head != char_tail;
+}
+
+/**
+ * @brief Блокирующее чтение скан-кода из буфера
+ * @return Очередной скан-код (включая коды отпускания)
+ *
+ * @note Пока буфер пуст, поток спит в очереди kbd_wait и процессор
+ *       достается другим потокам. Проверка и постановка в очередь
+ *       выполняются при запрещенных прерываниях, поэтому IRQ1 не может
+ *       проскочить между ними.
+ */
+u8 keyboard_read_scancode() {
+    const u32 flags = irq_save();
+    while (kbd_head == kbd_tail) {
+        wait_queue_sleep(&kbd_wait);
+    }
+    irq_restore(flags);
+
+    const u8 scancode = kbd_buffer[kbd_tail];
+    __asm__ volatile("" : : : "memory"); // Чтение слота до освобождения
+    kbd_tail = kbd_tail + 1;
+    return scancode;
+}
+
 /**
  * @brief Блокирующее чтение символа с клавиатуры
  * @return Введенный символ ASCII (игнорирует служебные коды)
  *
  * @note Алгоритм работы:
- * 1. Ожидает установку флага доступности данных (бит 0 статуса)
- * 2. Читает скан-код через порт 0x60
+ * 0. Готовый символ от keyboard_push_char() возвращается сразу
+ * 1. Забирает скан-код из буфера IRQ1 (поток спит, пока ввода нет)
+ * 2. Обрабатывает префикс 0xE0: Shift+PgUp/PgDn прокручивают историю
+ *    экрана через screen_scrollback()
  * 3. Преобразует через scancode_to_ascii()
  * 4. Возвращает только валидные символы
  *
  * @warning Функция блокирует выполнение до получения символа
  * @see scancode_to_ascii() Для деталей преобразования кодов
+ * @see keyboard_read_scancode() Для ожидания данных
  */
 char getchar() {
-    u8 scancode;
+    u8 extended = 0;
+
     while (1) {
-        // Ожидаем активное состояние клавиатуры
-        while ((keyboard_status() & 0x01) == 0);
+        const u32 flags = irq_save();
+        while (!keyboard_has_input()) {
+            wait_queue_sleep(&kbd_wait);
+        }
+        irq_restore(flags);
 
-        // Читаем скан-код
-        scancode = read_scancode();
+        if (char_head != char_tail) {
+            const char c = char_buffer[char_tail];
+            __asm__ volatile("" : : : "memory");
+            char_tail = char_tail + 1;
+            TRACE_EVENT1(TRACE_GETCHAR, c);
+            return c;
+        }
+
+        const u8 scancode = keyboard_read_scancode();
+
+        if (scancode == KEY_EXTENDED) {
+            extended = 1;
+            continue;
+        }
+
+        if (extended) {
+            extended = 0;
+            // Shift+PgUp/PgDn листают историю экрана
+            if (shift_pressed && scancode == KEY_PAGE_UP) {
+                screen_scrollback(MAX_ROWS - 1);
+            } else if (shift_pressed && scancode == KEY_PAGE_DOWN) {
+                screen_scrollback(-(MAX_ROWS - 1));
+            }
+            // Остальные расширенные коды (включая фиктивные Shift,
+            // которые клавиатура шлет вокруг серых клавиш) пропускаются
+            if ((scancode & 0x7F) == 0x2A || (scancode & 0x7F) == 0x36
+                || scancode == KEY_PAGE_UP || scancode == KEY_PAGE_DOWN) {
+                continue;
+            }
+        }
 
         // Обрабатываем скан-код (включая обновление shift_pressed)
-        char result = scancode_to_ascii(scancode);
+        const char result = scancode_to_ascii(scancode);
 
         // Возвращаем результат только для валидных нажатий
         if (!(scancode & 0x80) && result != 0) {
+            TRACE_EVENT2(TRACE_GETCHAR, result, scancode);
             return result;
         }
     }
@@ -7,8 +7,18 @@
 
 #include "../common.h"
 
+#define KBD_BUFFER_SIZE 256 // Размер кольцевого буфера скан-кодов (индексы u8)
+
+#define KEY_EXTENDED  0xE0  // Префикс расширенного скан-кода
+#define KEY_PAGE_UP   0x49  // PgUp (после 0xE0)
+#define KEY_PAGE_DOWN 0x51  // PgDn (после 0xE0)
+
 char scancode_to_ascii(u8 scancode);
 char getchar();
+void keyboard_init();
+u8 keyboard_has_input();
+u8 keyboard_read_scancode();
+void keyboard_push_char(char c);
 
 
 #endif //KEYBOARD_H
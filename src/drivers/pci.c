@@ -0,0 +1,90 @@
+/**
+* @file pci.c
+ * @brief Доступ к конфигурационному пространству PCI (механизм #1)
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup pci Шина PCI
+ * @{
+ */
+
+#include "pci.h"
+#include "asm_io.h"
+
+/**
+ * @brief Читает 32-битный регистр конфигурационного пространства
+ * @param[in] addr Шина, устройство, функция
+ * @param[in] offset Смещение регистра (кратно 4)
+ */
+u32 pci_read(const pci_address_t addr, const u8 offset) {
+    const u32 flags = irq_save(); // Пара адрес/данные не должна разорваться
+    port_dword_out(PCI_CONFIG_ADDRESS, 0x80000000u | (addr.bus << 16) | (addr.device << 11)
+                                       | (addr.function << 8) | (offset & 0xFC));
+    const u32 value = port_dword_in(PCI_CONFIG_DATA);
+    irq_restore(flags);
+    return value;
+}
+
+/**
+ * @brief Записывает 32-битный регистр конфигурационного пространства
+ */
+void pci_write(const pci_address_t addr, const u8 offset, const u32 value) {
+    const u32 flags = irq_save();
+    port_dword_out(PCI_CONFIG_ADDRESS, 0x80000000u | (addr.bus << 16) | (addr.device << 11)
+                                       | (addr.function << 8) | (offset & 0xFC));
+    port_dword_out(PCI_CONFIG_DATA, value);
+    irq_restore(flags);
+}
+
+/**
+ * @brief Ищет первую функцию с заданным классом и подклассом
+ * @param[in] class Класс устройства
+ * @param[in] subclass Подкласс
+ * @param[out] out Адрес найденной функции
+ * @return 0 или -1, если устройство не найдено
+ *
+ * @note Перебор всех шин грубой силой: 256 * 32 чтения, выполняется
+ *       один раз при загрузке
+ */
+s32 pci_find_class(const u8 class, const u8 subclass, pci_address_t *out) {
+    pci_address_t addr;
+    u32 bus, device, function;
+
+    for (bus = 0; bus < 256; bus++) {
+        for (device = 0; device < 32; device++) {
+            for (function = 0; function < 8; function++) {
+                addr.bus = bus;
+                addr.device = device;
+                addr.function = function;
+
+                if ((pci_read(addr, PCI_VENDOR_ID) & 0xFFFF) == 0xFFFF) {
+                    if (function == 0) {
+                        break;  // Устройства нет
+                    }
+                    continue;
+                }
+
+                const u32 id = pci_read(addr, PCI_CLASS);
+                if ((id >> 24) == class && ((id >> 16) & 0xFF) == subclass) {
+                    *out = addr;
+                    return 0;
+                }
+
+                if (function == 0 && !(pci_read(addr, PCI_HEADER) & 0x00800000)) {
+                    break;      // Однофункциональное устройство
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Разрешает устройству доступ к портам и bus-master DMA
+ */
+void pci_enable_bus_master(const pci_address_t addr) {
+    const u32 command = pci_read(addr, PCI_COMMAND);
+    // Старшая половина - регистр статуса с битами "запись 1 сбрасывает"
+    pci_write(addr, PCI_COMMAND, (command & 0xFFFF) | PCI_COMMAND_IO | PCI_COMMAND_MASTER);
+}
+
+/** @} */ // Конец группы pci
@@ -0,0 +1,43 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef PCI_H
+#define PCI_H
+
+#include "../common.h"
+
+#define PCI_CONFIG_ADDRESS 0xCF8
+#define PCI_CONFIG_DATA    0xCFC
+
+// Смещения в конфигурационном пространстве
+#define PCI_VENDOR_ID  0x00
+#define PCI_COMMAND    0x04
+#define PCI_CLASS      0x08     // Ревизия | prog-if | подкласс | класс
+#define PCI_HEADER     0x0C     // Старший бит типа заголовка - многофункциональное
+#define PCI_BAR0       0x10
+#define PCI_BAR4       0x20
+#define PCI_INTERRUPT  0x3C
+
+#define PCI_COMMAND_IO     0x01
+#define PCI_COMMAND_MEMORY 0x02
+#define PCI_COMMAND_MASTER 0x04 // Разрешение bus-master DMA
+
+#define PCI_CLASS_STORAGE 0x01
+#define PCI_SUBCLASS_IDE  0x01
+
+/**
+ * @brief Адрес функции на шине PCI
+ */
+typedef struct {
+    u8 bus;
+    u8 device;
+    u8 function;
+} pci_address_t;
+
+u32 pci_read(pci_address_t addr, u8 offset);
+void pci_write(pci_address_t addr, u8 offset, u32 value);
+s32 pci_find_class(u8 class, u8 subclass, pci_address_t *out);
+void pci_enable_bus_master(pci_address_t addr);
+
+#endif //PCI_H
@@ -10,113 +10,292 @@
 #include "print.h"
 #include "../common.h"
 #include "screen.h"
-#include <stdarg.h>
+#include "serial.h"
 
 /**
- * @brief Преобразует беззнаковое целое в строку с указанным основанием
- * @param value Число для преобразования
- * @param[out] buf Буфер для результата (минимальный размер: 32 байта для base=16)
- * @param base Основание системы счисления (поддерживается 10 или 16)
- *
- * @note Особенности:
- * - Для base=16 добавляет префикс "0x"
- * - Буфер заполняется в обратном порядке с последующим разворотом
- * - Не поддерживает отрицательные числа
+ * @brief Флаги спецификатора формата
+ */
+#define FMT_LEFT   0x01 ///< '-': выравнивание по левому краю
+#define FMT_ZERO   0x02 ///< '0': дополнение нулями
+#define FMT_UPPER  0x04 ///< Заглавные шестнадцатеричные цифры (%X)
+#define FMT_PREFIX 0x08 ///< Префикс "0x" (%x, %p)
+
+/**
+ * @brief Состояние вывода в буфер
+ * @details len считает все сгенерированные символы, даже не поместившиеся
+ * в буфер, как того требует семантика snprintf()
+ */
+typedef struct {
+    char *buf;
+    u32 size;
+    u32 len;
+} fmt_out_t;
+
+/**
+ * @brief Добавляет символ в буфер, если осталось место под терминатор
+ */
+static void fmt_putc(fmt_out_t *out, const char c) {
+    if (out->len + 1 < out->size) {
+        out->buf[out->len] = c;
+    }
+    out->len++;
+}
+
+/**
+ * @brief Добавляет символ count раз (для выравнивания)
+ */
+static void fmt_pad(fmt_out_t *out, const char c, s32 count) {
+    while (count-- > 0) {
+        fmt_putc(out, c);
+    }
+}
+
+/**
+ * @brief Форматирует целое число
+ * @param[in,out] out Буфер вывода
+ * @param[in] value Модуль числа
+ * @param[in] negative Число отрицательное (выводится '-')
+ * @param[in] base Основание системы счисления (10 или 16)
+ * @param[in] width Минимальная ширина поля
+ * @param[in] precision Минимальное количество цифр (-1 - не задано)
+ * @param[in] flags Комбинация FMT_*
  *
- * @warning Не проверяет размер буфера! Для base=10 требуется минимум 10 символов,
- *          для base=16 - 10 символов + 2 символа префикса
+ * @note Цифры строятся в обратном порядке во временном буфере;
+ *       при заданной точности флаг '0' игнорируется, как в C99
  */
-static void itoa(u32 value, char *buf, u8 base) {
-    static const char digits[] = "0123456789abcdef";
-    char *ptr = buf;
-    u32 tmp = value;
-
-    // Генерация строки в обратном порядке
-    do {
-        *ptr++ = digits[tmp % base];
-        tmp /= base;
-    } while (tmp > 0);
-
-    // Добавление префикса для шестнадцатеричных чисел
-    if (base == 16) {
-        *ptr++ = 'x';
-        *ptr++ = '0';
+static void fmt_number(fmt_out_t *out, u64 value, const u8 negative, const u32 base,
+                       s32 width, const s32 precision, const u8 flags) {
+    const char *digits = (flags & FMT_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[24];
+    s32 n = 0;
+
+    // При нулевой точности ноль не выводится вовсе
+    if (value != 0 || precision != 0) {
+        do {
+            tmp[n++] = digits[div64(&value, base)];
+        } while (value != 0);
+    }
+
+    s32 zeros = precision > n ? precision - n : 0;
+    s32 prefix = (negative ? 1 : 0) + ((flags & FMT_PREFIX) ? 2 : 0);
+    s32 pad = width - n - zeros - prefix;
+
+    if ((flags & FMT_ZERO) && !(flags & FMT_LEFT) && precision < 0) {
+        zeros += pad > 0 ? pad : 0;
+        pad = 0;
     }
 
-    *ptr = '\0';
-
-    // Разворот строки для правильного порядка символов
-    char *start = buf;
-    char *end = ptr - 1;
-    while (start < end) {
-        char tmp = *start;
-        *start = *end;
-        *end = tmp;
-        start++;
-        end--;
+    if (!(flags & FMT_LEFT)) {
+        fmt_pad(out, ' ', pad);
+    }
+    if (negative) {
+        fmt_putc(out, '-');
+    }
+    if (flags & FMT_PREFIX) {
+        fmt_putc(out, '0');
+        fmt_putc(out, (flags & FMT_UPPER) ? 'X' : 'x');
+    }
+    fmt_pad(out, '0', zeros);
+    while (n > 0) {
+        fmt_putc(out, tmp[--n]);
+    }
+    if (flags & FMT_LEFT) {
+        fmt_pad(out, ' ', pad);
     }
 }
 
 /**
- * @brief Форматированный вывод с фиксированным цветом (GREEN_ON_BLACK)
- * @param format Строка формата со спецификаторами:
- *              - %s: строка (char*)
- *              - %d: десятичное число (u32)
- *              - %x: шестнадцатеричное число (u32)
- *              - %%: символ '%'
- * @param ... Аргументы для подстановки
+ * @brief Форматирует строку в буфер
+ * @param[out] buf Буфер результата
+ * @param[in] size Размер буфера (включая нулевой терминатор)
+ * @param[in] format Строка формата: %[флаги][ширина][.точность][длина]тип
+ *              - флаги: '-' (влево), '0' (нулями)
+ *              - ширина и точность: число или '*' (из аргументов)
+ *              - длина: 'l' (long, 32 бита), 'll' (64 бита)
+ *              - тип: d i u x X c s p %
+ * @param[in] args Аргументы для подстановки
+ * @return Длина полного результата без терминатора (может быть больше size)
  *
- * @note Особенности:
- * - Использует статический буфер размером 32 символа для чисел
- * - Не поддерживает выравнивание и форматирование чисел
- * - Цвет фиксирован: зеленый текст на черном фоне
+ * @note Единственный форматтер ядра: printf(), colored_print() и
+ *       snprintf() - обертки над ним. Результат всегда нуль-терминирован
+ *       при size > 0.
  */
-void printf(const char *format, ...) {
-    va_list args;
-    va_start(args, format);
+s32 vsnprintf(char *buf, const u32 size, const char *format, va_list args) {
+    fmt_out_t out = {buf, size, 0};
 
     while (*format) {
-        if (*format == '%') {
+        if (*format != '%') {
+            fmt_putc(&out, *format++);
+            continue;
+        }
+        format++;
+
+        u8 flags = 0;
+        while (*format == '-' || *format == '0') {
+            flags |= (*format == '-') ? FMT_LEFT : FMT_ZERO;
+            format++;
+        }
+
+        s32 width = 0;
+        if (*format == '*') {
+            width = va_arg(args, s32);
+            if (width < 0) {
+                flags |= FMT_LEFT;
+                width = -width;
+            }
             format++;
-            switch (*format) {
-                case 's': { // Обработка строк
-                    char *str = va_arg(args, char*);
-                    while (*str) {
-                        putchar(*str++, GREEN_ON_BLACK);
-                    }
-                    break;
+        } else {
+            while (*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        s32 precision = -1;
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                precision = va_arg(args, s32);
+                if (precision < 0) {
+                    precision = -1; // Как в C: точность не задана
                 }
-                case 'd': { // Обработка десятичных чисел
-                    u32 num = va_arg(args, u32);
-                    char buf[32];
-                    itoa(num, buf, 10);
-                    char *p = buf;
-                    while (*p) {
-                        putchar(*p++, GREEN_ON_BLACK);
-                    }
-                    break;
+                format++;
+            } else {
+                while (*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
                 }
-                case 'x': { // Обработка шестнадцатеричных чисел
-                    u32 num = va_arg(args, u32);
-                    char buf[32];
-                    itoa(num, buf, 16);
-                    char *p = buf;
-                    while (*p) {
-                        putchar(*p++, GREEN_ON_BLACK);
-                    }
-                    break;
+            }
+        }
+
+        u8 longs = 0;
+        while (*format == 'l') {
+            longs++;
+            format++;
+        }
+
+        switch (*format) {
+            case 'd':
+            case 'i': {
+                const s64 num = longs >= 2 ? va_arg(args, s64) : va_arg(args, s32);
+                fmt_number(&out, num < 0 ? -(u64) num : (u64) num, num < 0, 10,
+                           width, precision, flags);
+                break;
+            }
+            case 'u': {
+                const u64 num = longs >= 2 ? va_arg(args, u64) : va_arg(args, u32);
+                fmt_number(&out, num, 0, 10, width, precision, flags);
+                break;
+            }
+            case 'X':
+                flags |= FMT_UPPER;
+                // fallthrough
+            case 'x': {
+                const u64 num = longs >= 2 ? va_arg(args, u64) : va_arg(args, u32);
+                fmt_number(&out, num, 0, 16, width, precision, flags);
+                break;
+            }
+            case 'p': {
+                const u32 ptr = (u32) va_arg(args, void *);
+                fmt_number(&out, ptr, 0, 16, width, 8, flags | FMT_PREFIX);
+                break;
+            }
+            case 'c': {
+                const char c = (char) va_arg(args, s32);
+                if (!(flags & FMT_LEFT)) {
+                    fmt_pad(&out, ' ', width - 1);
                 }
-                case '%': { // Вывод символа '%'
-                    putchar('%', GREEN_ON_BLACK);
-                    break;
+                fmt_putc(&out, c);
+                if (flags & FMT_LEFT) {
+                    fmt_pad(&out, ' ', width - 1);
                 }
+                break;
             }
-        } else {
-            putchar(*format, GREEN_ON_BLACK);
+            case 's': {
+                const char *str = va_arg(args, const char *);
+                if (str == 0) {
+                    str = "(null)";
+                }
+                s32 len = 0;
+                while (str[len] && (precision < 0 || len < precision)) {
+                    len++;
+                }
+                if (!(flags & FMT_LEFT)) {
+                    fmt_pad(&out, ' ', width - len);
+                }
+                s32 i = 0;
+                while (i < len) {
+                    fmt_putc(&out, str[i++]);
+                }
+                if (flags & FMT_LEFT) {
+                    fmt_pad(&out, ' ', width - len);
+                }
+                break;
+            }
+            case '%':
+                fmt_putc(&out, '%');
+                break;
+            case '\0':
+                // Строка формата оборвалась на '%'
+                format--;
+                break;
+            default:
+                // Неизвестный спецификатор выводится как есть
+                fmt_putc(&out, '%');
+                fmt_putc(&out, *format);
+                break;
         }
         format++;
     }
 
+    if (size > 0) {
+        buf[out.len < size ? out.len : size - 1] = '\0';
+    }
+    return out.len;
+}
+
+/**
+ * @brief Форматирует строку в буфер
+ * @see vsnprintf() Для описания формата
+ */
+s32 snprintf(char *buf, const u32 size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    const s32 len = vsnprintf(buf, size, format, args);
+    va_end(args);
+    return len;
+}
+
+/**
+ * @brief Форматирует строку и выводит ее на экран одной операцией
+ * @param[in] color Атрибут цвета
+ * @param[in] format Строка формата
+ * @param[in] args Аргументы
+ *
+ * @note Результат длиннее PRINT_BUFFER_SIZE - 1 обрезается
+ */
+static void vprint(const u8 color, const char *format, va_list args) {
+    char buf[PRINT_BUFFER_SIZE];
+    s32 len = vsnprintf(buf, sizeof(buf), format, args);
+
+    if (len > (s32) sizeof(buf) - 1) {
+        len = sizeof(buf) - 1;
+    }
+    screen_write(buf, len, color);
+    serial_write(buf, len);
+}
+
+/**
+ * @brief Форматированный вывод с фиксированным цветом (GREEN_ON_BLACK)
+ * @param format Строка формата (см. vsnprintf())
+ * @param ... Аргументы для подстановки
+ *
+ * @note Строка собирается в буфере на стеке и попадает на экран
+ *       одним screen_write(), а ее копия - в очередь COM1 (serial_write())
+ */
+void printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprint(GREEN_ON_BLACK, format, args);
     va_end(args);
 }
 
@@ -136,50 +315,8 @@ void printf(const char *format, ...) {
 void colored_print(u8 color, const char *format, ...) {
     va_list args;
     va_start(args, format);
-
-    while (*format) {
-        if (*format == '%') {
-            format++;
-            switch (*format) {
-                case 's': {
-                    char *str = va_arg(args, char*);
-                    while (*str) {
-                        putchar(*str++, color);
-                    }
-                    break;
-                }
-                case 'd': {
-                    u32 num = va_arg(args, u32);
-                    char buf[32];
-                    itoa(num, buf, 10);
-                    char *p = buf;
-                    while (*p) {
-                        putchar(*p++, color);
-                    }
-                    break;
-                }
-                case 'x': {
-                    u32 num = va_arg(args, u32);
-                    char buf[32];
-                    itoa(num, buf, 16);
-                    char *p = buf;
-                    while (*p) {
-                        putchar(*p++, color);
-                    }
-                    break;
-                }
-                case '%': {
-                    putchar('%', color);
-                    break;
-                }
-            }
-        } else {
-            putchar(*format, color);
-        }
-        format++;
-    }
-
+    vprint(color, format, args);
     va_end(args);
 }
 
-/** @} */ // Конец группы print
\ No newline at end of file
+/** @} */ // Конец группы print
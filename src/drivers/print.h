@@ -6,7 +6,12 @@
 #define PRINTF_H
 
 #include "../common.h"
+#include <stdarg.h>
 
+#define PRINT_BUFFER_SIZE 512 // Максимальная длина одного вызова printf()
+
+s32 vsnprintf(char *buf, u32 size, const char *format, va_list args);
+s32 snprintf(char *buf, u32 size, const char *format, ...);
 void printf(const char *format, ...);
 void colored_print(u8 color, const char *format, ...);
 
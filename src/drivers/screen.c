@@ -8,7 +8,251 @@
  */
 #include "screen.h"
 #include "../common.h"
+#include "../string.h"
 #include "asm_io.h"
+#include "../kernel/spinlock.h"
+#include "../kernel/trace.h"
+#include "../kernel/command.h"
+
+/**
+ * @brief Теневая копия текстового экрана
+ * @details Каждая ячейка - 16 бит: младший байт символ, старший атрибут,
+ * как в видеопамяти. Вся запись идет сюда, а в VGA попадают только
+ * строки, помеченные в dirty_rows, при вызове screen_flush().
+ * Строки хранятся по кругу: строка экрана 0 лежит в shadow_top,
+ * поэтому прокрутка не двигает данные (см. shadow_row()).
+ */
+static u16 shadow[MAX_ROWS * MAX_COLS];
+
+/**
+ * @brief Блокировка экрана для вывода с нескольких процессоров
+ * @details Берется целыми блоками (screen_write(), clear_screen()), а не
+ * на каждый символ: строки разных процессоров не перемешиваются.
+ */
+static spinlock_t screen_lock = SPINLOCK_INIT;
+
+/**
+ * @brief Индекс строки теневого буфера, соответствующей верху экрана
+ */
+static u32 shadow_top = 0;
+
+/**
+ * @brief Битовая маска измененных строк (бит N - строка N)
+ */
+static u32 dirty_rows = 0;
+
+/**
+ * @brief Кэшированная позиция курсора (в байтах, как в get_cursor())
+ */
+static u16 cursor = 0;
+
+/**
+ * @brief Последняя позиция, записанная в регистры курсора CRTC
+ */
+static u16 hw_cursor = 0;
+
+/**
+ * @brief Строка видеопамяти, с которой начинается экран
+ * @details Прокрутка сдвигает это окно по 32 KB текстовой памяти
+ * через регистр начального адреса CRTC, а не копирует строки.
+ */
+static u32 origin = 0;
+
+/**
+ * @brief Значение origin, записанное в регистры CRTC 0x0C/0x0D
+ */
+static u32 hw_origin = 0;
+
+/**
+ * @brief История строк, ушедших за верхний край экрана
+ * @details Кольцевой буфер: sb_head - следующий слот записи,
+ * sb_count - число сохраненных строк (не больше SCROLLBACK_LINES).
+ */
+static u16 scrollback[SCROLLBACK_LINES][MAX_COLS];
+static u32 sb_head = 0;
+static u32 sb_count = 0;
+
+/**
+ * @brief На сколько строк назад прокручен просмотр истории (0 - живой экран)
+ */
+static u32 sb_view = 0;
+
+/**
+ * @brief Количество операций с портами VGA (для оценки стоимости вывода)
+ */
+u32 screen_port_io = 0;
+
+/**
+ * @brief Возвращает строку теневого буфера по номеру строки экрана
+ * @param[in] row Номер строки экрана (0..MAX_ROWS-1)
+ */
+static u16 *shadow_row(const u32 row) {
+    u32 index = shadow_top + row;
+    if (index >= MAX_ROWS) {
+        index -= MAX_ROWS;
+    }
+    return shadow + index * MAX_COLS;
+}
+
+/**
+ * @brief Читает позицию курсора из регистров CRTC
+ * @return Смещение курсора в видеопамяти (в байтах)
+ *
+ * @note Алгоритм:
+ * 1. Запрос старшего байта через порт 0x3D4 (14)
+ * 2. Запрос младшего байта через порт 0x3D4 (15)
+ * 3. Преобразование в смещение: позиция * 2
+ */
+static u16 read_hw_cursor() {
+    port_byte_out(REG_SCREEN_CTRL, 14);
+    u8 high_byte = port_byte_in(REG_SCREEN_DATA);
+    port_byte_out(REG_SCREEN_CTRL, 15);
+    u8 low_byte = port_byte_in(REG_SCREEN_DATA);
+    screen_port_io += 4;
+    return (((high_byte << 8) + low_byte) * 2);
+}
+
+/**
+ * @brief Записывает позицию курсора в регистры CRTC
+ * @param[in] offset Смещение от начала экрана (в байтах)
+ *
+ * @note Регистры курсора адресуют всю видеопамять, поэтому
+ *       к позиции добавляется начало текущего окна origin
+ */
+static void write_hw_cursor(const u16 offset) {
+    const u16 position = origin * MAX_COLS + offset / 2;
+    hw_cursor = offset;
+
+    port_byte_out(REG_SCREEN_CTRL, 14);
+    port_byte_out(REG_SCREEN_DATA, (u8) (position >> 8));
+    port_byte_out(REG_SCREEN_CTRL, 15);
+    port_byte_out(REG_SCREEN_DATA, (u8) (position & 0xff));
+    screen_port_io += 4;
+}
+
+/**
+ * @brief Записывает начало окна в регистры начального адреса CRTC
+ *
+ * @note Регистры 0x0C/0x0D задают номер ячейки, с которой
+ *       контроллер начинает выводить экран
+ */
+static void write_hw_origin() {
+    const u16 start = origin * MAX_COLS;
+    hw_origin = origin;
+
+    port_byte_out(REG_SCREEN_CTRL, REG_START_ADDR_HIGH);
+    port_byte_out(REG_SCREEN_DATA, (u8) (start >> 8));
+    port_byte_out(REG_SCREEN_CTRL, REG_START_ADDR_LOW);
+    port_byte_out(REG_SCREEN_DATA, (u8) (start & 0xff));
+    screen_port_io += 4;
+}
+
+/**
+ * @brief Копирует строку экрана в видеопамять текущего окна
+ * @param[in] row Номер строки экрана
+ * @param[in] src 80 ячеек для вывода
+ */
+static void vga_put_row(const u32 row, const u16 *src) {
+    u16 *vga = (u16 *) VIDEO_ADDRESS;
+    memcpy(vga + (origin + row) * MAX_COLS, src, MAX_COLS * 2);
+}
+
+/**
+ * @brief Инициализирует консоль
+ *
+ * @note Один раз читает курсор из CRTC и копирует видеопамять
+ *       в теневой буфер, чтобы не потерять сообщения загрузчика.
+ *       Окно вывода ставится в начало видеопамяти.
+ *       Дальше позиция курсора живет только в памяти.
+ */
+void screen_init() {
+    memcpy(shadow, (const void *) VIDEO_ADDRESS, sizeof(shadow));
+    shadow_top = 0;
+    cursor = read_hw_cursor();
+    hw_cursor = cursor;
+    dirty_rows = 0;
+
+    origin = 0;
+    write_hw_origin();
+
+    sb_head = 0;
+    sb_count = 0;
+    sb_view = 0;
+}
+
+/**
+ * @brief Переносит изменения из теневого буфера на экран
+ *
+ * @note Копирует в видеопамять только измененные строки и обновляет
+ *       регистры начала окна и курсора, только если они сдвинулись.
+ *       Вызывается в конце printf()/colored_print(), на переводе строки
+ *       и при эхо ввода. Если в этот момент открыта история,
+ *       просмотр возвращается к живому экрану.
+ */
+void screen_flush() {
+    u32 row = 0;
+
+    if (sb_view != 0) {
+        sb_view = 0;
+        dirty_rows = (1u << MAX_ROWS) - 1;
+    }
+
+    while (dirty_rows >> row) {
+        if (dirty_rows & (1u << row)) {
+            vga_put_row(row, shadow_row(row));
+        }
+        row++;
+    }
+    dirty_rows = 0;
+
+    if (origin != hw_origin) {
+        write_hw_origin();
+        hw_cursor = (u16) -1; // Курсор адресуется от начала видеопамяти
+    }
+
+    if (cursor != hw_cursor) {
+        write_hw_cursor(cursor);
+    }
+}
+
+/**
+ * @brief Прокручивает просмотр истории
+ * @param[in] lines Количество строк: >0 - назад в историю, <0 - вперед
+ *
+ * @note Вызывается из getchar() по Shift+PgUp/Shift+PgDn.
+ *       Окно собирается из строк истории и верхней части экрана
+ *       и пишется прямо в видеопамять; теневой буфер не меняется.
+ */
+void screen_scrollback(const s32 lines) {
+    const u32 flags = spin_lock_irqsave(&screen_lock);
+    s32 view = (s32) sb_view + lines;
+
+    if (view < 0) {
+        view = 0;
+    }
+    if (view > (s32) sb_count) {
+        view = sb_count;
+    }
+
+    if (view == 0) {
+        if (sb_view != 0) {
+            screen_flush();
+        }
+    } else if ((u32) view != sb_view) {
+        sb_view = view;
+        s32 row = 0;
+        while (row < MAX_ROWS) {
+            const s32 line = row - view; // <0 - строка из истории
+            if (line >= 0) {
+                vga_put_row(row, shadow_row(line));
+            } else {
+                vga_put_row(row, scrollback[(sb_head + SCROLLBACK_LINES + line) % SCROLLBACK_LINES]);
+            }
+            row++;
+        }
+    }
+    spin_unlock_irqrestore(&screen_lock, flags);
+}
 
 /**
  * @brief Выводит строку в текущую позицию курсора
@@ -18,6 +262,7 @@
  * - Использует цвет GREEN_ON_BLACK по умолчанию
  * - Обрабатывает управляющие символы \n и \b
  * - Не поддерживает Escape-последовательности
+ * - Сбрасывает изменения на экран по окончании
  *
  * @warning Не проверяет валидность указателя str
  */
@@ -26,6 +271,28 @@ void kprint(u8 *str) {
         putchar(*str, GREEN_ON_BLACK);
         str++;
     }
+    screen_flush();
+}
+
+/**
+ * @brief Выводит готовый блок текста одним цветом
+ * @param[in] str Текст (нулевой терминатор не требуется)
+ * @param[in] len Длина текста в байтах
+ * @param[in] color Атрибут цвета
+ *
+ * @note Весь блок пишется в теневой буфер, на экран он попадает
+ *       одним screen_flush() в конце (и на переводах строк). Блок
+ *       выводится под screen_lock при запрещенных прерываниях, чтобы ни
+ *       планировщик, ни другой процессор не вклинили в середину строки
+ *       свой вывод
+ */
+void screen_write(const char *str, u32 len, const u8 color) {
+    const u32 flags = spin_lock_irqsave(&screen_lock);
+    while (len--) {
+        putchar(*str++, color);
+    }
+    screen_flush();
+    spin_unlock_irqrestore(&screen_lock, flags);
 }
 
 /**
@@ -35,29 +302,32 @@ void kprint(u8 *str) {
  *
  * @note Логика работы:
  * - \n - переход на новую строку со скроллингом при необходимости
+ *   и сброс изменений на экран
  * - \b - перемещение курсора назад с удалением символа
  * - При достижении конца экрана инициирует скроллинг
- * - Прямая запись в видеопамять (0xB8000)
+ * - Пишет только в теневой буфер, портов не касается
  *
  */
 void putchar(u8 symbol, u8 color) {
-    const u16 offset = get_cursor();
+    const u16 offset = cursor;
+
+    TRACE_EVENT2(TRACE_PUTCHAR, symbol, offset);
 
     if (symbol == '\n') {
         if (offset / 2 / MAX_COLS == MAX_ROWS - 1) {
             scroll_line();
         } else {
-            set_cursor(offset - offset % (MAX_COLS * 2) + MAX_COLS * 2);
+            cursor = offset - offset % (MAX_COLS * 2) + MAX_COLS * 2;
         }
+        screen_flush();
         return;
     }
 
     if (symbol == '\b') {
         // Обработка Backspace
         if (offset >= 2) {
-            set_cursor(offset - 2);
             write(' ', color, offset - 2);
-            set_cursor(offset - 2);
+            cursor = offset - 2;
         }
         return;
     }
@@ -67,111 +337,110 @@ void putchar(u8 symbol, u8 color) {
         scroll_line();
     }
 
-    write(symbol, color, offset);
-    set_cursor(offset + 2);
+    write(symbol, color, cursor);
+    cursor += 2;
 }
 
 /**
  * @brief Прокручивает экран на одну строку вверх
  *
- * @note Алгоритм:
- * 1. Копирует строки 1..MAX_ROWS-1 в 0..MAX_ROWS-2
- * 2. Очищает последнюю строку
- * 3. Устанавливает курсор в начало последней строки
- *
- * @warning Использует memcpy для копирования данных
- * @warning Может быть медленной при частом вызове
+ * @note Алгоритм (O(1) на строку):
+ * 1. Сохраняет верхнюю строку в историю
+ * 2. Очищает ее и делает новой нижней строкой (сдвиг shadow_top)
+ * 3. Сдвигает окно видеопамяти на строку вниз; строки, уже лежащие
+ *    в видеопамяти, не копируются
+ * 4. Когда окно упирается в конец 32 KB, оно возвращается в начало
+ *    и экран перерисовывается целиком (раз в VGA_TEXT_ROWS - MAX_ROWS строк)
+ * 5. Устанавливает курсор в начало последней строки
  */
 void scroll_line() {
-    u8 i = 1;
-
-    while (i < MAX_ROWS) {
-        memcpy(
-            (u8 *) (VIDEO_ADDRESS + MAX_COLS * i * 2),
-            (u8 *) (VIDEO_ADDRESS + MAX_COLS * (i - 1) * 2),
-            MAX_COLS * 2
-        );
-        i++;
+    u16 *top = shadow_row(0);
+
+    TRACE_EVENT1(TRACE_SCROLL_BEGIN, origin);
+    memcpy(scrollback[sb_head], top, MAX_COLS * 2);
+    sb_head = (sb_head + 1) % SCROLLBACK_LINES;
+    if (sb_count < SCROLLBACK_LINES) {
+        sb_count++;
     }
 
-    const u16 last_line = MAX_COLS * MAX_ROWS * 2 - MAX_COLS * 2;
-    i = 0;
-    while (i < MAX_COLS) {
-        write('\0', GREEN_ON_BLACK, last_line + i * 2);
-        i++;
+    memsetw(top, BLANK_CELL, MAX_COLS);
+    shadow_top = (shadow_top + 1) % MAX_ROWS;
+
+    if (origin + MAX_ROWS < VGA_TEXT_ROWS) {
+        // Несброшенные изменения сдвигаются вместе со строками
+        origin++;
+        dirty_rows = (dirty_rows >> 1) | (1u << (MAX_ROWS - 1));
+    } else {
+        origin = 0;
+        dirty_rows = (1u << MAX_ROWS) - 1;
     }
-    set_cursor(last_line);
+    cursor = MAX_COLS * MAX_ROWS * 2 - MAX_COLS * 2;
+    TRACE_EVENT1(TRACE_SCROLL_END, origin);
 }
 
 /**
  * @brief Полностью очищает экран
  *
- * @note Заполняет всю видеопамять:
+ * @note Заполняет теневой буфер одним memsetw():
  * - Символы: 0x00
  * - Цвет: GREEN_ON_BLACK
  * - Сбрасывает позицию курсора в начало
- *
- * @see write() Для реализации записи в видеопамять
+ * - Сразу переносит результат на экран
  */
 void clear_screen() {
-    u16 offset = 0;
+    const u32 flags = spin_lock_irqsave(&screen_lock);
+    memsetw(shadow, BLANK_CELL, MAX_ROWS * MAX_COLS);
+    shadow_top = 0;
 
-    while (offset < MAX_ROWS * MAX_COLS * 2) {
-        write('\0', GREEN_ON_BLACK, offset);
-        offset += 2;
-    }
-
-    set_cursor(0);
+    dirty_rows = (1u << MAX_ROWS) - 1;
+    cursor = 0;
+    screen_flush();
+    spin_unlock_irqrestore(&screen_lock, flags);
 }
 
 /**
- * @brief Записывает символ в видеопамять
+ * @brief Записывает символ в теневой буфер экрана
  * @param[in] symbol ASCII-код символа
  * @param[in] color  Атрибут цвета
  * @param[in] offset Смещение в видеопамяти (в байтах)
  *
  * @warning Не проверяет корректность offset
  * @note Каждая позиция на экране занимает 2 байта:
- * [0] - символ, [1] - атрибуты
+ * [0] - символ, [1] - атрибуты. На экране символ появится
+ * после screen_flush().
  */
 void write(const u8 symbol, const u8 color, const u16 offset) {
-    u8 *vga = (u8 *) VIDEO_ADDRESS;
-    vga[offset] = symbol;
-    vga[offset + 1] = color;
+    const u32 row = offset / 2 / MAX_COLS;
+    shadow_row(row)[offset / 2 % MAX_COLS] = VGA_CELL(symbol, color);
+    dirty_rows |= 1u << row;
 }
 
 /**
  * @brief Получает текущую позицию курсора
  * @return Текущее смещение курсора в видеопамяти (в байтах)
  *
- * @note Алгоритм:
- * 1. Запрос старшего байта через порт 0x3D4 (14)
- * 2. Запрос младшего байта через порт 0x3D4 (15)
- * 3. Преобразование в смещение: позиция * 2
- *
- * @see port_byte_out() @see port_byte_in()
+ * @note Возвращает кэшированное значение, к портам не обращается
  */
 u16 get_cursor() {
-    port_byte_out(REG_SCREEN_CTRL, 14);
-    u8 high_byte = port_byte_in(REG_SCREEN_DATA);
-    port_byte_out(REG_SCREEN_CTRL, 15);
-    u8 low_byte = port_byte_in(REG_SCREEN_DATA);
-    return (((high_byte << 8) + low_byte) * 2);
+    return cursor;
 }
 
 /**
  * @brief Устанавливает новую позицию курсора
  * @param[in] offset Смещение в видеопамяти (в байтах)
  *
+ * @note Регистры CRTC обновятся при ближайшем screen_flush()
  * @warning Не проверяет валидность offset
  */
-void set_cursor(u16 offset) {
-    offset /= 2;
+void set_cursor(const u16 offset) {
+    cursor = offset;
+}
 
-    port_byte_out(REG_SCREEN_CTRL, 14);
-    port_byte_out(REG_SCREEN_DATA, (u8) (offset >> 8));
-    port_byte_out(REG_SCREEN_CTRL, 15);
-    port_byte_out(REG_SCREEN_DATA, (u8) (offset & 0xff));
+static s32 cmd_clear(u32 argc, char **argv) {
+    clear_screen();
+    return 0;
 }
 
-/** @} */ // Конец группы screen
\ No newline at end of file
+COMMAND("clear", cmd_clear, "", "Clear screen");
+
+/** @} */ // Конец группы screen
@@ -6,17 +6,31 @@
 #define SCREEN_H
 
 #include "../common.h"
+#include "../mm/paging.h"
 
-#define VIDEO_ADDRESS 0xb8000
+#define VIDEO_ADDRESS (KERNEL_VIRT_BASE + 0xb8000) // Видеопамять в прямом отображении
 #define MAX_ROWS 25
 #define MAX_COLS 80
 
+#define VGA_TEXT_ROWS (0x8000 / (MAX_COLS * 2)) // Строк в 32 KB текстовой памяти
+#define SCROLLBACK_LINES 512                    // Глубина истории прокрутки
+
 #define GREEN_ON_BLACK 0x02
 
+#define VGA_CELL(symbol, color) ((u16) (((color) << 8) | (u8) (symbol)))
+#define BLANK_CELL VGA_CELL('\0', GREEN_ON_BLACK)
+
 #define REG_SCREEN_CTRL 0x3d4
 #define REG_SCREEN_DATA 0x3d5
 
+#define REG_START_ADDR_HIGH 0x0c // Регистры CRTC начального адреса экрана
+#define REG_START_ADDR_LOW  0x0d
+
+void screen_init();
+void screen_flush();
+void screen_scrollback(s32 lines);
 void kprint(u8 *str);
+void screen_write(const char *str, u32 len, u8 color);
 void putchar(u8 symbol, u8 color);
 void scroll_line();
 void clear_screen();
@@ -0,0 +1,211 @@
+/**
+* @file serial.c
+ * @brief Консоль на COM1 (UART 16550) с передачей по прерыванию
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup serial Последовательный порт
+ * @{
+ */
+
+#include "serial.h"
+#include "asm_io.h"
+#include "keyboard.h"
+#include "../kernel/spinlock.h"
+#include "../cpu/isr.h"
+#include "../cpu/pic.h"
+
+/**
+ * @brief Кольцевой буфер передачи
+ * @details Писатели - serial_write() в любом потоке на любом процессоре,
+ * читатель - обработчик IRQ4. Все обращения выполняются под tx_lock при
+ * запрещенных прерываниях, поэтому индексы можно менять без атомарных
+ * операций.
+ */
+static char tx_buffer[SERIAL_TX_SIZE];
+static u32 tx_head = 0;     ///< Следующая позиция записи
+static u32 tx_tail = 0;     ///< Следующий байт для UART
+static u8 ier = 0;          ///< Теневая копия IER
+static u8 present = 0;
+static serial_stats_t stats;
+static spinlock_t tx_lock = SPINLOCK_INIT;
+
+static inline u8 uart_in(const u8 reg) {
+    return port_byte_in(COM1_PORT + reg);
+}
+
+static inline void uart_out(const u8 reg, const u8 value) {
+    port_byte_out(COM1_PORT + reg, value);
+}
+
+/**
+ * @brief Загружает в FIFO передатчика до 16 байт из буфера
+ * @return Сколько байт загружено
+ * @note Вызывать, когда LSR.THRE = 1 (FIFO пуст), при запрещенных прерываниях.
+ *       Прерывание THRE разрешено, только пока в буфере есть данные:
+ *       иначе оно срабатывало бы впустую после каждого опустошения FIFO
+ */
+static u32 tx_fill() {
+    u32 n = 0;
+
+    while (tx_tail != tx_head && n < UART_FIFO_SIZE) {
+        uart_out(UART_DATA, tx_buffer[tx_tail]);
+        tx_tail = (tx_tail + 1) & (SERIAL_TX_SIZE - 1);
+        n++;
+    }
+    stats.tx_bytes += n;
+
+    const u8 want = tx_tail != tx_head ? (ier | UART_IER_THRE) : (ier & ~UART_IER_THRE);
+    if (want != ier) {
+        ier = want;
+        uart_out(UART_IER, ier);
+    }
+    return n;
+}
+
+/**
+ * @brief Кладет байт в буфер передачи
+ * @note Если буфер полон, ждет опустошения FIFO и дозагружает его сам:
+ *       при запрещенных прерываниях IRQ4 буфер не освободит
+ */
+static void tx_put(const char c) {
+    const u32 next = (tx_head + 1) & (SERIAL_TX_SIZE - 1);
+
+    while (next == tx_tail) {
+        while (!(uart_in(UART_LSR) & UART_LSR_THRE)) {
+        }
+        stats.tx_polled += tx_fill();
+    }
+    tx_buffer[tx_head] = c;
+    tx_head = next;
+}
+
+/**
+ * @brief Обработчик IRQ4: прием символов и дозагрузка FIFO передатчика
+ */
+static void serial_callback(registers_t *regs) {
+    u8 iir;
+
+    // Бит 0 IIR = 1 - необработанных причин не осталось
+    while (!((iir = uart_in(UART_IIR)) & 0x01)) {
+        switch (iir & 0x0E) {
+            case 0x04: // Приняты данные
+            case 0x0C: // Таймаут FIFO приемника
+                while (uart_in(UART_LSR) & UART_LSR_DR) {
+                    char c = (char) uart_in(UART_DATA);
+                    stats.rx_bytes++;
+                    if (c == '\r') {
+                        c = '\n';   // Терминал шлет CR на Enter
+                    } else if (c == 0x7F) {
+                        c = '\b';   // и DEL на Backspace
+                    }
+                    keyboard_push_char(c);
+                }
+                break;
+            case 0x02: // Передатчик пуст
+                spin_lock(&tx_lock);
+                stats.tx_irqs++;
+                tx_fill();
+                spin_unlock(&tx_lock);
+                break;
+            case 0x06: // Ошибка линии
+                uart_in(UART_LSR);
+                break;
+            default:   // Состояние модема
+                uart_in(UART_MSR);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Инициализирует COM1: 115200 8N1, FIFO, прерывания приема
+ *
+ * @note Наличие порта проверяется через регистр SCR; если порта нет,
+ *       serial_write() молча ничего не делает
+ */
+void serial_init() {
+    uart_out(UART_SCR, 0x5A);
+    if (uart_in(UART_SCR) != 0x5A) {
+        return;
+    }
+
+    uart_out(UART_IER, 0);
+    uart_out(UART_LCR, 0x80);                          // DLAB = 1
+    uart_out(UART_DATA, (UART_BASE_BAUD / SERIAL_BAUD) & 0xFF);
+    uart_out(UART_IER, (UART_BASE_BAUD / SERIAL_BAUD) >> 8);
+    uart_out(UART_LCR, 0x03);                          // 8N1, DLAB = 0
+    uart_out(UART_FCR, 0xC7);                          // FIFO вкл, сброс, порог приема 14 байт
+    uart_out(UART_MCR, 0x0B);                          // DTR, RTS, OUT2 (пропускает IRQ)
+
+    present = 1;
+    register_interrupt_handler(IRQ0 + COM1_IRQ, serial_callback);
+    ier = UART_IER_RDA;
+    uart_out(UART_IER, ier);
+    pic_unmask(COM1_IRQ);
+}
+
+/**
+ * @brief Ставит текст в очередь на передачу
+ * @param[in] str Текст ('\n' передается как "\r\n")
+ * @param[in] len Длина в байтах
+ *
+ * @note Не ждет UART: байты уходят из буфера по прерыванию THRE.
+ *       Опрос LSR нужен, только если буфер переполнен (см. tx_put())
+ */
+void serial_write(const char *str, u32 len) {
+    if (!present) {
+        return;
+    }
+
+    const u32 flags = spin_lock_irqsave(&tx_lock);
+    while (len--) {
+        const char c = *str++;
+        if (c == '\n') {
+            tx_put('\r');
+        }
+        tx_put(c);
+    }
+
+    // Передатчик простаивает - запускаем его сами, дальше работает IRQ4
+    if (!(ier & UART_IER_THRE) && (uart_in(UART_LSR) & UART_LSR_THRE)) {
+        tx_fill();
+    }
+    spin_unlock_irqrestore(&tx_lock, flags);
+}
+
+/**
+ * @brief Дожидается передачи всего буфера
+ * @note Опрашивает LSR, поэтому работает и при запрещенных прерываниях
+ *       (например, перед выключением машины)
+ */
+void serial_flush() {
+    if (!present) {
+        return;
+    }
+
+    const u32 flags = spin_lock_irqsave(&tx_lock);
+    while (tx_tail != tx_head) {
+        while (!(uart_in(UART_LSR) & UART_LSR_THRE)) {
+        }
+        stats.tx_polled += tx_fill();
+    }
+    spin_unlock_irqrestore(&tx_lock, flags);
+}
+
+/**
+ * @brief Найден ли COM1 при инициализации
+ */
+u8 serial_present() {
+    return present;
+}
+
+/**
+ * @brief Копия счетчиков порта
+ */
+void serial_get_stats(serial_stats_t *out) {
+    const u32 flags = irq_save();
+    *out = stats;
+    irq_restore(flags);
+}
+
+/** @} */ // Конец группы serial
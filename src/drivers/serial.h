@@ -0,0 +1,51 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include "../common.h"
+
+#define COM1_PORT 0x3F8
+#define COM1_IRQ  4
+
+// Регистры 16550 (смещения от базового порта)
+#define UART_DATA 0     // RBR/THR, при DLAB=1 - младший байт делителя
+#define UART_IER  1     // Разрешение прерываний, при DLAB=1 - старший байт делителя
+#define UART_IIR  2     // Идентификация прерывания (чтение)
+#define UART_FCR  2     // Управление FIFO (запись)
+#define UART_LCR  3
+#define UART_MCR  4
+#define UART_LSR  5
+#define UART_MSR  6
+#define UART_SCR  7
+
+#define UART_IER_RDA  0x01  // Приняты данные
+#define UART_IER_THRE 0x02  // Передатчик пуст
+#define UART_LSR_DR   0x01
+#define UART_LSR_THRE 0x20
+
+#define UART_FIFO_SIZE 16
+#define UART_BASE_BAUD 115200 // Частота делителя: 1.8432 MHz / 16
+#define SERIAL_BAUD    115200
+#define SERIAL_TX_SIZE 4096 // Кольцевой буфер передачи (степень двойки)
+
+void serial_init();
+void serial_write(const char *str, u32 len);
+void serial_flush();
+u8 serial_present();
+
+/**
+ * @brief Статистика порта
+ */
+typedef struct {
+    u32 tx_bytes;       // Передано в порт
+    u32 tx_irqs;        // Прерываний THRE
+    u32 tx_polled;      // Байт, отправленных опросом при полном буфере
+    u32 rx_bytes;
+} serial_stats_t;
+
+void serial_get_stats(serial_stats_t *stats);
+
+#endif //SERIAL_H
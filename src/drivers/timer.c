@@ -0,0 +1,369 @@
+/**
+* @file timer.c
+ * @brief Системный таймер: часы на TSC, прерывания от APIC по требованию
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup timer Системный таймер
+ * @{
+ */
+
+#include "timer.h"
+#include "asm_io.h"
+#include "print.h"
+#include "../cpu/pic.h"
+#include "../cpu/tsc.h"
+#include "../cpu/cpuid.h"
+#include "../cpu/lapic.h"
+#include "../kernel/command.h"
+
+/**
+ * @brief Источник прерываний таймера
+ * @details До timer_tickless_init() и без APIC/TSC - периодический тик PIT.
+ * В остальных режимах прерывание приходит только к ближайшему сроку,
+ * заказанному через timer_program().
+ */
+typedef enum {
+    TIMER_MODE_PIT,         ///< IRQ0 с частотой hz
+    TIMER_MODE_ONESHOT,     ///< Однократный счетчик APIC
+    TIMER_MODE_DEADLINE     ///< APIC в режиме TSC-deadline
+} timer_mode_t;
+
+static const char *mode_names[] = {"pit periodic", "lapic one-shot", "lapic tsc-deadline"};
+
+static volatile u64 ticks = 0;  ///< Прерываний таймера с timer_init()
+static u32 hz = TIMER_HZ;
+static u32 ns_per_tick;         ///< Запасной источник времени без TSC
+
+static timer_mode_t mode = TIMER_MODE_PIT;
+static u64 next_event = ~0ull;  ///< Запрограммированный срок (ktime_ns), ~0 - нет
+static u32 lapic_timer_khz;     ///< Частота счетчика APIC (режим ONESHOT)
+static u32 reprograms = 0;      ///< Записей срока в APIC
+
+static isr_t hooks[TIMER_MAX_HOOKS];
+static u32 hook_count = 0;
+
+/**
+ * @brief Параметры перевода тактов в наносекунды
+ * @details ns = cycles * tsc_mult >> tsc_shift: одно умножение вместо
+ * 64-битного деления на каждом вызове ktime_ns()
+ */
+static u32 tsc_freq_khz = 0;
+static u32 tsc_mult;
+static u32 tsc_shift;
+static u64 tsc_base;            ///< Значение TSC в момент timer_init()
+
+/**
+ * @brief Обработчик IRQ0 или LAPIC_TIMER_VECTOR
+ * @note EOI уже отправлен isr_handler(), поэтому подписчик
+ *       (планировщик) может не возвращаться сразу. Срок сработал, и
+ *       таймер APIC стоит: каждый подписчик заново заказывает свой
+ *       ближайший срок через timer_program()
+ */
+static void timer_callback(registers_t *regs) {
+    u32 i;
+
+    ticks++;
+    next_event = ~0ull;
+    for (i = 0; i < hook_count; i++) {
+        hooks[i](regs);
+    }
+}
+
+/**
+ * @brief Один замер TSC по каналу 2 PIT
+ * @return Число тактов за TSC_CALIBRATE_MS миллисекунд
+ *
+ * Канал 2 в режиме 0 считает вниз от заданного значения и выставляет
+ * OUT2 (бит 5 порта 0x61), дойдя до нуля. Прерывания для этого не нужны.
+ */
+static u64 tsc_measure() {
+    const u32 latch = PIT_FREQUENCY * TSC_CALIBRATE_MS / 1000;
+
+    port_byte_out(PIT_GATE, (port_byte_in(PIT_GATE) & ~0x02) | 0x01); // GATE2 вкл, динамик выкл
+    port_byte_out(PIT_COMMAND, 0xB0);   // Канал 2, младший/старший байт, режим 0
+    port_byte_out(PIT_CHANNEL2, latch & 0xFF);
+    port_byte_out(PIT_CHANNEL2, latch >> 8);
+
+    const u64 start = rdtsc_ordered();
+    while (!(port_byte_in(PIT_GATE) & 0x20)) {
+    }
+    return rdtsc_ordered() - start;
+}
+
+/**
+ * @brief Калибрует TSC по PIT и вычисляет tsc_mult/tsc_shift
+ */
+static void tsc_calibrate() {
+    u64 best = ~0ull;
+    u32 i;
+
+    for (i = 0; i < TSC_CALIBRATE_RUNS; i++) {
+        const u64 cycles = tsc_measure();
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+
+    div64(&best, TSC_CALIBRATE_MS);
+    tsc_freq_khz = (u32) best;
+    if (tsc_freq_khz == 0) {
+        return;
+    }
+
+    // Наибольший сдвиг, при котором множитель помещается в 32 бита
+    for (tsc_shift = 32; tsc_shift > 0; tsc_shift--) {
+        u64 mult = 1000000ull << tsc_shift;
+        div64(&mult, tsc_freq_khz);
+        if ((mult >> 32) == 0) {
+            tsc_mult = (u32) mult;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Запускает системный таймер
+ * @param[in] frequency Частота тика, Гц (19..PIT_FREQUENCY)
+ *
+ * Сначала при запрещенных прерываниях калибруется TSC, затем канал 0
+ * PIT переводится в режим генератора частоты на IRQ0.
+ */
+void timer_init(const u32 frequency) {
+    u32 divisor = PIT_FREQUENCY / frequency;
+    u64 ns = NSEC_PER_SEC;
+
+    if (divisor == 0) {
+        divisor = 1;
+    } else if (divisor > 0xFFFF) {
+        divisor = 0xFFFF;
+    }
+    hz = PIT_FREQUENCY / divisor;
+    div64(&ns, hz);
+    ns_per_tick = (u32) ns;
+
+    if (cpuid_features_edx() & CPUID_FEAT_EDX_TSC) {
+        tsc_calibrate();
+    }
+
+    register_interrupt_handler(IRQ0, timer_callback);
+    port_byte_out(PIT_COMMAND, 0x34);   // Канал 0, младший/старший байт, режим 2
+    port_byte_out(PIT_CHANNEL0, divisor & 0xFF);
+    port_byte_out(PIT_CHANNEL0, divisor >> 8);
+
+    tsc_base = tsc_freq_khz ? rdtsc() : 0;
+    pic_unmask(0);
+}
+
+/**
+ * @brief Записывает срок в таймер APIC
+ * @param[in] deadline Момент по ktime_ns()
+ *
+ * @note Интервал ограничен сверху TIMER_MAX_DELTA_NS (счетчик APIC
+ *       32-битный): раннее прерывание просто заказывает срок заново
+ */
+static void clockevent_set(const u64 deadline) {
+    const u64 now = ktime_ns();
+    u64 delta = deadline > now ? deadline - now : 0;
+
+    if (delta < TIMER_MIN_DELTA_NS) {
+        delta = TIMER_MIN_DELTA_NS;
+    } else if (delta > TIMER_MAX_DELTA_NS) {
+        delta = TIMER_MAX_DELTA_NS;
+    }
+    reprograms++;
+
+    if (mode == TIMER_MODE_DEADLINE) {
+        u64 cycles = delta * tsc_freq_khz;
+        div64(&cycles, 1000000);
+        lapic_timer_deadline(rdtsc() + cycles);
+    } else {
+        u64 count = delta * lapic_timer_khz;
+        div64(&count, 1000000);
+        lapic_timer_start(count ? (u32) count : 1);
+    }
+}
+
+/**
+ * @brief Заказывает прерывание таймера не позже срока
+ * @param[in] deadline Момент по ktime_ns()
+ *
+ * @note Таймер хранит только ближайший срок: более поздний заказ
+ *       игнорируется, поэтому подписчики повторяют свои заказы в каждом
+ *       прерывании. В режиме PIT ничего не делает - тик и так периодический
+ */
+void timer_program(const u64 deadline) {
+    if (mode == TIMER_MODE_PIT) {
+        return;
+    }
+
+    const u32 flags = irq_save();
+    if (deadline < next_event) {
+        next_event = deadline;
+        clockevent_set(deadline);
+    }
+    irq_restore(flags);
+}
+
+/**
+ * @brief Переводит прерывания таймера с PIT на локальный APIC
+ *
+ * Если процессор умеет TSC-deadline, срок пишется прямо в значениях TSC,
+ * иначе используется однократный счетчик APIC, откалиброванный по TSC.
+ * IRQ0 маскируется: в простое прерываний нет вообще, пока никто не
+ * заказал срок. Остальные линии 8259 продолжают обслуживать устройства.
+ *
+ * @note Вызывать после smp_init() (отображен APIC). Без APIC или TSC, а
+ *       также при сборке с -DTIMER_LEGACY_PIT остается периодический тик
+ */
+void timer_tickless_init() {
+#ifndef TIMER_LEGACY_PIT
+    if (!lapic_present() || tsc_freq_khz == 0) {
+        return;
+    }
+
+    timer_mode_t new_mode = TIMER_MODE_DEADLINE;
+    if (cpuid_features_ecx() & CPUID_FEAT_ECX_TSC_DEADLINE) {
+        lapic_timer_mode(LVT_TIMER_DEADLINE);
+    } else {
+        lapic_timer_khz = lapic_timer_calibrate(TSC_CALIBRATE_MS);
+        if (lapic_timer_khz == 0) {
+            return;
+        }
+        lapic_timer_mode(LVT_TIMER_ONESHOT);
+        new_mode = TIMER_MODE_ONESHOT;
+    }
+
+    const u32 flags = irq_save();
+    register_interrupt_handler(LAPIC_TIMER_VECTOR, timer_callback);
+    pic_mask(0);
+    mode = new_mode;
+    // Подписчики заказывают сроки только в прерывании: первое - сразу
+    next_event = ~0ull;
+    timer_program(ktime_ns());
+    irq_restore(flags);
+#endif
+}
+
+/**
+ * @brief Подписывает функцию на прерывания таймера
+ * @param[in] hook Вызывается из обработчика прерывания таймера
+ * @return 0 или -1, если свободных слотов нет
+ *
+ * @note В режиме PIT подписчик вызывается на каждом тике, в режимах
+ *       APIC - только в прерываниях к заказанным срокам (чьим угодно)
+ */
+s32 timer_register_hook(const isr_t hook) {
+    if (hook_count == TIMER_MAX_HOOKS) {
+        return -1;
+    }
+    hooks[hook_count++] = hook;
+    return 0;
+}
+
+/**
+ * @brief Число прерываний таймера с его запуска
+ */
+u64 timer_interrupts() {
+    const u32 flags = irq_save(); // 64-битное чтение не атомарно
+    const u64 value = ticks;
+    irq_restore(flags);
+    return value;
+}
+
+/**
+ * @brief Частота тика PIT (после округления делителя), Гц
+ * @details Без тика - номинальная частота для профилировщика
+ */
+u32 timer_hz() {
+    return hz;
+}
+
+/**
+ * @brief Частота TSC в кГц, 0 - TSC не откалиброван
+ */
+u32 tsc_khz() {
+    return tsc_freq_khz;
+}
+
+/**
+ * @brief Активное ожидание
+ * @param[in] us Микросекунды
+ *
+ * @note Работает при запрещенных прерываниях. Без TSC отсчитывает запись
+ *       в порт 0x80, которая на шине ISA занимает около микросекунды
+ */
+void udelay(const u32 us) {
+    if (tsc_freq_khz == 0) {
+        u32 i;
+        for (i = 0; i < us; i++) {
+            port_byte_out(0x80, 0);
+        }
+        return;
+    }
+
+    u64 cycles = (u64) us * tsc_freq_khz;
+    div64(&cycles, 1000);
+    const u64 start = rdtsc();
+    while (rdtsc() - start < cycles) {
+        __asm__ volatile("pause");
+    }
+}
+
+/**
+ * @brief Переводит такты TSC в наносекунды
+ * @param[in] cycles Число тактов
+ * @return Наносекунды
+ */
+u64 cycles_to_ns(const u64 cycles) {
+    const u32 low = (u32) cycles;
+    const u32 high = (u32) (cycles >> 32);
+
+    return (((u64) low * tsc_mult) >> tsc_shift) + (((u64) high * tsc_mult) << (32 - tsc_shift));
+}
+
+/**
+ * @brief Монотонное время с запуска таймера, нс
+ * @details Основной источник - TSC (разрешение в доли наносекунды, чтение
+ * за десятки тактов). Без TSC время идет шагами по одному тику.
+ */
+u64 ktime_ns() {
+    if (tsc_freq_khz) {
+        return cycles_to_ns(rdtsc() - tsc_base);
+    }
+    return timer_interrupts() * ns_per_tick;
+}
+
+/**
+ * @brief Печатает время работы системы и параметры часов
+ */
+void timer_print_uptime() {
+    u64 seconds = ktime_ns();
+    const u32 ns = div64(&seconds, (u32) NSEC_PER_SEC);
+    u64 minutes = seconds;
+    const u32 sec = div64(&minutes, 60);
+    u64 hours = minutes;
+    const u32 min = div64(&hours, 60);
+
+    printf("up %llu:%02u:%02u.%03u\n", hours, min, sec, ns / 1000000);
+    if (tsc_freq_khz) {
+        printf("clocksource: tsc, %u.%03u MHz\n", tsc_freq_khz / 1000, tsc_freq_khz % 1000);
+    } else {
+        printf("clocksource: pit\n");
+    }
+    printf("clockevent: %s", mode_names[mode]);
+    if (mode == TIMER_MODE_PIT) {
+        printf(" at %u Hz", hz);
+    } else if (mode == TIMER_MODE_ONESHOT) {
+        printf(", counter %u.%03u MHz", lapic_timer_khz / 1000, lapic_timer_khz % 1000);
+    }
+    printf(", %llu interrupts, %u reprograms\n", timer_interrupts(), reprograms);
+}
+
+static s32 cmd_uptime(u32 argc, char **argv) {
+    timer_print_uptime();
+    return 0;
+}
+
+COMMAND("uptime", cmd_uptime, "", "Time since boot and clocksource");
+
+/** @} */ // Конец группы timer
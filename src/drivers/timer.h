@@ -0,0 +1,40 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "../common.h"
+#include "../cpu/isr.h"
+
+#define PIT_FREQUENCY 1193182   // Входная частота 8254, Гц
+#define PIT_CHANNEL0  0x40      // Канал 0: IRQ0
+#define PIT_CHANNEL2  0x42      // Канал 2: динамик, используется для калибровки
+#define PIT_COMMAND   0x43
+#define PIT_GATE      0x61      // Бит 0 - GATE2, бит 1 - динамик, бит 5 - OUT2
+
+#define TIMER_HZ 100            // Частота тика PIT (и номинальная без тика)
+#define TIMER_MAX_HOOKS 4       // Подписчики на прерывание (профилировщик, колесо, планировщик)
+
+#define TSC_CALIBRATE_MS 10     // Длительность одного замера TSC
+#define TSC_CALIBRATE_RUNS 3    // Берется минимум: SMI только удлиняют замер
+
+#define NSEC_PER_SEC 1000000000ull
+
+#define TIMER_MIN_DELTA_NS 2000                 // Ближе срок не программируется
+#define TIMER_MAX_DELTA_NS (10 * NSEC_PER_SEC)  // Дальше - промежуточное прерывание
+
+void timer_init(u32 hz);
+void timer_tickless_init();
+s32 timer_register_hook(isr_t hook);
+void timer_program(u64 deadline);
+u64 timer_interrupts();
+u32 timer_hz();
+u32 tsc_khz();
+void udelay(u32 us);
+u64 cycles_to_ns(u64 cycles);
+u64 ktime_ns();
+void timer_print_uptime();
+
+#endif //TIMER_H
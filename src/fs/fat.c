@@ -0,0 +1,605 @@
+/**
+* @file fat.c
+ * @brief Файловая система FAT12/FAT16 (только чтение)
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup fat FAT12/16
+ * @{
+ */
+
+#include "fat.h"
+#include "vfs.h"
+#include "../string.h"
+#include "../drivers/bcache.h"
+#include "../drivers/print.h"
+#include "../mm/slab.h"
+
+#define FAT_NO_ENTRY 0xFFFF     ///< Конец цепочки в корзине хеша
+
+/**
+ * @brief Участок файла из физически смежных секторов
+ */
+typedef struct {
+    u32 lba;
+    u32 sectors;
+} fat_extent_t;
+
+/**
+ * @brief Разобранный элемент каталога
+ */
+typedef struct {
+    char name[13];              ///< "NAME.EXT" или строчными по флагам NT
+    u8 attr;
+    u16 next;                   ///< Следующий элемент в корзине
+    u32 cluster;
+    u32 size;
+} fat_entry_t;
+
+/**
+ * @brief Каталог с хеш-таблицей имен
+ * @details Строится при первом обращении и живет в кэше FAT_DIR_CACHE
+ * каталогов; поиск имени - одна корзина вместо перебора секторов
+ */
+typedef struct {
+    u32 cluster;                ///< 0 - корневой каталог
+    u32 count;
+    u32 mask;                   ///< Корзин - 1
+    fat_entry_t *entries;       ///< 0 - слот кэша пуст
+    u16 *buckets;
+    u32 last_use;
+} fat_dir_t;
+
+/**
+ * @brief Смонтированный том
+ */
+typedef struct {
+    block_device_t *dev;
+    u8 bits;                    ///< 12 или 16
+    u32 sectors_per_cluster;
+    u32 root_lba;
+    u32 root_sectors;
+    u32 data_lba;
+    u32 clusters;               ///< Кластеров данных (номера 2..clusters+1)
+    u16 *fat;                   ///< Распакованная таблица: следующий кластер
+    fat_dir_t dirs[FAT_DIR_CACHE];
+    u32 dir_clock;
+} fat_fs_t;
+
+/**
+ * @brief Открытый файл или каталог: цепочка кластеров в виде участков
+ */
+typedef struct {
+    u8 type;
+    u32 size;
+    u32 cluster;
+    u32 extent_count;
+    fat_extent_t extents[];
+} fat_node_t;
+
+static char to_upper(const char c) {
+    return c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c;
+}
+
+static char to_lower(const char c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+/**
+ * @brief FNV-1a без учета регистра (имена FAT регистронезависимы)
+ */
+static u32 name_hash(const char *name) {
+    u32 hash = 2166136261u;
+
+    while (*name) {
+        hash = (hash ^ (u8) to_upper(*name++)) * 16777619u;
+    }
+    return hash;
+}
+
+static u8 name_equal(const char *a, const char *b) {
+    while (*a && to_upper(*a) == to_upper(*b)) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static u8 cluster_valid(const fat_fs_t *fs, const u32 cluster) {
+    return cluster >= 2 && cluster < fs->clusters + 2;
+}
+
+/**
+ * @brief Строит узел: цепочка кластеров сворачивается в участки
+ * @param[in] cluster Первый кластер (0 у корня и пустого файла)
+ * @param[in] type VFS_FILE или VFS_DIR
+ * @param[in] size Размер файла; у каталогов берется длина цепочки
+ * @return Узел (освобождается kfree) или 0
+ *
+ * @note Соседние кластеры сливаются, поэтому непрерывный файл - один
+ *       участок, и чтение любого объема - одна команда устройству.
+ *       Зацикленная цепочка обрывается после fs->clusters шагов.
+ */
+static fat_node_t *node_create(const fat_fs_t *fs, const u32 cluster, const u8 type, const u32 size) {
+    u32 count = 0;
+    u32 steps = 0;
+    u32 prev = 0;
+    u32 c;
+
+    if (type == VFS_DIR && cluster == 0) {
+        fat_node_t *root = kmalloc(sizeof(fat_node_t) + sizeof(fat_extent_t));
+        if (root) {
+            root->type = VFS_DIR;
+            root->size = fs->root_sectors * SECTOR_SIZE;
+            root->cluster = 0;
+            root->extent_count = 1;
+            root->extents[0].lba = fs->root_lba;
+            root->extents[0].sectors = fs->root_sectors;
+        }
+        return root;
+    }
+
+    for (c = cluster; cluster_valid(fs, c) && steps < fs->clusters; c = fs->fat[c], steps++) {
+        if (c != prev + 1) {
+            count++;
+        }
+        prev = c;
+    }
+
+    fat_node_t *node = kmalloc(sizeof(fat_node_t) + count * sizeof(fat_extent_t));
+    if (node == 0) {
+        return 0;
+    }
+    node->type = type;
+    node->cluster = cluster;
+    node->extent_count = 0;
+
+    fat_extent_t *extent = node->extents - 1;
+    prev = 0;
+    steps = 0;
+    for (c = cluster; cluster_valid(fs, c) && steps < fs->clusters; c = fs->fat[c], steps++) {
+        if (c != prev + 1) {
+            extent++;
+            extent->lba = fs->data_lba + (c - 2) * fs->sectors_per_cluster;
+            extent->sectors = 0;
+        }
+        extent->sectors += fs->sectors_per_cluster;
+        prev = c;
+    }
+    node->extent_count = count;
+    node->size = size;
+    if (type == VFS_DIR) {
+        node->size = steps * fs->sectors_per_cluster * SECTOR_SIZE;
+    }
+    return node;
+}
+
+/**
+ * @brief Читает байты узла
+ * @return Байт прочитано или -1
+ *
+ * @note Целые серии от FAT_DIRECT_SECTORS секторов читаются прямо в
+ *       буфер вызывающего, минуя кэш блоков: содержимое больших файлов
+ *       не вытесняет из кэша метаданные. Короткие куски и края идут
+ *       через кэш.
+ */
+static s32 node_read(const fat_fs_t *fs, const fat_node_t *node, u32 offset, void *buffer, u32 len) {
+    u8 *out = buffer;
+    u32 done = 0;
+    u32 base = 0;       // Первый сектор файла в участке e
+    u32 e = 0;
+
+    if (offset >= node->size) {
+        return 0;
+    }
+    if (len > node->size - offset) {
+        len = node->size - offset;
+    }
+
+    while (done < len) {
+        const u32 sector = offset / SECTOR_SIZE;
+        const u32 skip = offset % SECTOR_SIZE;
+        u32 chunk;
+
+        while (e < node->extent_count && sector >= base + node->extents[e].sectors) {
+            base += node->extents[e].sectors;
+            e++;
+        }
+        if (e == node->extent_count) {
+            break; // Цепочка короче размера из каталога
+        }
+        const u32 lba = node->extents[e].lba + sector - base;
+
+        if (skip == 0 && len - done >= SECTOR_SIZE) {
+            u32 n = (len - done) / SECTOR_SIZE;
+            if (n > node->extents[e].sectors - (sector - base)) {
+                n = node->extents[e].sectors - (sector - base);
+            }
+            const s32 result = n >= FAT_DIRECT_SECTORS ? block_read(fs->dev, lba, n, out)
+                                                       : bcache_read(fs->dev, lba, n, out);
+            if (result != 0) {
+                return -1;
+            }
+            chunk = n * SECTOR_SIZE;
+        } else {
+            buffer_t *buf = bread(fs->dev, lba);
+            if (buf == 0) {
+                return -1;
+            }
+            chunk = SECTOR_SIZE - skip;
+            if (chunk > len - done) {
+                chunk = len - done;
+            }
+            memcpy(out, buf->data + skip, chunk);
+            brelse(buf);
+        }
+
+        done += chunk;
+        offset += chunk;
+        out += chunk;
+    }
+    return done;
+}
+
+/**
+ * @brief Имя 8.3 в виде "NAME.EXT"
+ */
+static void entry_name(const fat_raw_dirent_t *raw, char *out) {
+    u32 n = 0;
+    u32 i;
+
+    for (i = 0; i < 8 && raw->name[i] != ' '; i++) {
+        out[n++] = raw->case_flags & 0x08 ? to_lower(raw->name[i]) : raw->name[i];
+    }
+    if ((u8) out[0] == 0x05) {
+        out[0] = (char) 0xE5; // Экранированный первый байт 0xE5
+    }
+    if (raw->ext[0] != ' ') {
+        out[n++] = '.';
+        for (i = 0; i < 3 && raw->ext[i] != ' '; i++) {
+            out[n++] = raw->case_flags & 0x10 ? to_lower(raw->ext[i]) : raw->ext[i];
+        }
+    }
+    out[n] = '\0';
+}
+
+static u8 entry_skip(const fat_raw_dirent_t *raw) {
+    return (u8) raw->name[0] == 0xE5 || raw->name[0] == '.'
+           || raw->attr == FAT_ATTR_LFN || (raw->attr & FAT_ATTR_VOLUME);
+}
+
+/**
+ * @brief Читает каталог и строит его хеш-таблицу
+ * @return 0 или -1
+ */
+static s32 dir_load(const fat_fs_t *fs, fat_dir_t *dir, const u32 cluster) {
+    fat_node_t *node = node_create(fs, cluster, VFS_DIR, 0);
+    u32 count = 0;
+    u32 buckets = 16;
+    u32 total;
+    u32 i;
+
+    if (node == 0) {
+        return -1;
+    }
+    fat_raw_dirent_t *raw = kmalloc(node->size ? node->size : 1);
+    if (raw == 0 || node_read(fs, node, 0, raw, node->size) != (s32) node->size) {
+        kfree(raw);
+        kfree(node);
+        return -1;
+    }
+    total = node->size / sizeof(fat_raw_dirent_t);
+    kfree(node);
+
+    for (i = 0; i < total && raw[i].name[0] != 0; i++) {
+        count += !entry_skip(&raw[i]);
+    }
+    total = i;
+    while (buckets < count * 2) {
+        buckets *= 2;
+    }
+
+    dir->entries = kmalloc(count * sizeof(fat_entry_t) + 1);
+    dir->buckets = kmalloc(buckets * sizeof(u16));
+    if (dir->entries == 0 || dir->buckets == 0) {
+        kfree(dir->entries);
+        kfree(dir->buckets);
+        kfree(raw);
+        dir->entries = 0;
+        return -1;
+    }
+    dir->cluster = cluster;
+    dir->count = count;
+    dir->mask = buckets - 1;
+    memset(dir->buckets, 0xFF, buckets * sizeof(u16));
+
+    count = 0;
+    for (i = 0; i < total; i++) {
+        if (entry_skip(&raw[i])) {
+            continue;
+        }
+        fat_entry_t *entry = &dir->entries[count];
+        entry_name(&raw[i], entry->name);
+        entry->attr = raw[i].attr;
+        entry->cluster = raw[i].cluster;
+        entry->size = raw[i].size;
+
+        const u32 bucket = name_hash(entry->name) & dir->mask;
+        entry->next = dir->buckets[bucket];
+        dir->buckets[bucket] = count++;
+    }
+    kfree(raw);
+    return 0;
+}
+
+/**
+ * @brief Каталог из кэша; при промахе вытесняется давно не использованный
+ */
+static fat_dir_t *dir_get(fat_fs_t *fs, const u32 cluster) {
+    fat_dir_t *victim = &fs->dirs[0];
+    u32 i;
+
+    for (i = 0; i < FAT_DIR_CACHE; i++) {
+        fat_dir_t *dir = &fs->dirs[i];
+        if (dir->entries && dir->cluster == cluster) {
+            dir->last_use = ++fs->dir_clock;
+            return dir;
+        }
+        if (dir->entries == 0 || (victim->entries && dir->last_use < victim->last_use)) {
+            victim = dir;
+        }
+    }
+
+    if (victim->entries) {
+        kfree(victim->entries);
+        kfree(victim->buckets);
+        victim->entries = 0;
+    }
+    if (dir_load(fs, victim, cluster) != 0) {
+        return 0;
+    }
+    victim->last_use = ++fs->dir_clock;
+    return victim;
+}
+
+static const fat_entry_t *dir_lookup(const fat_dir_t *dir, const char *name) {
+    u16 i = dir->buckets[name_hash(name) & dir->mask];
+
+    while (i != FAT_NO_ENTRY) {
+        if (name_equal(dir->entries[i].name, name)) {
+            return &dir->entries[i];
+        }
+        i = dir->entries[i].next;
+    }
+    return 0;
+}
+
+static void *fat_open(void *fs_ptr, const char *path) {
+    fat_fs_t *fs = fs_ptr;
+    u32 cluster = 0;
+    u8 type = VFS_DIR;
+    u32 size = 0;
+    char name[13];
+
+    while (*path) {
+        u32 len = 0;
+        while (*path && *path != '/') {
+            if (len == sizeof(name) - 1) {
+                return 0; // Длиннее любого имени 8.3
+            }
+            name[len++] = *path++;
+        }
+        name[len] = '\0';
+        while (*path == '/') {
+            path++;
+        }
+
+        if (type != VFS_DIR) {
+            return 0;
+        }
+        const fat_dir_t *dir = dir_get(fs, cluster);
+        const fat_entry_t *entry = dir ? dir_lookup(dir, name) : 0;
+        if (entry == 0) {
+            return 0;
+        }
+        cluster = entry->cluster;
+        type = entry->attr & FAT_ATTR_DIR ? VFS_DIR : VFS_FILE;
+        size = entry->size;
+    }
+    return node_create(fs, cluster, type, size);
+}
+
+static void fat_close(void *fs, void *node) {
+    (void) fs;
+    kfree(node);
+}
+
+static s32 fat_read(void *fs, void *node, const u32 offset, void *buffer, const u32 len) {
+    const fat_node_t *file = node;
+
+    if (file->type != VFS_FILE) {
+        return -1;
+    }
+    return node_read(fs, file, offset, buffer, len);
+}
+
+static s32 fat_stat(void *fs, void *node, vfs_stat_t *stat) {
+    const fat_node_t *file = node;
+
+    (void) fs;
+    stat->type = file->type;
+    stat->size = file->type == VFS_FILE ? file->size : 0;
+    return 0;
+}
+
+static s32 fat_readdir(void *fs, void *node, const u32 index, vfs_dirent_t *entry) {
+    const fat_node_t *file = node;
+
+    if (file->type != VFS_DIR) {
+        return -1;
+    }
+    const fat_dir_t *dir = dir_get(fs, file->cluster);
+    if (dir == 0 || index >= dir->count) {
+        return -1;
+    }
+    strcpy(entry->name, dir->entries[index].name);
+    entry->type = dir->entries[index].attr & FAT_ATTR_DIR ? VFS_DIR : VFS_FILE;
+    entry->size = entry->type == VFS_FILE ? dir->entries[index].size : 0;
+    return 0;
+}
+
+static const vfs_ops_t fat_ops = {fat_open, fat_close, fat_read, fat_stat, fat_readdir, 0};
+
+/**
+ * @brief Проверяет BPB на правдоподобие
+ */
+static u8 bpb_valid(const u8 *sector) {
+    const fat_bpb_t *bpb = (const fat_bpb_t *) sector;
+    const u8 spc = bpb->sectors_per_cluster;
+
+    return sector[510] == 0x55 && sector[511] == 0xAA && bpb->bytes_per_sector == SECTOR_SIZE
+           && spc != 0 && (spc & (spc - 1)) == 0 && bpb->reserved_sectors != 0
+           && bpb->fat_count != 0 && bpb->fat_size != 0;
+}
+
+/**
+ * @brief Ищет раздел FAT12/16 в MBR
+ * @return Первый сектор раздела или 0
+ */
+static u32 mbr_find_fat(const u8 *sector) {
+    u32 i;
+
+    if (sector[510] != 0x55 || sector[511] != 0xAA) {
+        return 0;
+    }
+    for (i = 0; i < 4; i++) {
+        const u8 *part = sector + 446 + i * 16;
+        if (part[4] == 0x01 || part[4] == 0x04 || part[4] == 0x06 || part[4] == 0x0E) {
+            return part[8] | (part[9] << 8) | (part[10] << 16) | ((u32) part[11] << 24);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Распаковывает FAT в массив u16: O(1) переход по цепочке
+ * @details FAT12 хранит 12-битные элементы по полтора байта; после
+ * распаковки оба формата читаются одинаково, а метки конца цепочки
+ * и плохих кластеров сводятся к FAT_EOC
+ */
+static s32 fat_load_table(fat_fs_t *fs, const u32 fat_lba, const u32 fat_sectors) {
+    const u32 entries = fs->clusters + 2;
+    u32 i;
+
+    if (fat_sectors * SECTOR_SIZE * 8 / fs->bits < entries) {
+        return -1;
+    }
+    u8 *raw = kmalloc(fat_sectors * SECTOR_SIZE);
+    fs->fat = kmalloc(entries * sizeof(u16));
+    if (raw == 0 || fs->fat == 0 || block_read(fs->dev, fat_lba, fat_sectors, raw) != 0) {
+        kfree(raw);
+        kfree(fs->fat);
+        fs->fat = 0;
+        return -1;
+    }
+
+    for (i = 0; i < entries; i++) {
+        u32 next;
+        if (fs->bits == 12) {
+            const u32 at = i * 3 / 2;
+            next = raw[at] | (raw[at + 1] << 8);
+            next = i & 1 ? next >> 4 : next & 0xFFF;
+            if (next >= 0xFF7) {
+                next = FAT_EOC;
+            }
+        } else {
+            next = raw[i * 2] | (raw[i * 2 + 1] << 8);
+            if (next >= 0xFFF7) {
+                next = FAT_EOC;
+            }
+        }
+        fs->fat[i] = next;
+    }
+    kfree(raw);
+    return 0;
+}
+
+/**
+ * @brief Монтирует том FAT12/16 с устройства
+ * @param[in] dev Устройство (том на весь диск или первый раздел FAT в MBR)
+ * @param[in] path Точка монтирования
+ * @return 0 или -1
+ */
+s32 fat_mount(block_device_t *dev, const char *path) {
+    fat_bpb_t bpb;
+    u32 start = 0;
+
+    buffer_t *buf = bread(dev, 0);
+    if (buf == 0) {
+        return -1;
+    }
+    if (!bpb_valid(buf->data)) {
+        start = mbr_find_fat(buf->data);
+        brelse(buf);
+        buf = start ? bread(dev, start) : 0;
+        if (buf == 0) {
+            return -1;
+        }
+        if (!bpb_valid(buf->data)) {
+            brelse(buf);
+            return -1;
+        }
+    }
+    memcpy(&bpb, buf->data, sizeof(bpb));
+    brelse(buf);
+
+    const u32 total = bpb.total_sectors16 ? bpb.total_sectors16 : bpb.total_sectors32;
+    const u32 fat_lba = start + bpb.reserved_sectors;
+    const u32 root_sectors = (bpb.root_entries * sizeof(fat_raw_dirent_t) + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    const u32 root_lba = fat_lba + bpb.fat_count * bpb.fat_size;
+    const u32 data_lba = root_lba + root_sectors;
+    if (total <= data_lba - start || start + total > dev->sectors || root_sectors == 0) {
+        return -1;
+    }
+    const u32 clusters = (total - (data_lba - start)) / bpb.sectors_per_cluster;
+    if (clusters >= 65525) {
+        return -1; // FAT32
+    }
+
+    fat_fs_t *fs = kzalloc(sizeof(fat_fs_t));
+    if (fs == 0) {
+        return -1;
+    }
+    fs->dev = dev;
+    fs->bits = clusters < 4085 ? 12 : 16;
+    fs->sectors_per_cluster = bpb.sectors_per_cluster;
+    fs->root_lba = root_lba;
+    fs->root_sectors = root_sectors;
+    fs->data_lba = data_lba;
+    fs->clusters = clusters;
+
+    if (fat_load_table(fs, fat_lba, bpb.fat_size) != 0 || vfs_mount(path, &fat_ops, fs) != 0) {
+        kfree(fs->fat);
+        kfree(fs);
+        return -1;
+    }
+    printf("%s: FAT%u, %u clusters of %u bytes, mounted on %s\n", dev->name, fs->bits, clusters,
+           fs->sectors_per_cluster * SECTOR_SIZE, path);
+    return 0;
+}
+
+/**
+ * @brief Монтирует тома FAT со всех блочных устройств в /<имя устройства>
+ */
+void fat_init() {
+    block_device_t *dev;
+    char path[VFS_MOUNT_LEN];
+    u32 i;
+
+    for (i = 0; (dev = block_get_index(i)) != 0; i++) {
+        path[0] = '/';
+        strcpy(path + 1, dev->name);
+        fat_mount(dev, path);
+    }
+}
+
+/** @} */ // Конец группы fat
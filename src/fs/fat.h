@@ -0,0 +1,59 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef FAT_H
+#define FAT_H
+
+#include "../common.h"
+#include "../drivers/block.h"
+
+#define FAT_DIR_CACHE      8    // Каталогов с построенной хеш-таблицей
+#define FAT_DIRECT_SECTORS 8    // С такой серии секторов чтение идет мимо кэша
+
+#define FAT_ATTR_VOLUME 0x08
+#define FAT_ATTR_DIR    0x10
+#define FAT_ATTR_LFN    0x0F
+
+#define FAT_EOC 0xFFFF          // Конец цепочки в распакованной таблице
+
+/**
+ * @brief Загрузочный сектор с BPB (общая часть FAT12/16)
+ */
+typedef struct {
+    u8 jump[3];
+    char oem[8];
+    u16 bytes_per_sector;
+    u8 sectors_per_cluster;
+    u16 reserved_sectors;
+    u8 fat_count;
+    u16 root_entries;
+    u16 total_sectors16;
+    u8 media;
+    u16 fat_size;
+    u16 sectors_per_track;
+    u16 heads;
+    u32 hidden_sectors;
+    u32 total_sectors32;
+} __attribute__((packed)) fat_bpb_t;
+
+/**
+ * @brief Элемент каталога на диске (8.3)
+ */
+typedef struct {
+    char name[8];
+    char ext[3];
+    u8 attr;
+    u8 case_flags;      // Бит 3 - имя строчными, бит 4 - расширение
+    u8 reserved[7];
+    u16 cluster_high;   // Только FAT32
+    u16 time;
+    u16 date;
+    u16 cluster;
+    u32 size;
+} __attribute__((packed)) fat_raw_dirent_t;
+
+s32 fat_mount(block_device_t *dev, const char *path);
+void fat_init();
+
+#endif //FAT_H
@@ -0,0 +1,273 @@
+/**
+* @file ramfs.c
+ * @brief Файловая система initrd: архив cpio (newc) прямо в памяти
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup ramfs initrd
+ * @{
+ */
+
+#include "ramfs.h"
+#include "vfs.h"
+#include "../string.h"
+#include "../drivers/print.h"
+#include "../mm/pmm.h"
+#include "../mm/slab.h"
+
+/**
+ * @brief Файл или каталог архива
+ * @details Имя и данные указывают внутрь архива: при разборе ничего не
+ * копируется, а чтение - memcpy из памяти initrd или vfs_map без копий
+ */
+typedef struct ramfs_entry {
+    const char *path;                   ///< Полный путь без "./"
+    u32 path_len;
+    const char *name;                   ///< Последний компонент пути
+    const u8 *data;
+    u32 size;
+    u8 type;
+    struct ramfs_entry *hash_next;
+    struct ramfs_entry *first_child;
+    struct ramfs_entry *next_sibling;
+} ramfs_entry_t;
+
+static ramfs_entry_t root = {"", 0, "", 0, 0, VFS_DIR, 0, 0, 0};
+static ramfs_entry_t *entries = 0;
+static u32 entry_count = 0;
+static ramfs_entry_t *hash_table[RAMFS_HASH_SIZE];
+
+/**
+ * @brief Число из 8 шестнадцатеричных цифр заголовка newc
+ */
+static u32 hex8(const char *str) {
+    u32 value = 0;
+    u32 i;
+
+    for (i = 0; i < 8; i++) {
+        const char c = str[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        }
+    }
+    return value;
+}
+
+static u32 align4(const u32 value) {
+    return (value + 3) & ~3u;
+}
+
+/**
+ * @brief FNV-1a по len байтам пути
+ */
+static u32 path_hash(const char *path, u32 len) {
+    u32 hash = 2166136261u;
+
+    while (len--) {
+        hash = (hash ^ (u8) *path++) * 16777619u;
+    }
+    return hash & (RAMFS_HASH_SIZE - 1);
+}
+
+static ramfs_entry_t *ramfs_lookup(const char *path, const u32 len) {
+    ramfs_entry_t *entry;
+
+    if (len == 0) {
+        return &root;
+    }
+    entry = hash_table[path_hash(path, len)];
+    while (entry && (entry->path_len != len || strncmp(entry->path, path, len) != 0)) {
+        entry = entry->hash_next;
+    }
+    return entry;
+}
+
+/**
+ * @brief Обходит записи архива
+ * @param[in] archive Начало архива
+ * @param[in] size Размер
+ * @param[out] out Массив записей или 0 - только подсчет
+ * @return Число файлов и каталогов
+ */
+static u32 cpio_scan(const u8 *archive, const u32 size, ramfs_entry_t *out) {
+    u32 offset = 0;
+    u32 count = 0;
+
+    while (offset + CPIO_HEADER_SIZE <= size) {
+        const char *header = (const char *) archive + offset;
+        if (strncmp(header, CPIO_NEWC_MAGIC, 6) != 0) {
+            break;
+        }
+        const u32 mode = hex8(header + 14);
+        const u32 file_size = hex8(header + 54);
+        const u32 name_size = hex8(header + 94);    // С завершающим нулем
+        const char *path = header + CPIO_HEADER_SIZE;
+        const u32 data = align4(offset + CPIO_HEADER_SIZE + name_size);
+
+        if (name_size == 0 || data + file_size > size || strcmp(path, CPIO_TRAILER) == 0) {
+            break;
+        }
+        offset = align4(data + file_size);
+
+        while (path[0] == '.' && path[1] == '/') {
+            path += 2;
+        }
+        const u32 type = mode & CPIO_MODE_TYPE;
+        if (path[0] == '\0' || strcmp(path, ".") == 0
+            || (type != CPIO_MODE_DIR && type != CPIO_MODE_FILE)) {
+            continue; // Корень архива, ссылки и устройства
+        }
+
+        if (out) {
+            ramfs_entry_t *entry = &out[count];
+            entry->path = path;
+            entry->path_len = strlen(path);
+            entry->name = path;
+            for (const char *p = path; *p; p++) {
+                if (*p == '/') {
+                    entry->name = p + 1;
+                }
+            }
+            entry->data = archive + data;
+            entry->size = type == CPIO_MODE_FILE ? file_size : 0;
+            entry->type = type == CPIO_MODE_DIR ? VFS_DIR : VFS_FILE;
+            entry->first_child = 0;
+        }
+        count++;
+    }
+    return count;
+}
+
+static void *ramfs_open(void *fs, const char *path) {
+    u32 len = strlen(path);
+
+    (void) fs;
+    while (len > 0 && path[len - 1] == '/') {
+        len--;
+    }
+    return ramfs_lookup(path, len);
+}
+
+static void ramfs_close(void *fs, void *node) {
+    (void) fs;
+    (void) node;
+}
+
+static s32 ramfs_read(void *fs, void *node, const u32 offset, void *buffer, u32 len) {
+    const ramfs_entry_t *entry = node;
+
+    (void) fs;
+    if (entry->type != VFS_FILE) {
+        return -1;
+    }
+    if (offset >= entry->size) {
+        return 0;
+    }
+    if (len > entry->size - offset) {
+        len = entry->size - offset;
+    }
+    memcpy(buffer, entry->data + offset, len);
+    return len;
+}
+
+static s32 ramfs_stat(void *fs, void *node, vfs_stat_t *stat) {
+    const ramfs_entry_t *entry = node;
+
+    (void) fs;
+    stat->size = entry->size;
+    stat->type = entry->type;
+    return 0;
+}
+
+static s32 ramfs_readdir(void *fs, void *node, u32 index, vfs_dirent_t *out) {
+    const ramfs_entry_t *entry = node;
+    u32 i;
+
+    (void) fs;
+    if (entry->type != VFS_DIR) {
+        return -1;
+    }
+    entry = entry->first_child;
+    while (entry && index--) {
+        entry = entry->next_sibling;
+    }
+    if (entry == 0) {
+        return -1;
+    }
+    for (i = 0; i < VFS_NAME_LEN - 1 && entry->name[i]; i++) {
+        out->name[i] = entry->name[i];
+    }
+    out->name[i] = '\0';
+    out->size = entry->size;
+    out->type = entry->type;
+    return 0;
+}
+
+/**
+ * @brief Файл без копирования: указатель прямо в архив
+ */
+static const void *ramfs_map(void *fs, void *node, u32 *size) {
+    const ramfs_entry_t *entry = node;
+
+    (void) fs;
+    if (entry->type != VFS_FILE) {
+        return 0;
+    }
+    *size = entry->size;
+    return entry->data;
+}
+
+static const vfs_ops_t ramfs_ops = {ramfs_open, ramfs_close, ramfs_read, ramfs_stat, ramfs_readdir, ramfs_map};
+
+/**
+ * @brief Индексирует initrd и монтирует его в "/"
+ * @param[in] info Информация от загрузчика (адрес и размер initrd)
+ * @return 0 или -1 (initrd не загружен или пуст)
+ *
+ * @note Архив разбирается один раз: пути ложатся в хеш-таблицу (open за
+ *       O(1)), каталоги получают списки детей в порядке архива. Каталог,
+ *       которого нет в архиве, не создается - его файлы видны в корне.
+ */
+s32 ramfs_init(const boot_info_t *info) {
+    u32 i;
+
+    if (info->initrd_addr == 0 || info->initrd_size == 0) {
+        return -1;
+    }
+    const u8 *archive = PHYS_TO_VIRT(info->initrd_addr);
+
+    entry_count = cpio_scan(archive, info->initrd_size, 0);
+    entries = kmalloc(entry_count * sizeof(ramfs_entry_t) + 1);
+    if (entry_count == 0 || entries == 0) {
+        return -1;
+    }
+    cpio_scan(archive, info->initrd_size, entries);
+
+    for (i = 0; i < entry_count; i++) {
+        const u32 bucket = path_hash(entries[i].path, entries[i].path_len);
+        entries[i].hash_next = hash_table[bucket];
+        hash_table[bucket] = &entries[i];
+    }
+    // С конца: вставка в начало списка сохраняет порядок архива
+    for (i = entry_count; i-- > 0;) {
+        ramfs_entry_t *entry = &entries[i];
+        const u32 dir_len = entry->name == entry->path ? 0 : entry->name - entry->path - 1;
+        ramfs_entry_t *parent = ramfs_lookup(entry->path, dir_len);
+        if (parent == 0 || parent->type != VFS_DIR) {
+            parent = &root;
+        }
+        entry->next_sibling = parent->first_child;
+        parent->first_child = entry;
+    }
+
+    vfs_mount("/", &ramfs_ops, 0);
+    printf("initrd: %u entries, %u KB at %p\n", entry_count, (info->initrd_size + 1023) / 1024,
+           info->initrd_addr);
+    return 0;
+}
+
+/** @} */ // Конец группы ramfs
@@ -0,0 +1,23 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef RAMFS_H
+#define RAMFS_H
+
+#include "../common.h"
+#include "../kernel/boot_info.h"
+
+#define RAMFS_HASH_SIZE 64      // Корзин хеш-таблицы путей (степень двойки)
+
+#define CPIO_NEWC_MAGIC   "070701"
+#define CPIO_HEADER_SIZE  110
+#define CPIO_TRAILER      "TRAILER!!!"
+
+#define CPIO_MODE_TYPE 0170000
+#define CPIO_MODE_DIR  0040000
+#define CPIO_MODE_FILE 0100000
+
+s32 ramfs_init(const boot_info_t *info);
+
+#endif //RAMFS_H
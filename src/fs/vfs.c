@@ -0,0 +1,362 @@
+/**
+* @file vfs.c
+ * @brief Виртуальная файловая система: таблица монтирования и дескрипторы
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup vfs Виртуальная файловая система
+ * @{
+ */
+
+#include "vfs.h"
+#include "../string.h"
+#include "../drivers/print.h"
+#include "../drivers/screen.h"
+#include "../kernel/command.h"
+
+/**
+ * @brief Точка монтирования
+ */
+typedef struct {
+    char path[VFS_MOUNT_LEN];   ///< "/hda"; "/" - корень
+    u32 len;
+    const vfs_ops_t *ops;
+    void *fs;
+} vfs_mount_t;
+
+/**
+ * @brief Открытый файл
+ * @details mount == -1 - синтетический корень: список точек монтирования,
+ * если в "/" ничего не смонтировано. У корня, смонтированного в "/",
+ * точки монтирования дописываются в конец списка элементов (root).
+ */
+typedef struct {
+    u8 used;
+    u8 root;
+    s32 mount;
+    void *node;
+    u32 offset;
+} vfs_file_t;
+
+static vfs_mount_t mounts[VFS_MAX_MOUNTS];
+static u32 mount_count = 0;
+static vfs_file_t files[VFS_MAX_FILES];
+
+/**
+ * @brief Подключает файловую систему к дереву
+ * @param[in] path Абсолютный путь без завершающего '/' ("/" - корень)
+ * @return 0 или -1
+ */
+s32 vfs_mount(const char *path, const vfs_ops_t *ops, void *fs) {
+    const u32 len = strlen(path);
+
+    if (mount_count == VFS_MAX_MOUNTS || len >= VFS_MOUNT_LEN || path[0] != '/') {
+        return -1;
+    }
+    vfs_mount_t *mount = &mounts[mount_count++];
+    strcpy(mount->path, path);
+    mount->len = len == 1 ? 0 : len;
+    mount->ops = ops;
+    mount->fs = fs;
+    return 0;
+}
+
+/**
+ * @brief Ищет точку монтирования с самым длинным совпадающим префиксом
+ * @param[in] path Абсолютный путь
+ * @param[out] rest Остаток пути внутри файловой системы (без ведущих '/')
+ * @return Индекс или -1
+ */
+static s32 vfs_resolve(const char *path, const char **rest) {
+    s32 best = -1;
+    u32 i;
+
+    for (i = 0; i < mount_count; i++) {
+        const u32 len = mounts[i].len;
+        if (strncmp(path, mounts[i].path, len) != 0 || (path[len] != '/' && path[len] != '\0')) {
+            continue;
+        }
+        if (best < 0 || len > mounts[best].len) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        path += mounts[best].len;
+        while (*path == '/') {
+            path++;
+        }
+        *rest = path;
+    }
+    return best;
+}
+
+/**
+ * @brief Корень без смонтированной ФС: "/" или "//..."
+ */
+static u8 is_bare_root(const char *path) {
+    while (*path == '/') {
+        path++;
+    }
+    return *path == '\0';
+}
+
+/**
+ * @brief Открывает файл или каталог
+ * @return Дескриптор или -1
+ */
+s32 vfs_open(const char *path) {
+    const char *rest = 0;
+    s32 fd;
+
+    if (path[0] != '/') {
+        return -1;
+    }
+    for (fd = 0; fd < VFS_MAX_FILES && files[fd].used; fd++) {
+    }
+    if (fd == VFS_MAX_FILES) {
+        return -1;
+    }
+
+    const s32 mount = vfs_resolve(path, &rest);
+    void *node = 0;
+    if (mount >= 0) {
+        node = mounts[mount].ops->open(mounts[mount].fs, rest);
+        if (node == 0) {
+            return -1;
+        }
+    } else if (!is_bare_root(path)) {
+        return -1;
+    }
+
+    files[fd].used = 1;
+    files[fd].root = is_bare_root(path);
+    files[fd].mount = mount;
+    files[fd].node = node;
+    files[fd].offset = 0;
+    return fd;
+}
+
+static vfs_file_t *vfs_file(const s32 fd) {
+    return fd >= 0 && fd < VFS_MAX_FILES && files[fd].used ? &files[fd] : 0;
+}
+
+s32 vfs_close(const s32 fd) {
+    vfs_file_t *file = vfs_file(fd);
+
+    if (file == 0) {
+        return -1;
+    }
+    if (file->mount >= 0) {
+        mounts[file->mount].ops->close(mounts[file->mount].fs, file->node);
+    }
+    file->used = 0;
+    return 0;
+}
+
+/**
+ * @brief Читает с текущей позиции и сдвигает ее
+ * @return Байт прочитано (0 - конец файла) или -1
+ */
+s32 vfs_read(const s32 fd, void *buffer, const u32 len) {
+    vfs_file_t *file = vfs_file(fd);
+
+    if (file == 0 || file->mount < 0) {
+        return -1;
+    }
+    const vfs_mount_t *mount = &mounts[file->mount];
+    const s32 result = mount->ops->read(mount->fs, file->node, file->offset, buffer, len);
+    if (result > 0) {
+        file->offset += result;
+    }
+    return result;
+}
+
+s32 vfs_seek(const s32 fd, const u32 offset) {
+    vfs_file_t *file = vfs_file(fd);
+
+    if (file == 0) {
+        return -1;
+    }
+    file->offset = offset;
+    return 0;
+}
+
+s32 vfs_fstat(const s32 fd, vfs_stat_t *stat) {
+    const vfs_file_t *file = vfs_file(fd);
+
+    if (file == 0) {
+        return -1;
+    }
+    if (file->mount < 0) {
+        stat->size = 0;
+        stat->type = VFS_DIR;
+        return 0;
+    }
+    return mounts[file->mount].ops->stat(mounts[file->mount].fs, file->node, stat);
+}
+
+s32 vfs_stat(const char *path, vfs_stat_t *stat) {
+    const s32 fd = vfs_open(path);
+
+    if (fd < 0) {
+        return -1;
+    }
+    const s32 result = vfs_fstat(fd, stat);
+    vfs_close(fd);
+    return result;
+}
+
+/**
+ * @brief Возвращает точку монтирования первого уровня как элемент каталога
+ * @param[in] index Номер среди точек, кроме самого корня
+ */
+static s32 mount_dirent(u32 index, vfs_dirent_t *entry) {
+    u32 i;
+
+    for (i = 0; i < mount_count; i++) {
+        if (mounts[i].len == 0) {
+            continue;
+        }
+        if (index-- == 0) {
+            strcpy(entry->name, mounts[i].path + 1);
+            entry->size = 0;
+            entry->type = VFS_DIR;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Возвращает элемент каталога по номеру
+ * @return 0 или -1 (конец каталога, не каталог)
+ */
+s32 vfs_readdir(const s32 fd, const u32 index, vfs_dirent_t *entry) {
+    const vfs_file_t *file = vfs_file(fd);
+    u32 count = 0;
+
+    if (file == 0) {
+        return -1;
+    }
+    if (file->mount < 0) {
+        return mount_dirent(index, entry);
+    }
+
+    const vfs_mount_t *mount = &mounts[file->mount];
+    if (mount->ops->readdir(mount->fs, file->node, index, entry) == 0) {
+        return 0;
+    }
+    if (!file->root) {
+        return -1;
+    }
+    // Элементы корневой ФС кончились - дальше точки монтирования
+    while (mount->ops->readdir(mount->fs, file->node, count, entry) == 0) {
+        count++;
+    }
+    return index >= count ? mount_dirent(index - count, entry) : -1;
+}
+
+/**
+ * @brief Содержимое файла без копирования
+ * @param[in] fd Дескриптор
+ * @param[out] size Размер файла
+ * @return Указатель на данные или 0, если ФС это не поддерживает
+ */
+const void *vfs_map(const s32 fd, u32 *size) {
+    const vfs_file_t *file = vfs_file(fd);
+
+    if (file == 0 || file->mount < 0 || mounts[file->mount].ops->map == 0) {
+        return 0;
+    }
+    return mounts[file->mount].ops->map(mounts[file->mount].fs, file->node, size);
+}
+
+/**
+ * @brief Печатает содержимое каталога (команда ls)
+ * @return 0 или -1 (нет такого каталога)
+ */
+s32 vfs_print_dir(const char *path) {
+    vfs_dirent_t entry;
+    vfs_stat_t stat;
+    u32 i;
+
+    const s32 fd = vfs_open(path);
+    if (fd < 0) {
+        return -1;
+    }
+    if (vfs_fstat(fd, &stat) != 0 || stat.type != VFS_DIR) {
+        vfs_close(fd);
+        return -1;
+    }
+    for (i = 0; vfs_readdir(fd, i, &entry) == 0; i++) {
+        if (entry.type == VFS_DIR) {
+            printf("%-16s    <DIR>\n", entry.name);
+        } else {
+            printf("%-16s %8u\n", entry.name, entry.size);
+        }
+    }
+    vfs_close(fd);
+    return 0;
+}
+
+/**
+ * @brief Выводит файл на консоль (команда cat)
+ * @param[in] path Путь
+ * @param[in] color Цвет текста
+ * @return 0 или -1 (нет такого файла, ошибка чтения)
+ *
+ * @note Файл из памяти (vfs_map) печатается прямо из нее, без копий
+ */
+s32 vfs_print_file(const char *path, const u8 color) {
+    char chunk[VFS_PRINT_CHUNK + 1];
+    u32 size;
+    s32 n;
+
+    const s32 fd = vfs_open(path);
+    if (fd < 0) {
+        return -1;
+    }
+
+    const char *data = vfs_map(fd, &size);
+    if (data) {
+        for (u32 offset = 0; offset < size; offset += VFS_PRINT_CHUNK) {
+            n = size - offset < VFS_PRINT_CHUNK ? size - offset : VFS_PRINT_CHUNK;
+            colored_print(color, "%.*s", n, data + offset);
+        }
+        vfs_close(fd);
+        return 0;
+    }
+
+    while ((n = vfs_read(fd, chunk, VFS_PRINT_CHUNK)) > 0) {
+        chunk[n] = '\0';
+        colored_print(color, "%s", chunk);
+    }
+    vfs_close(fd);
+    return n;
+}
+
+static s32 cmd_ls(u32 argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "/";
+
+    if (vfs_print_dir(path) != 0) {
+        colored_print(0x04, "No such directory: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static s32 cmd_cat(u32 argc, char **argv) {
+    if (argc != 2) {
+        colored_print(0x04, "Usage: cat <path>\n");
+        return -1;
+    }
+    if (vfs_print_file(argv[1], GREEN_ON_BLACK) != 0) {
+        colored_print(0x04, "Cannot read file: %s\n", argv[1]);
+        return -1;
+    }
+    return 0;
+}
+
+COMMAND("ls", cmd_ls, "[path]", "List directory (/ is the initrd, disks are /hda...)");
+COMMAND("cat", cmd_cat, "<path>", "Print file");
+
+/** @} */ // Конец группы vfs
@@ -0,0 +1,63 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef VFS_H
+#define VFS_H
+
+#include "../common.h"
+
+#define VFS_MAX_MOUNTS 8
+#define VFS_MAX_FILES  16    // Одновременно открытых файлов
+#define VFS_NAME_LEN   32
+#define VFS_MOUNT_LEN  16    // Длина пути точки монтирования
+#define VFS_PRINT_CHUNK 256  // Порция вывода cat (меньше PRINT_BUFFER_SIZE)
+
+#define VFS_FILE 1
+#define VFS_DIR  2
+
+/**
+ * @brief Сведения о файле (vfs_stat)
+ */
+typedef struct {
+    u32 size;
+    u8 type;    // VFS_FILE или VFS_DIR
+} vfs_stat_t;
+
+/**
+ * @brief Элемент каталога (vfs_readdir)
+ */
+typedef struct {
+    char name[VFS_NAME_LEN];
+    u32 size;
+    u8 type;
+} vfs_dirent_t;
+
+/**
+ * @brief Операции файловой системы
+ * @details Узел (node) - объект драйвера, живущий от open до close.
+ * Путь в open отсчитывается от точки монтирования, "" - ее корень.
+ * map необязательна: ФС в памяти отдает указатель на содержимое файла.
+ */
+typedef struct {
+    void *(*open)(void *fs, const char *path);
+    void (*close)(void *fs, void *node);
+    s32 (*read)(void *fs, void *node, u32 offset, void *buffer, u32 len); // Байт прочитано или -1
+    s32 (*stat)(void *fs, void *node, vfs_stat_t *stat);
+    s32 (*readdir)(void *fs, void *node, u32 index, vfs_dirent_t *entry); // -1 - конец каталога
+    const void *(*map)(void *fs, void *node, u32 *size);
+} vfs_ops_t;
+
+s32 vfs_mount(const char *path, const vfs_ops_t *ops, void *fs);
+s32 vfs_open(const char *path);
+s32 vfs_close(s32 fd);
+s32 vfs_read(s32 fd, void *buffer, u32 len);
+s32 vfs_seek(s32 fd, u32 offset);
+s32 vfs_fstat(s32 fd, vfs_stat_t *stat);
+s32 vfs_stat(const char *path, vfs_stat_t *stat);
+s32 vfs_readdir(s32 fd, u32 index, vfs_dirent_t *entry);
+const void *vfs_map(s32 fd, u32 *size);
+s32 vfs_print_dir(const char *path);
+s32 vfs_print_file(const char *path, u8 color);
+
+#endif //VFS_H
@@ -0,0 +1,224 @@
+/**
+* @file bench.c
+ * @brief Микробенчмарки ядра (команда bench)
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup bench Микробенчмарки
+ * @{
+ */
+
+#include "bench.h"
+#include "../string.h"
+#include "../cpu/tsc.h"
+#include "../drivers/print.h"
+#include "../drivers/screen.h"
+#include "../drivers/keyboard.h"
+#include "../drivers/timer.h"
+#include "ktimer.h"
+#include "command.h"
+
+static u8 bench_src[4096] __attribute__((aligned(16)));
+static u8 bench_dst[4096] __attribute__((aligned(16)));
+static char bench_str1[65];
+static char bench_str2[65];
+static ktimer_t bench_timers[64];
+static volatile u32 bench_sink; ///< Не дает компилятору выбросить результат
+
+static void bench_memcpy() {
+    memcpy(bench_dst, bench_src, sizeof(bench_dst));
+}
+
+static void bench_strcmp() {
+    bench_sink = strcmp(bench_str1, bench_str2);
+}
+
+static void bench_putchar() {
+    u32 i;
+    for (i = 0; i < 64; i++) {
+        putchar('a' + (i & 15), GREEN_ON_BLACK);
+    }
+    putchar('\n', GREEN_ON_BLACK);
+}
+
+static void bench_printf() {
+    printf("bench %d %s %x\n", 12345, "printf", 0xBEEF);
+}
+
+static void bench_scroll_line() {
+    scroll_line();
+}
+
+static void bench_clear_screen() {
+    clear_screen();
+}
+
+/**
+ * @brief Нажатия клавиш без Shift: коды отпускания и Shift меняли бы
+ *        shift_pressed и результат остальных замеров
+ */
+static const u8 bench_scancodes[] = {
+    0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B,
+    0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+    0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x39, 0x1C
+};
+
+static void bench_scancode() {
+    u32 i, acc = 0;
+    for (i = 0; i < sizeof(bench_scancodes); i++) {
+        acc += scancode_to_ascii(bench_scancodes[i]);
+    }
+    bench_sink = acc;
+}
+
+static void bench_timer_noop(void *arg) {
+}
+
+/**
+ * @brief Постановка и снятие таймеров со сроками на разных уровнях колеса
+ */
+static void bench_timer() {
+    u32 i;
+    for (i = 0; i < 64; i++) {
+        timer_add(&bench_timers[i], 1000 + i * 97, 0);
+    }
+    for (i = 0; i < 64; i++) {
+        timer_del(&bench_timers[i]);
+    }
+}
+
+static const bench_t benches[] = {
+    {"memcpy", bench_memcpy, sizeof(bench_dst)},
+    {"strcmp", bench_strcmp, 1},
+    {"putchar", bench_putchar, 65},
+    {"printf", bench_printf, 1},
+    {"scroll_line", bench_scroll_line, 1},
+    {"clear_screen", bench_clear_screen, 1},
+    {"scancode_to_ascii", bench_scancode, sizeof(bench_scancodes)},
+    {"timer_add_del", bench_timer, 128},
+};
+
+#define BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+
+/**
+ * @brief Сортировка вставками: замеров немного, памяти не нужно
+ */
+static void sort_samples(u32 *samples, const u32 count) {
+    u32 i;
+
+    for (i = 1; i < count; i++) {
+        const u32 value = samples[i];
+        u32 j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+/**
+ * @brief Выполняет замеры одного бенчмарка
+ * @param[in] bench Бенчмарк
+ * @param[out] result Минимум, медиана и 99-й перцентиль, тактов на вызов run()
+ *
+ * Каждый замер обрамлен rdtsc_ordered(): LFENCE перед RDTSC не дает
+ * счетчику прочитаться до завершения измеряемого кода. Прерывания не
+ * запрещаются - их вклад виден в p99, а минимум и медиана от них
+ * почти не зависят.
+ */
+void bench_measure(const bench_t *bench, bench_result_t *result) {
+    static u32 samples[BENCH_SAMPLES];
+    u32 i;
+
+    for (i = 0; i < BENCH_WARMUP; i++) {
+        bench->run();
+    }
+
+    // Стоимость пустого замера вычитается из результатов
+    u32 overhead = ~0u;
+    for (i = 0; i < BENCH_WARMUP; i++) {
+        const u64 start = rdtsc_ordered();
+        const u32 cycles = (u32) (rdtsc_ordered() - start);
+        if (cycles < overhead) {
+            overhead = cycles;
+        }
+    }
+
+    for (i = 0; i < BENCH_SAMPLES; i++) {
+        const u64 start = rdtsc_ordered();
+        bench->run();
+        const u32 cycles = (u32) (rdtsc_ordered() - start);
+        samples[i] = cycles > overhead ? cycles - overhead : 0;
+    }
+
+    sort_samples(samples, BENCH_SAMPLES);
+    result->min = samples[0];
+    result->median = samples[BENCH_SAMPLES / 2];
+    result->p99 = samples[BENCH_SAMPLES * 99 / 100];
+}
+
+/**
+ * @brief Запускает бенчмарки и печатает таблицу
+ * @param[in] name Имя бенчмарка или 0 - все
+ * @return 0 или -1, если бенчмарк с таким именем не найден
+ *
+ * @note Бенчмарки консоли портят экран, поэтому таблица печатается
+ *       после всех замеров. Строки отчета начинаются с "bench:", чтобы
+ *       их было просто выбрать из журнала COM1 (make bench)
+ */
+s32 bench_run(const char *name) {
+    bench_result_t results[BENCH_COUNT];
+    u8 selected[BENCH_COUNT];
+    u32 i, found = 0;
+
+    for (i = 0; i < sizeof(bench_src); i++) {
+        bench_src[i] = (u8) i;
+    }
+    for (i = 0; i < 64; i++) {
+        bench_str1[i] = bench_str2[i] = 'a' + i % 26;
+    }
+    for (i = 0; i < 64; i++) {
+        timer_setup(&bench_timers[i], bench_timer_noop, 0, 0);
+    }
+
+    for (i = 0; i < BENCH_COUNT; i++) {
+        selected[i] = name == 0 || strcmp(name, benches[i].name) == 0;
+        if (selected[i]) {
+            bench_measure(&benches[i], &results[i]);
+            found++;
+        }
+    }
+    if (found == 0) {
+        return -1;
+    }
+
+    clear_screen();
+    printf("bench: %-18s %5s %8s %8s %8s %9s  (cycles, TSC %u kHz)\n",
+           "name", "ops", "min", "median", "p99", "median/op", tsc_khz());
+    for (i = 0; i < BENCH_COUNT; i++) {
+        if (selected[i]) {
+            u64 per_op = (u64) results[i].median * 100;
+            div64(&per_op, benches[i].ops);
+            printf("bench: %-18s %5u %8u %8u %8u %6u.%02u\n", benches[i].name, benches[i].ops,
+                   results[i].min, results[i].median, results[i].p99,
+                   (u32) per_op / 100, (u32) per_op % 100);
+        }
+    }
+    return 0;
+}
+
+static s32 cmd_bench(u32 argc, char **argv) {
+    if (argc == 1) {
+        return bench_run(0);
+    }
+    if (bench_run(argv[1]) != 0) {
+        colored_print(0x04, "Unknown benchmark: %s\n", argv[1]);
+        return -1;
+    }
+    return 0;
+}
+
+COMMAND("bench", cmd_bench, "[name]", "Run microbenchmarks");
+
+/** @} */ // Конец группы bench
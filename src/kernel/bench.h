@@ -0,0 +1,36 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "../common.h"
+
+#define BENCH_WARMUP  16    // Прогонов до замеров (кэши, TLB, предсказатель)
+#define BENCH_SAMPLES 256   // Замеров на бенчмарк
+
+/**
+ * @brief Описание бенчмарка
+ * @details Один замер - один вызов run(), который выполняет ops операций
+ * (байт, символов, строк); в отчете есть и такты на операцию
+ */
+typedef struct {
+    const char *name;
+    void (*run)();
+    u32 ops;
+} bench_t;
+
+/**
+ * @brief Результат: такты на вызов run()
+ */
+typedef struct {
+    u32 min;
+    u32 median;
+    u32 p99;
+} bench_result_t;
+
+void bench_measure(const bench_t *bench, bench_result_t *result);
+s32 bench_run(const char *name);
+
+#endif //BENCH_H
@@ -0,0 +1,41 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef BOOT_INFO_H
+#define BOOT_INFO_H
+
+#include "../common.h"
+
+// Должно совпадать с boot/boot_layout.asm
+#define E820_MAX_ENTRIES 64
+
+#define E820_USABLE      1  // Свободная память
+#define E820_RESERVED    2  // Занято прошивкой или устройствами
+#define E820_ACPI        3  // Таблицы ACPI (освобождаемо после разбора)
+#define E820_NVS         4  // ACPI NVS
+#define E820_BAD         5  // Неисправная память
+
+/**
+ * @brief Запись карты памяти BIOS (INT 15h, EAX=E820h)
+ */
+typedef struct {
+    u64 base;   // Физический адрес начала
+    u64 length; // Длина в байтах
+    u32 type;   // E820_*
+    u32 acpi;   // Расширенные атрибуты ACPI 3.0
+} __attribute__((packed)) e820_entry_t;
+
+/**
+ * @brief Информация, которую второй этап загрузчика передает ядру
+ * @details Лежит по адресу BOOT_INFO_ADDR, указатель приходит в kmain()
+ */
+typedef struct {
+    u32 e820_count;
+    u32 initrd_addr;    // Физический адрес initrd (0 - не загружен)
+    u32 initrd_size;    // Размер в байтах
+    u32 reserved;
+    e820_entry_t e820[E820_MAX_ENTRIES];
+} __attribute__((packed)) boot_info_t;
+
+#endif //BOOT_INFO_H
@@ -0,0 +1,165 @@
+/**
+* @file command.c
+ * @brief Реестр команд оболочки: таблица из секции, хеш, разбор строки
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup command Команды оболочки
+ * @{
+ */
+
+#include "command.h"
+#include "../string.h"
+#include "../drivers/print.h"
+#include "../drivers/screen.h"
+
+/**
+ * @brief Границы секции .commands (из linker.ld)
+ */
+extern const command_t *const _commands_start[];
+extern const command_t *const _commands_end[];
+
+/**
+ * @brief Хеш-таблица с открытой адресацией (линейное пробирование)
+ */
+static const command_t *table[COMMAND_HASH_SIZE];
+
+/**
+ * @brief FNV-1a имени команды
+ */
+static u32 command_hash(const char *name) {
+    u32 hash = 2166136261u;
+
+    while (*name) {
+        hash = (hash ^ (u8) *name++) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Строит хеш-таблицу по секции .commands
+ *
+ * @note Таблица заполнена не больше чем наполовину, поэтому поиск -
+ *       в среднем одна-две пробы независимо от числа команд
+ */
+void command_init() {
+    const command_t *const *cmd;
+
+    for (cmd = _commands_start; cmd < _commands_end; cmd++) {
+        u32 slot = command_hash((*cmd)->name) & (COMMAND_HASH_SIZE - 1);
+        u32 probes = 0;
+
+        while (table[slot] && strcmp(table[slot]->name, (*cmd)->name) != 0 && probes < COMMAND_HASH_SIZE) {
+            slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);
+            probes++;
+        }
+        if (probes == COMMAND_HASH_SIZE || table[slot]) {
+            colored_print(0x04, "command: cannot register %s (duplicate or table full)\n", (*cmd)->name);
+            continue;
+        }
+        table[slot] = *cmd;
+    }
+}
+
+/**
+ * @brief Ищет команду по имени
+ * @return Описание или 0
+ */
+const command_t *command_find(const char *name) {
+    u32 slot = command_hash(name) & (COMMAND_HASH_SIZE - 1);
+    u32 probes;
+
+    for (probes = 0; probes < COMMAND_HASH_SIZE && table[slot]; probes++) {
+        if (strcmp(table[slot]->name, name) == 0) {
+            return table[slot];
+        }
+        slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Разбивает строку на слова на месте
+ * @param[in,out] line Строка; разделители заменяются нулями
+ * @param[out] argv Указатели на слова
+ * @param[in] max Размер argv
+ * @return Число слов
+ *
+ * @note Слова разделяются пробелами; "в кавычках" - одно слово с пробелами
+ */
+u32 command_tokenize(char *line, char **argv, const u32 max) {
+    u32 argc = 0;
+
+    while (*line && argc < max) {
+        while (*line == ' ') {
+            line++;
+        }
+        if (*line == '\0') {
+            break;
+        }
+
+        const char end = *line == '"' ? '"' : ' ';
+        if (end == '"') {
+            line++;
+        }
+        argv[argc++] = line;
+        while (*line && *line != end) {
+            line++;
+        }
+        if (*line) {
+            *line++ = '\0';
+        }
+    }
+    return argc;
+}
+
+/**
+ * @brief Разбирает строку и вызывает обработчик
+ * @return Результат обработчика, 0 для пустой строки, -1 - нет команды
+ */
+s32 command_execute(char *line) {
+    char *argv[COMMAND_MAX_ARGS];
+    const u32 argc = command_tokenize(line, argv, COMMAND_MAX_ARGS);
+
+    if (argc == 0) {
+        return 0;
+    }
+    const command_t *cmd = command_find(argv[0]);
+    if (cmd == 0) {
+        colored_print(0x04, "Unknown command: %s (try help)\n", argv[0]);
+        return -1;
+    }
+    return cmd->handler(argc, argv);
+}
+
+/**
+ * @brief Список команд, собранный из таблицы и отсортированный по имени
+ */
+static s32 cmd_help(u32 argc, char **argv) {
+    const command_t *sorted[COMMAND_HASH_SIZE];
+    char title[32];
+    u32 count = 0;
+    u32 i;
+
+    for (i = 0; i < COMMAND_HASH_SIZE; i++) {
+        if (table[i] == 0) {
+            continue;
+        }
+        u32 j = count++;
+        while (j > 0 && strcmp(sorted[j - 1]->name, table[i]->name) > 0) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = table[i];
+    }
+
+    clear_screen();
+    for (i = 0; i < count; i++) {
+        snprintf(title, sizeof(title), "%s %s", sorted[i]->name, sorted[i]->usage);
+        colored_print(0x0F, " %-22s | %s\n", title, sorted[i]->help);
+    }
+    return 0;
+}
+
+COMMAND("help", cmd_help, "", "Show this menu");
+
+/** @} */ // Конец группы command
@@ -0,0 +1,53 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "../common.h"
+
+#define COMMAND_LINE_LEN  128   // Длина строки ввода оболочки
+#define COMMAND_MAX_ARGS  8     // Слов в строке, включая имя команды
+#define COMMAND_HASH_SIZE 64    // Слотов открытой адресации (степень двойки)
+
+/**
+ * @brief Обработчик команды
+ * @param[in] argc Число слов (argv[0] - имя команды)
+ * @param[in] argv Слова строки
+ * @return 0 или код ошибки
+ */
+typedef s32 (*command_handler_t)(u32 argc, char **argv);
+
+/**
+ * @brief Команда оболочки
+ */
+typedef struct {
+    const char *name;
+    const char *usage;      // Аргументы для help, "" - без аргументов
+    const char *help;
+    command_handler_t handler;
+} command_t;
+
+/**
+ * @brief Регистрирует команду в таблице секции .commands
+ * @details Описание ложится в .rodata, а указатель на него - в .commands;
+ * linker.ld собирает указатели всех файлов в массив между
+ * _commands_start и _commands_end. Указатели, а не сами структуры,
+ * нужны, чтобы выравнивание объектов не оставляло дыр в массиве.
+ * @code
+ * static s32 cmd_mem(u32 argc, char **argv) { ... }
+ * COMMAND("mem", cmd_mem, "", "Physical memory map and usage");
+ * @endcode
+ */
+#define COMMAND(name, handler, usage, help)                                         \
+    static const command_t command_##handler = {name, usage, help, handler};        \
+    static const command_t *const command_ptr_##handler                            \
+        __attribute__((used, section(".commands"))) = &command_##handler
+
+void command_init();
+u32 command_tokenize(char *line, char **argv, u32 max);
+const command_t *command_find(const char *name);
+s32 command_execute(char *line);
+
+#endif //COMMAND_H
@@ -0,0 +1,318 @@
+/**
+* @file exec.c
+ * @brief Загрузчик программ ELF32 с подкачкой страниц по требованию
+ *
+ * Загрузка читает только заголовки: сегменты PT_LOAD запоминаются как
+ * области нового адресного пространства, ни одна страница не отображается.
+ * Код и данные подкачиваются из файла при первом обращении, BSS и стек
+ * при чтении отображаются на общую нулевую страницу только для чтения и
+ * получают свою страницу при первой записи. Время запуска не зависит от
+ * размера файла, нетронутые страницы не занимают памяти.
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup exec Загрузчик программ
+ * @{
+ */
+
+#include "exec.h"
+#include "user.h"
+#include "sched.h"
+#include "../string.h"
+#include "../mm/pmm.h"
+#include "../mm/slab.h"
+#include "../mm/paging.h"
+#include "../fs/vfs.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "command.h"
+
+static u32 zero_page_phys;      ///< Общая нулевая страница, выделяется один раз
+
+/**
+ * @brief Выделяет обнуленную страницу
+ * @return Физический адрес или 0
+ */
+static u32 alloc_zeroed_page() {
+    const u32 phys = alloc_page();
+    if (phys) {
+        memset(PHYS_TO_VIRT(phys), 0, PAGE_SIZE);
+    }
+    return phys;
+}
+
+/**
+ * @brief Сегмент программы, которому принадлежит адрес, или 0
+ */
+static exec_segment_t *find_segment(exec_image_t *image, const u32 addr) {
+    u32 i;
+
+    for (i = 0; i < image->count; i++) {
+        if (addr >= image->segments[i].start && addr < image->segments[i].end) {
+            return &image->segments[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Заполняет страницу сегмента байтами файла
+ * @param[in] page Виртуальный адрес страницы
+ * @return Физический адрес новой страницы или 0 (нет памяти, ошибка чтения)
+ *
+ * @note Страница копируется, а не отображается из ramfs: данные cpio
+ *       выровнены только на 4 байта
+ */
+static u32 load_file_page(const exec_image_t *image, const exec_segment_t *seg, const u32 page) {
+    const u32 from = page > seg->file_start ? page : seg->file_start;
+    const u32 to = page + PAGE_SIZE < seg->file_end ? page + PAGE_SIZE : seg->file_end;
+    const u32 phys = alloc_zeroed_page();
+
+    if (phys == 0) {
+        return 0;
+    }
+    if (vfs_seek(image->fd, seg->offset + (from - seg->file_start)) != 0 ||
+        vfs_read(image->fd, (u8 *) PHYS_TO_VIRT(phys) + (from - page), to - from) != (s32) (to - from)) {
+        free_page(phys);
+        return 0;
+    }
+    return phys;
+}
+
+/**
+ * @brief Подкачивает страницу программы текущего потока
+ * @param[in] addr Адрес обращения
+ * @param[in] err  Код ошибки #PF (PF_ERR_*); 0 - проверка чтения из ядра
+ * @param[in] may_sleep Прерванный код шел с разрешенными прерываниями:
+ *                  на время чтения файла (диск ждет IRQ) их можно включить
+ * @return 0, если страница отображена, или -1 (адрес вне сегментов,
+ *         запись в сегмент только для чтения, нет памяти)
+ *
+ * Страница с байтами файла читается из него. Страница без них при чтении
+ * отображается на нулевую, а при записи (в том числе поверх нулевой)
+ * получает собственную обнуленную страницу.
+ */
+s32 exec_page_fault(const u32 addr, const u32 err, const u32 may_sleep) {
+    const thread_t *self = thread_current();
+    exec_image_t *image = self ? self->image : 0;
+    const u32 page = PAGE_ALIGN_DOWN(addr);
+
+    if (image == 0) {
+        return -1;
+    }
+    const exec_segment_t *seg = find_segment(image, addr);
+    if (seg == 0 || ((err & PF_ERR_WRITE) && !(seg->flags & PTE_WRITE))) {
+        return -1;
+    }
+
+    if (err & PF_ERR_PRESENT) {
+        // Отображенную страницу меняет только запись в нулевую
+        if (!(err & PF_ERR_WRITE) || PAGE_ALIGN_DOWN(paging_translate(page)) != zero_page_phys) {
+            return -1;
+        }
+    } else if (page >= seg->file_end || page + PAGE_SIZE <= seg->file_start) {
+        if (!(err & PF_ERR_WRITE)) {
+            if (map_page(page, zero_page_phys, PTE_USER) != 0) {
+                return -1;
+            }
+            image->zero_pages++;
+            return 0;
+        }
+    } else {
+        // Адрес - страница программы, а не ошибка ядра: можно ждать диск
+        if (may_sleep) {
+            interrupts_enable();
+        }
+        const u32 phys = load_file_page(image, seg, page);
+        if (phys == 0 || map_page(page, phys, seg->flags | PTE_USER) != 0) {
+            if (phys) {
+                free_page(phys);
+            }
+            return -1;
+        }
+        image->file_pages++;
+        return 0;
+    }
+
+    const u32 phys = alloc_zeroed_page();
+    if (phys == 0 || map_page(page, phys, seg->flags | PTE_USER) != 0) {
+        if (phys) {
+            free_page(phys);
+        }
+        return -1;
+    }
+    image->anon_pages++;
+    return 0;
+}
+
+/**
+ * @brief Добавляет сегмент PT_LOAD к программе
+ * @return 0 или -1 (сегмент вне пространства программы, задевает стек,
+ *         выходит за файл или делит страницу с предыдущим)
+ */
+static s32 add_segment(exec_image_t *image, const elf32_phdr_t *phdr, const u32 file_size) {
+    const u32 start = PAGE_ALIGN_DOWN(phdr->vaddr);
+    const u32 end = PAGE_ALIGN_UP(phdr->vaddr + phdr->memsz);
+
+    if (image->count == EXEC_MAX_SEGMENTS || phdr->filesz > phdr->memsz ||
+        phdr->vaddr < USER_BASE || phdr->vaddr + phdr->memsz < phdr->vaddr ||
+        end > USER_STACK_TOP - USER_STACK_SIZE ||
+        phdr->offset + phdr->filesz < phdr->offset || phdr->offset + phdr->filesz > file_size) {
+        return -1;
+    }
+    // Сегменты идут по возрастанию адресов; общая страница получила бы
+    // права и содержимое только одного из них
+    if (image->count && start < image->segments[image->count - 1].end) {
+        return -1;
+    }
+
+    exec_segment_t *seg = &image->segments[image->count++];
+    seg->start = start;
+    seg->end = end;
+    seg->file_start = phdr->vaddr;
+    seg->file_end = phdr->vaddr + phdr->filesz;
+    seg->offset = phdr->offset;
+    seg->flags = (phdr->flags & PF_W) ? PTE_WRITE : 0;
+    return 0;
+}
+
+/**
+ * @brief Читает заголовки ELF и готовит адресное пространство
+ * @param[in] fd Открытый файл программы (переходит к образу)
+ * @return Образ или 0 (не ELF32 для i386, неверные сегменты, нет памяти)
+ */
+static exec_image_t *exec_load(const s32 fd) {
+    elf32_ehdr_t ehdr;
+    elf32_phdr_t phdr;
+    vfs_stat_t stat;
+    u32 i;
+
+    if (vfs_fstat(fd, &stat) != 0 || stat.type != VFS_FILE ||
+        vfs_read(fd, &ehdr, sizeof(ehdr)) != sizeof(ehdr)) {
+        return 0;
+    }
+    if (ehdr.magic != ELF_MAGIC || ehdr.class != ELF_CLASS32 || ehdr.data != ELF_DATA2LSB ||
+        ehdr.type != ET_EXEC || ehdr.machine != EM_386 || ehdr.phentsize != sizeof(elf32_phdr_t)) {
+        return 0;
+    }
+
+    exec_image_t *image = kzalloc(sizeof(exec_image_t));
+    if (image == 0) {
+        return 0;
+    }
+    image->fd = fd;
+    image->entry = ehdr.entry;
+
+    for (i = 0; i < ehdr.phnum; i++) {
+        if (vfs_seek(fd, ehdr.phoff + i * sizeof(phdr)) != 0 ||
+            vfs_read(fd, &phdr, sizeof(phdr)) != sizeof(phdr)) {
+            kfree(image);
+            return 0;
+        }
+        if (phdr.type == PT_LOAD && phdr.memsz && add_segment(image, &phdr, stat.size) != 0) {
+            kfree(image);
+            return 0;
+        }
+    }
+    if (image->count == 0 || find_segment(image, image->entry) == 0) {
+        kfree(image);
+        return 0;
+    }
+
+    exec_segment_t *stack = &image->segments[image->count++];
+    stack->start = USER_STACK_TOP - USER_STACK_SIZE;
+    stack->end = USER_STACK_TOP;
+    stack->file_start = stack->file_end = stack->start; // Без байтов файла
+    stack->flags = PTE_WRITE;
+
+    if (zero_page_phys == 0) {
+        zero_page_phys = alloc_zeroed_page();
+    }
+    image->directory = paging_create_directory();
+    if (zero_page_phys == 0 || image->directory == 0) {
+        kfree(image);
+        return 0;
+    }
+    return image;
+}
+
+/**
+ * @brief Освобождает подкачанные страницы программы
+ * @note Каталог программы должен быть текущим
+ */
+static void exec_free_pages(const exec_image_t *image) {
+    u32 i, page;
+
+    for (i = 0; i < image->count; i++) {
+        for (page = image->segments[i].start; page < image->segments[i].end; page += PAGE_SIZE) {
+            const u32 phys = PAGE_ALIGN_DOWN(paging_translate(page));
+            if (phys && phys != zero_page_phys) {
+                free_page(phys);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Запускает программу в текущем потоке и ждет ее завершения
+ *
+ * Имя без '/' ищется в EXEC_BIN_DIR. Поток получает адресное пространство
+ * программы; планировщик переключает его вместе с потоком.
+ */
+static s32 cmd_run(u32 argc, char **argv) {
+    char path[VFS_MOUNT_LEN + VFS_NAME_LEN];
+    thread_t *self = thread_current();
+
+    if (argc != 2) {
+        colored_print(0x04, "Usage: run <program>\n");
+        return -1;
+    }
+    const u32 prefix = argv[1][0] == '/' ? 0 : strlen(EXEC_BIN_DIR);
+    if (prefix + strlen(argv[1]) >= sizeof(path)) {
+        colored_print(0x04, "run: name too long\n");
+        return -1;
+    }
+    strcpy(path, EXEC_BIN_DIR);
+    strcpy(path + prefix, argv[1]);
+    if (self == 0 || self->image) {
+        colored_print(0x04, "run: thread already runs a program\n");
+        return -1;
+    }
+
+    const s32 fd = vfs_open(path);
+    if (fd < 0) {
+        colored_print(0x04, "run: %s not found\n", path);
+        return -1;
+    }
+    exec_image_t *image = exec_load(fd);
+    if (image == 0) {
+        vfs_close(fd);
+        colored_print(0x04, "run: %s is not a valid i386 executable\n", path);
+        return -1;
+    }
+
+    u32 flags = irq_save();
+    self->image = image;
+    self->page_directory = image->directory;
+    paging_switch(image->directory);
+    irq_restore(flags);
+
+    const s32 code = user_run(image->entry, USER_STACK_TOP);
+
+    exec_free_pages(image);
+    flags = irq_save();
+    self->image = 0;
+    self->page_directory = 0;
+    paging_switch(0);
+    irq_restore(flags);
+
+    paging_destroy_directory(image->directory);
+    vfs_close(image->fd);
+    printf("exit code %d; pages: %u from file, %u zero-filled, %u shared zero\n",
+           code, image->file_pages, image->anon_pages, image->zero_pages);
+    kfree(image);
+    return 0;
+}
+
+COMMAND("run", cmd_run, "<program>", "Run an ELF program (name alone looks in /bin)");
+
+/** @} */ // Конец группы exec
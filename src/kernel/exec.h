@@ -0,0 +1,89 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef EXEC_H
+#define EXEC_H
+
+#include "../common.h"
+
+#define ELF_MAGIC    0x464C457F  // "\x7FELF" в порядке little-endian
+#define ELF_CLASS32  1
+#define ELF_DATA2LSB 1
+#define ET_EXEC      2
+#define EM_386       3
+#define PT_LOAD      1
+#define PF_W         2
+
+#define EXEC_MAX_SEGMENTS 8     // Сегментов PT_LOAD в программе
+#define EXEC_BIN_DIR      "/bin/"
+
+/**
+ * @brief Заголовок ELF32
+ */
+typedef struct {
+    u32 magic;
+    u8 class;
+    u8 data;
+    u8 version;
+    u8 pad[9];
+    u16 type;
+    u16 machine;
+    u32 version2;
+    u32 entry;
+    u32 phoff;
+    u32 shoff;
+    u32 flags;
+    u16 ehsize;
+    u16 phentsize;
+    u16 phnum;
+    u16 shentsize;
+    u16 shnum;
+    u16 shstrndx;
+} __attribute__((packed)) elf32_ehdr_t;
+
+/**
+ * @brief Заголовок программы ELF32
+ */
+typedef struct {
+    u32 type;
+    u32 offset;
+    u32 vaddr;
+    u32 paddr;
+    u32 filesz;
+    u32 memsz;
+    u32 flags;
+    u32 align;
+} __attribute__((packed)) elf32_phdr_t;
+
+/**
+ * @brief Область адресного пространства программы
+ * @details [start, end) выровнены по страницам. Байты [file_start, file_end)
+ * берутся из файла со смещения offset, остальное - нули.
+ */
+typedef struct {
+    u32 start;
+    u32 end;
+    u32 file_start;
+    u32 file_end;
+    u32 offset;                 ///< Смещение file_start в файле
+    u32 flags;                  ///< PTE_WRITE или 0
+} exec_segment_t;
+
+/**
+ * @brief Загруженная программа: адресное пространство и открытый файл
+ */
+typedef struct exec_image {
+    u32 *directory;             ///< Каталог страниц программы
+    s32 fd;                     ///< Файл, из которого подкачиваются страницы
+    u32 entry;
+    exec_segment_t segments[EXEC_MAX_SEGMENTS + 1]; ///< PT_LOAD и стек
+    u32 count;
+    u32 file_pages;             ///< Подкачано из файла
+    u32 zero_pages;             ///< Отображено на общую нулевую страницу
+    u32 anon_pages;             ///< Выделено под запись в BSS и стек
+} exec_image_t;
+
+s32 exec_page_fault(u32 addr, u32 err, u32 may_sleep);
+
+#endif //EXEC_H
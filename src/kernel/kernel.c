@@ -1,16 +1,95 @@
 #include "../common.h"
+#include "../string.h"
 #include "../drivers/screen.h"
 #include "../drivers/input.h"
 #include "../drivers/print.h"
 #include "../drivers/asm_io.h"
+#include "../drivers/keyboard.h"
+#include "../drivers/timer.h"
+#include "../drivers/serial.h"
+#include "../drivers/ata.h"
+#include "../drivers/bcache.h"
+#include "../cpu/isr.h"
+#include "../cpu/gdt.h"
+#include "../mm/pmm.h"
+#include "../mm/paging.h"
+#include "../mm/slab.h"
+#include "../fs/fat.h"
+#include "../fs/ramfs.h"
+#include "boot_info.h"
+#include "sched.h"
+#include "trace.h"
+#include "profile.h"
+#include "ktimer.h"
+#include "command.h"
+#include "smp.h"
+#include "syscall.h"
 
+static char username[50];
+
+static s32 cmd_whoami(u32 argc, char **argv) {
+    printf("%s\n", username);
+    return 0;
+}
+
+static s32 cmd_shutdown(u32 argc, char **argv) {
+    clear_screen();
+    printf("Shutting down...");
+    serial_flush();
+    // asm volatile("hlt");
+    power_off();
+    return 0;
+}
+
+COMMAND("whoami", cmd_whoami, "", "Current user");
+COMMAND("q", cmd_shutdown, "", "Shutdown system");
+
+s32 kmain(boot_info_t *boot_info) {
+    gdt_init(); // Первым: трассировка находит кольцо процессора через %gs
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "kmain");
+    string_init();
+    screen_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "screen");
+    isr_install();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "isr");
+    syscall_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "syscall");
+    serial_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "serial");
+    paging_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "paging");
+    pmm_init(boot_info);
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "pmm");
+    kmalloc_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "kmalloc");
+    ramfs_init(boot_info);
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "initrd");
+    keyboard_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "keyboard");
+    timer_init(TIMER_HZ);
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "timer");
+    profile_init();
+    ktimer_init();
+    sched_init();
+    ktimer_deferred_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "sched");
+    smp_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "smp");
+    timer_tickless_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "clockevent");
+    ata_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "ata");
+    bcache_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "bcache");
+    fat_init();
+    TRACE_EVENT1(TRACE_BOOT_STAGE, "fat");
+    command_init();
+    interrupts_enable();
 
-s32 kmain() {
     clear_screen();
     print_rick_and_morty();
     printf("Welcome to QuarkOS v1.0\n");
 
-    char username[50];
     char password[50];
     char* os_name = "quark";
 
@@ -27,38 +106,13 @@ s32 kmain() {
         }
     }
 
-    char command[50];
+    char command[COMMAND_LINE_LEN];
 
     printf("%s@%s:~$ ", username, os_name);
 
     while (1) {
         scanf(command, sizeof(command));
-
-        if (strcmp(command, "q") == 0) {
-            clear_screen();
-            printf("Shutting down...");
-            // asm volatile("hlt");
-            power_off();
-            break;
-        }
-
-        if (!strcmp(command, "cow")) {
-            printf("\n");
-            print_cow();
-        } else if (!strcmp(command, "clear")) {
-            clear_screen();
-        } else if (!strcmp(command, "rimo")) {
-            print_rick_and_morty();
-        } else if (!strcmp(command, "whoami")) {
-            printf(username);
-        } else if (!strcmp(command, "help")) {
-            clear_screen();
-            colored_print(0x0F, " help  | Show this menu\n");
-            colored_print(0x0F, " clear | Clear screen\n");
-            colored_print(0x0F, " cow   | Show ASCII art cow\n");
-            colored_print(0x0F, " rimo  | Rick and Morty art\n");
-            colored_print(0x0F, " q     | Shutdown system\n");
-        }
+        command_execute(command);
 
         printf("%s@%s:~$ ", username, os_name);
     }
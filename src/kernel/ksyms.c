@@ -0,0 +1,60 @@
+/**
+* @file ksyms.c
+ * @brief Поиск символов ядра по адресу
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup ksyms Символы ядра
+ * @{
+ */
+
+#include "ksyms.h"
+
+extern u8 _kernel_start[];
+extern u8 _image_end[];
+
+/**
+ * @brief Индекс функции, которой принадлежит адрес
+ * @param[in] addr Адрес кода
+ * @return Индекс в ksyms_table или -1
+ *
+ * @note Двоичный поиск последнего символа с адресом <= addr
+ */
+s32 ksym_index(const u32 addr) {
+    const u32 count = ksyms_count();
+
+    if (count == 0 || addr < ksyms_table[0].addr
+        || addr < (u32) _kernel_start || addr >= (u32) _image_end) {
+        return -1;
+    }
+
+    u32 low = 0;
+    u32 high = count;
+    while (high - low > 1) {
+        const u32 mid = (low + high) / 2;
+        if (ksyms_table[mid].addr <= addr) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (s32) low;
+}
+
+/**
+ * @brief Имя функции по адресу
+ * @param[in] addr Адрес кода
+ * @param[out] offset Смещение от начала функции (может быть 0)
+ * @return Имя или 0, если адрес вне таблицы
+ */
+const char *ksym_lookup(const u32 addr, u32 *offset) {
+    const s32 i = ksym_index(addr);
+    if (i < 0) {
+        return 0;
+    }
+    if (offset) {
+        *offset = addr - ksyms_table[i].addr;
+    }
+    return ksyms_table[i].name;
+}
+
+/** @} */ // Конец группы ksyms
@@ -0,0 +1,36 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef KSYMS_H
+#define KSYMS_H
+
+#include "../common.h"
+
+/**
+ * @brief Символ ядра: адрес начала функции и имя
+ */
+typedef struct {
+    u32 addr;
+    const char *name;
+} ksym_t;
+
+/**
+ * Таблица генерируется при сборке из `nm -n kernel.elf` (build/ksyms_gen.c)
+ * и отсортирована по адресу. В первом проходе компоновки ее еще нет:
+ * слабые ссылки тогда разрешаются в 0, это проверяет ksyms_count().
+ */
+extern const ksym_t ksyms_table[] __attribute__((weak));
+extern const u32 ksyms_table_count __attribute__((weak));
+
+/**
+ * @brief Число символов в таблице (0, если таблица не сгенерирована)
+ */
+static inline u32 ksyms_count() {
+    return &ksyms_table_count != 0 ? ksyms_table_count : 0;
+}
+
+s32 ksym_index(u32 addr);
+const char *ksym_lookup(u32 addr, u32 *offset);
+
+#endif //KSYMS_H
@@ -0,0 +1,469 @@
+/**
+* @file ktimer.c
+ * @brief Иерархическое колесо таймеров: таймауты, периодические вызовы, msleep
+ *
+ * Срок таймера хранится в единицах колеса (2^KTIMER_SHIFT нс). Корневой
+ * уровень - 256 ячеек по одной единице: в нем таймеры, до срока которых
+ * меньше 256 единиц. Таймеры дальше лежат на верхних уровнях в ячейках
+ * по 2^8, 2^14, 2^20 и 2^26 единиц. Когда часы колеса проходят границу
+ * ячейки уровня, ее таймеры каскадом переносятся на уровень ниже - уже
+ * в точные ячейки. Вставка и снятие - O(1) без сортировки, каждый таймер
+ * переносится не больше WHEEL_LEVELS раз.
+ *
+ * Периодического тика нет: после каждого прохода колесо заказывает
+ * прерывание таймера к ближайшему сроку корня или ближайшему каскаду.
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup ktimer Колесо таймеров
+ * @{
+ */
+
+#include "ktimer.h"
+#include "sched.h"
+#include "spinlock.h"
+#include "../string.h"
+#include "../drivers/timer.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "command.h"
+
+#define ROOT_MASK  (WHEEL_ROOT_SIZE - 1)
+#define LEVEL_MASK (WHEEL_LEVEL_SIZE - 1)
+
+/**
+ * @brief Сдвиг срока для индекса ячейки уровня level
+ */
+#define LEVEL_SHIFT(level) (WHEEL_ROOT_BITS + (level) * WHEEL_LEVEL_BITS)
+
+static ktimer_t *root[WHEEL_ROOT_SIZE];
+static ktimer_t *levels[WHEEL_LEVELS][WHEEL_LEVEL_SIZE];
+static u32 wheel_clock;             ///< Следующая необработанная единица
+static u32 pending = 0;             ///< Таймеров в колесе
+static u32 root_pending = 0;        ///< Из них в корне
+static spinlock_t wheel_lock = SPINLOCK_INIT;
+
+static ktimer_t *deferred;          ///< Сработавшие таймеры KTIMER_DEFERRED
+static wait_queue_t ktimerd_wait;
+
+static u32 fired = 0;
+static u32 cascaded = 0;
+
+/**
+ * @brief Текущее время в единицах колеса
+ */
+static u32 ktimer_now() {
+    return (u32) (ktime_ns() >> KTIMER_SHIFT);
+}
+
+/**
+ * @brief Миллисекунды в единицы колеса с округлением вверх
+ */
+static u32 ms_to_units(const u32 ms) {
+    const u64 units = ((u64) ms * 1000000 + (1u << KTIMER_SHIFT) - 1) >> KTIMER_SHIFT;
+    return units > KTIMER_MAX_UNITS ? KTIMER_MAX_UNITS : (u32) units;
+}
+
+static void bucket_link(ktimer_t **bucket, ktimer_t *timer) {
+    timer->bucket = bucket;
+    timer->prev = 0;
+    timer->next = *bucket;
+    if (*bucket) {
+        (*bucket)->prev = timer;
+    }
+    *bucket = timer;
+}
+
+static void bucket_unlink(ktimer_t *timer) {
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        *timer->bucket = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+    timer->bucket = 0;
+}
+
+static u8 in_root(const ktimer_t *timer) {
+    return timer->bucket >= root && timer->bucket < root + WHEEL_ROOT_SIZE;
+}
+
+static u8 in_wheel(const ktimer_t *timer) {
+    return timer->bucket != 0 && timer->bucket != &deferred;
+}
+
+/**
+ * @brief Ставит таймер в ячейку по расстоянию до срока
+ * @note Вызывать под wheel_lock
+ */
+static void wheel_insert(ktimer_t *timer) {
+    const u32 expires = timer->expires;
+    const u32 delta = expires - wheel_clock;
+    u32 level = 0;
+
+    pending++;
+    if ((s32) delta < 0) {
+        // Срок уже прошел: в ближайшую обрабатываемую ячейку
+        root_pending++;
+        bucket_link(&root[wheel_clock & ROOT_MASK], timer);
+        return;
+    }
+    if (delta < WHEEL_ROOT_SIZE) {
+        root_pending++;
+        bucket_link(&root[expires & ROOT_MASK], timer);
+        return;
+    }
+    while (level < WHEEL_LEVELS - 1 && delta >= 1u << LEVEL_SHIFT(level + 1)) {
+        level++;
+    }
+    bucket_link(&levels[level][(expires >> LEVEL_SHIFT(level)) & LEVEL_MASK], timer);
+}
+
+/**
+ * @brief Снимает таймер с колеса или из очереди ktimerd
+ * @note Вызывать под wheel_lock
+ */
+static void wheel_remove(ktimer_t *timer) {
+    if (in_wheel(timer)) {
+        pending--;
+        if (in_root(timer)) {
+            root_pending--;
+        }
+    }
+    bucket_unlink(timer);
+}
+
+/**
+ * @brief Переносит ячейку уровня на уровни ниже
+ * @return Индекс ячейки: 0 - граница следующего уровня, нужен и его каскад
+ */
+static u32 cascade(const u32 level) {
+    const u32 index = (wheel_clock >> LEVEL_SHIFT(level)) & LEVEL_MASK;
+    ktimer_t *timer = levels[level][index];
+
+    levels[level][index] = 0;
+    while (timer) {
+        ktimer_t *next = timer->next;
+        pending--;
+        wheel_insert(timer);
+        cascaded++;
+        timer = next;
+    }
+    return index;
+}
+
+/**
+ * @brief Ближайшее событие колеса: срок в корне или каскад непустой ячейки
+ * @return Расстояние от wheel_clock в единицах; вызывать при pending != 0
+ */
+static u32 wheel_next_delta() {
+    u32 best = KTIMER_MAX_UNITS;
+    u32 level, i;
+
+    if (root_pending) {
+        for (i = 0; i < WHEEL_ROOT_SIZE; i++) {
+            if (root[(wheel_clock + i) & ROOT_MASK]) {
+                best = i;
+                break;
+            }
+        }
+    }
+    if (pending == root_pending) {
+        return best;
+    }
+
+    for (level = 0; level < WHEEL_LEVELS; level++) {
+        const u32 shift = LEVEL_SHIFT(level);
+        const u32 base = wheel_clock >> shift;
+        // Ячейку текущей границы уже перенесли, если часы за ней
+        i = (wheel_clock & ((1u << shift) - 1)) ? 1 : 0;
+        for (; i <= WHEEL_LEVEL_SIZE; i++) {
+            if (levels[level][(base + i) & LEVEL_MASK]) {
+                const u32 delta = ((base + i) << shift) - wheel_clock;
+                if (delta < best) {
+                    best = delta;
+                }
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Заказывает прерывание таймера к ближайшему событию колеса
+ * @note Вызывать под wheel_lock
+ */
+static void wheel_program() {
+    if (pending == 0) {
+        return;
+    }
+    const u32 event = wheel_clock + wheel_next_delta();
+    const u64 now = ktime_ns();
+    const s32 delta = (s32) (event - (u32) (now >> KTIMER_SHIFT));
+
+    if (delta <= 0) {
+        timer_program(now);
+    } else {
+        timer_program(((now >> KTIMER_SHIFT) + (u32) delta) << KTIMER_SHIFT);
+    }
+}
+
+/**
+ * @brief Следующий срок периодического таймера после сработавшего
+ * @param[in] now Единица, на которой он сработал
+ * @note Пропущенные периоды не наверстываются
+ */
+static void periodic_advance(ktimer_t *timer, const u32 now) {
+    timer->expires += timer->period;
+    if ((s32) (timer->expires - now) <= 0) {
+        timer->expires = now + timer->period;
+    }
+}
+
+/**
+ * @brief Прерывание таймера: доводит часы колеса до текущего времени
+ *
+ * Каждый сработавший таймер вызывается без блокировки, поэтому
+ * обработчик может снова поставить или снять любой таймер, в том числе
+ * себя. Пустые ячейки корня пропускаются до ближайшей границы каскада.
+ */
+static void ktimer_tick(registers_t *regs) {
+    const u32 now = ktimer_now();
+    u8 wake = 0;
+
+    spin_lock(&wheel_lock);
+    if (pending == 0) {
+        wheel_clock = now + 1;
+    }
+    while ((s32) (now - wheel_clock) >= 0) {
+        const u32 index = wheel_clock & ROOT_MASK;
+        u32 level = 0;
+
+        if (index == 0) {
+            while (level < WHEEL_LEVELS && cascade(level) == 0) {
+                level++;
+            }
+        }
+        if (root_pending == 0) {
+            u32 skip = (wheel_clock | ROOT_MASK) + 1;
+            if ((s32) (skip - now) > 0) {
+                skip = now + 1;
+            }
+            wheel_clock = skip;
+            continue;
+        }
+
+        while (root[index]) {
+            ktimer_t *timer = root[index];
+            wheel_remove(timer);
+            fired++;
+            if (timer->flags & KTIMER_DEFERRED) {
+                bucket_link(&deferred, timer);
+                wake = 1;
+                continue;
+            }
+            if (timer->period) {
+                periodic_advance(timer, wheel_clock);
+                wheel_insert(timer);
+            }
+            spin_unlock(&wheel_lock);
+            timer->fn(timer->arg);
+            spin_lock(&wheel_lock);
+        }
+        wheel_clock++;
+    }
+    wheel_program();
+    spin_unlock(&wheel_lock);
+
+    if (wake) {
+        wait_queue_wake_all(&ktimerd_wait);
+    }
+}
+
+/**
+ * @brief Поток отложенных вызовов: обработчики KTIMER_DEFERRED
+ * @details Здесь можно спать и ждать диск, поэтому сюда идут, например,
+ * периодическая запись кэша и таймауты драйверов.
+ */
+static void ktimerd(void *arg) {
+    (void) arg;
+    while (1) {
+        const u32 flags = spin_lock_irqsave(&wheel_lock);
+        ktimer_t *timer = deferred;
+        if (timer == 0) {
+            spin_unlock(&wheel_lock);
+            wait_queue_sleep(&ktimerd_wait);
+            irq_restore(flags);
+            continue;
+        }
+
+        wheel_remove(timer);
+        if (timer->period) {
+            periodic_advance(timer, ktimer_now());
+            wheel_insert(timer);
+            wheel_program();
+        }
+        spin_unlock_irqrestore(&wheel_lock, flags);
+        timer->fn(timer->arg);
+    }
+}
+
+/**
+ * @brief Подписывает колесо на прерывание таймера
+ * @note Вызывать до sched_init(): подписчики после планировщика
+ *       вызываются только когда прерванный поток снова получит процессор
+ */
+void ktimer_init() {
+    wheel_clock = ktimer_now();
+    timer_register_hook(ktimer_tick);
+}
+
+/**
+ * @brief Запускает поток ktimerd
+ * @note Вызывать после sched_init()
+ */
+void ktimer_deferred_init() {
+    thread_create("ktimerd", ktimerd, 0, SCHED_PRIO_HIGH);
+}
+
+/**
+ * @brief Инициализирует таймер
+ * @param[out] timer Таймер
+ * @param[in] fn     Обработчик срабатывания
+ * @param[in] arg    Аргумент обработчика
+ * @param[in] flags  0 - вызов из прерывания, KTIMER_DEFERRED - из ktimerd
+ */
+void timer_setup(ktimer_t *timer, ktimer_fn_t fn, void *arg, const u32 flags) {
+    timer->next = timer->prev = 0;
+    timer->bucket = 0;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->flags = flags;
+}
+
+/**
+ * @brief Ставит (или переставляет) таймер
+ * @param[in,out] timer     Таймер после timer_setup()
+ * @param[in]     ms        Срабатывание не раньше чем через ms миллисекунд
+ * @param[in]     period_ms Затем каждые period_ms; 0 - однократно
+ *
+ * @note Можно вызывать из обработчика прерывания и из обработчика самого
+ *       таймера. Разрешение - единица колеса (~1 мс). Срок больше
+ *       KTIMER_MAX_UNITS (~13 суток) сокращается до него
+ */
+void timer_add(ktimer_t *timer, const u32 ms, const u32 period_ms) {
+    const u32 flags = spin_lock_irqsave(&wheel_lock);
+    const u32 now = ktimer_now();
+
+    if (timer->bucket) {
+        wheel_remove(timer);
+    }
+    if (pending == 0) {
+        // Пустое колесо: часы не нужно догонять через пустые ячейки
+        wheel_clock = now;
+    }
+    // +1: текущая единица уже частично прошла
+    timer->expires = now + ms_to_units(ms) + 1;
+    // Не раньше следующей единицы часов колеса: иначе таймер, снова
+    // поставленный из своего обработчика, попал бы в обрабатываемую
+    // ячейку, и ktimer_tick() разбирал бы ее бесконечно
+    if ((s32) (timer->expires - wheel_clock) <= 0) {
+        timer->expires = wheel_clock + 1;
+    }
+    timer->period = period_ms ? ms_to_units(period_ms) : 0;
+    if (period_ms && timer->period == 0) {
+        timer->period = 1;
+    }
+    wheel_insert(timer);
+    wheel_program();
+    spin_unlock_irqrestore(&wheel_lock, flags);
+}
+
+/**
+ * @brief Снимает таймер
+ * @return 1, если таймер ждал срабатывания, иначе 0
+ *
+ * @note Не ждет обработчика, который уже выполняется на другом процессоре
+ *       или в ktimerd
+ */
+s32 timer_del(ktimer_t *timer) {
+    const u32 flags = spin_lock_irqsave(&wheel_lock);
+    const s32 was_pending = timer->bucket != 0;
+
+    if (was_pending) {
+        wheel_remove(timer);
+    }
+    spin_unlock_irqrestore(&wheel_lock, flags);
+    return was_pending;
+}
+
+static void msleep_wake(void *arg) {
+    sched_wake((thread_t *) arg);
+}
+
+/**
+ * @brief Усыпляет текущий поток не меньше чем на ms миллисекунд
+ * @note До sched_init() ждет через usleep()
+ */
+void msleep(const u32 ms) {
+    thread_t *self = thread_current();
+    ktimer_t timer;
+
+    if (self == 0) {
+        usleep(ms * 1000);
+        return;
+    }
+
+    timer_setup(&timer, msleep_wake, self, 0);
+    const u32 flags = irq_save();
+    timer_add(&timer, ms, 0);
+    // sched_wake() от кого-то другого не должен оборвать сон раньше срока
+    while (timer_pending(&timer)) {
+        sched_block();
+    }
+    irq_restore(flags);
+}
+
+static s32 cmd_sleep(u32 argc, char **argv) {
+    const char *digit = argc == 2 ? argv[1] : "";
+    u32 ms = 0;
+
+    // Только десятичное число без знака, не больше 32 бит
+    do {
+        if (*digit < '0' || *digit > '9' || ms > (0xFFFFFFFFu - 9) / 10) {
+            colored_print(0x04, "Usage: sleep <ms>\n");
+            return -1;
+        }
+        ms = ms * 10 + (*digit++ - '0');
+    } while (*digit);
+
+    const u64 start = ktime_ns();
+    msleep(ms);
+    u64 us = ktime_ns() - start;
+    div64(&us, 1000);
+    printf("slept %llu us\n", us);
+    return 0;
+}
+
+COMMAND("sleep", cmd_sleep, "<ms>", "Sleep on the timer wheel");
+
+static s32 cmd_timers(u32 argc, char **argv) {
+    const u32 flags = spin_lock_irqsave(&wheel_lock);
+    const u32 total = pending;
+    const u32 in_root_now = root_pending;
+    const u32 clock = wheel_clock;
+    spin_unlock_irqrestore(&wheel_lock, flags);
+
+    printf("timer wheel: %u pending (%u in root), clock %u, unit %u ns\n",
+           total, in_root_now, clock, 1u << KTIMER_SHIFT);
+    printf("fired: %u, cascaded: %u\n", fired, cascaded);
+    return 0;
+}
+
+COMMAND("timers", cmd_timers, "", "Timer wheel statistics");
+
+/** @} */ // Конец группы ktimer
@@ -0,0 +1,55 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef KTIMER_H
+#define KTIMER_H
+
+#include "../common.h"
+
+#define KTIMER_SHIFT      20    // Единица колеса - 2^20 нс (~1.05 мс)
+#define KTIMER_MAX_UNITS  0x3FFFFFFF // Сравнения по модулю 2^32 ломаются с 2^31; запас
+                                     // на +1 в timer_add() и отставание часов колеса
+
+#define WHEEL_ROOT_BITS   8     // Корневой уровень: 256 ячеек по единице
+#define WHEEL_LEVEL_BITS  6     // Верхние уровни: по 64 ячейки
+#define WHEEL_LEVELS      4     // 8 + 4 * 6 = 32 бита срока
+#define WHEEL_ROOT_SIZE   (1 << WHEEL_ROOT_BITS)
+#define WHEEL_LEVEL_SIZE  (1 << WHEEL_LEVEL_BITS)
+
+#define KTIMER_DEFERRED   0x01  // Вызывать из потока ktimerd, а не из прерывания
+
+typedef void (*ktimer_fn_t)(void *arg);
+
+/**
+ * @brief Таймер колеса
+ * @details Структуру выделяет владелец; пока таймер ждет, она входит в
+ * двусвязный список ячейки, поэтому снятие не ищет таймер по списку.
+ */
+typedef struct ktimer {
+    struct ktimer *next;
+    struct ktimer *prev;
+    struct ktimer **bucket;     ///< Голова списка, где стоит таймер (0 - не ждет)
+    u32 expires;                ///< Срок в единицах колеса
+    u32 period;                 ///< Период в единицах колеса, 0 - однократный
+    ktimer_fn_t fn;
+    void *arg;
+    u32 flags;                  ///< KTIMER_DEFERRED
+} ktimer_t;
+
+void ktimer_init();
+void ktimer_deferred_init();
+
+void timer_setup(ktimer_t *timer, ktimer_fn_t fn, void *arg, u32 flags);
+void timer_add(ktimer_t *timer, u32 ms, u32 period_ms);
+s32 timer_del(ktimer_t *timer);
+void msleep(u32 ms);
+
+/**
+ * @brief Ждет ли таймер срабатывания (в колесе или в очереди ktimerd)
+ */
+static inline s32 timer_pending(const ktimer_t *timer) {
+    return timer->bucket != 0;
+}
+
+#endif //KTIMER_H
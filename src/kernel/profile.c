@@ -0,0 +1,224 @@
+/**
+* @file profile.c
+ * @brief Статистический профилировщик по прерываниям таймера
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup profile Профилировщик
+ * @{
+ */
+
+#include "profile.h"
+#include "ksyms.h"
+#include "../string.h"
+#include "../mm/slab.h"
+#include "../mm/paging.h"
+#include "../drivers/timer.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "command.h"
+
+/**
+ * @brief Гистограммы по функциям из ksyms_table
+ * @details self - замеры, в которых функция исполнялась; total - в которых
+ * она была в цепочке вызовов (считается один раз на замер)
+ */
+static u32 *self_counts;
+static u32 *total_counts;
+static u32 samples = 0;
+static u32 unknown = 0;         ///< EIP вне таблицы символов
+static u32 interval = 1;        ///< Замер каждые interval периодов 1/timer_hz()
+static u64 next_sample;         ///< Момент следующего замера (ktime_ns)
+static volatile u8 running = 0;
+
+/**
+ * @brief Период замеров, нс
+ */
+static u64 sample_period() {
+    return (u64) interval * (NSEC_PER_SEC / timer_hz());
+}
+
+/**
+ * @brief Замер в прерывании таймера: функция прерванного кода и ее вызывающие
+ *
+ * Прерывания приходят не только к сроку замера (их заказывают и другие
+ * подписчики), поэтому замер делается, только когда срок наступил; с
+ * допуском в полпериода это совпадает с каждым interval-м тиком PIT.
+ * Цепочка раскручивается по сохраненным EBP (ядро собирается без
+ * -fomit-frame-pointer): [ebp] - предыдущий EBP, [ebp + 4] - адрес возврата.
+ * Кадры проверяются на попадание в память ядра и рост вверх по стеку,
+ * чтобы мусорный EBP не увел за пределы отображения.
+ */
+static void profile_tick(registers_t *regs) {
+    s32 seen[PROFILE_DEPTH + 1];
+    u32 depth = 0;
+    u32 i;
+
+    if (!running) {
+        return;
+    }
+    const u64 now = ktime_ns();
+    const u64 period = sample_period();
+    if (now + period / 2 < next_sample) {
+        timer_program(next_sample);
+        return;
+    }
+    next_sample += period;
+    if (next_sample <= now) {
+        next_sample = now + period;
+    }
+    timer_program(next_sample);
+    samples++;
+
+    s32 sym = ksym_index(regs->eip);
+    if (sym < 0) {
+        unknown++;
+        return;
+    }
+    self_counts[sym]++;
+    seen[depth++] = sym;
+
+    const u32 *frame = (const u32 *) regs->ebp;
+    while (depth <= PROFILE_DEPTH && (u32) frame >= KERNEL_VIRT_BASE
+           && (u32) frame < KERNEL_VIRT_BASE + DIRECT_MAP_SIZE - 8 && ((u32) frame & 3) == 0) {
+        sym = ksym_index(frame[1]);
+        if (sym < 0) {
+            break;
+        }
+        seen[depth++] = sym;
+        if (frame[0] <= (u32) frame) {
+            break;
+        }
+        frame = (const u32 *) frame[0];
+    }
+
+    // Рекурсия не должна считаться дважды
+    for (i = 0; i < depth; i++) {
+        u32 j = 0;
+        while (j < i && seen[j] != seen[i]) {
+            j++;
+        }
+        if (j == i) {
+            total_counts[seen[i]]++;
+        }
+    }
+}
+
+/**
+ * @brief Подписывает профилировщик на прерывание таймера
+ * @note Вызывать до sched_init(): обработчик должен увидеть кадр
+ *       прерванного потока раньше, чем планировщик переключит стек
+ */
+void profile_init() {
+    timer_register_hook(profile_tick);
+}
+
+/**
+ * @brief Начинает новый сеанс профилирования
+ * @param[in] every Замер каждые every периодов 1/timer_hz() (0 трактуется как 1)
+ * @return 0 или -1 (нет таблицы символов или памяти)
+ */
+s32 profile_start(const u32 every) {
+    if (ksyms_count() == 0) {
+        return -1;
+    }
+
+    profile_stop();
+    if (self_counts == 0) {
+        self_counts = kmalloc(ksyms_count() * 4);
+        total_counts = kmalloc(ksyms_count() * 4);
+        if (self_counts == 0 || total_counts == 0) {
+            kfree(self_counts);
+            kfree(total_counts);
+            self_counts = total_counts = 0;
+            return -1;
+        }
+    }
+
+    memset(self_counts, 0, ksyms_count() * 4);
+    memset(total_counts, 0, ksyms_count() * 4);
+    samples = 0;
+    unknown = 0;
+    interval = every ? every : 1;
+
+    const u32 flags = irq_save();
+    next_sample = ktime_ns() + sample_period();
+    running = 1;
+    timer_program(next_sample);
+    irq_restore(flags);
+    return 0;
+}
+
+/**
+ * @brief Останавливает сбор (гистограммы сохраняются до следующего start)
+ */
+void profile_stop() {
+    running = 0;
+}
+
+/**
+ * @brief Печатает самые частые функции
+ *
+ * Выбор top-N - частичная сортировка: N проходов по таблице с поиском
+ * максимума среди еще не напечатанных. Таблица - сотни функций, N мал.
+ */
+void profile_report() {
+    u32 printed[PROFILE_TOP];
+    u32 n, i;
+
+    if (self_counts == 0 || samples == 0) {
+        printf("profile: no samples\n");
+        return;
+    }
+
+    const u32 flags = irq_save();
+    const u8 was_running = running;
+    running = 0;
+    irq_restore(flags);
+
+    printf("profile: %u samples every %u tick(s) at %u Hz, %u outside kernel text\n",
+           samples, interval, timer_hz(), unknown);
+    printf("   self     %%    total  function\n");
+    for (n = 0; n < PROFILE_TOP; n++) {
+        s32 best = -1;
+        for (i = 0; i < ksyms_count(); i++) {
+            u32 k = 0;
+            while (k < n && printed[k] != i) {
+                k++;
+            }
+            if (k == n && self_counts[i] > 0
+                && (best < 0 || self_counts[i] > self_counts[best])) {
+                best = (s32) i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        printed[n] = best;
+        printf("%7u %5u %8u  %s\n", self_counts[best], self_counts[best] * 100 / samples,
+               total_counts[best], ksyms_table[best].name);
+    }
+
+    running = was_running;
+}
+
+static s32 cmd_profile(u32 argc, char **argv) {
+    if (argc >= 2 && !strcmp(argv[1], "start")) {
+        // Необязательный аргумент - замер каждые N тиков
+        if (profile_start(argc > 2 ? atoi(argv[2]) : 0) != 0) {
+            colored_print(0x04, "Profiler unavailable: no kernel symbol table\n");
+            return -1;
+        }
+    } else if (argc >= 2 && !strcmp(argv[1], "stop")) {
+        profile_stop();
+    } else if (argc >= 2 && !strcmp(argv[1], "report")) {
+        profile_report();
+    } else {
+        colored_print(0x04, "Usage: profile start [N]|stop|report\n");
+        return -1;
+    }
+    return 0;
+}
+
+COMMAND("profile", cmd_profile, "start [N]|stop|report", "Sampling profiler");
+
+/** @} */ // Конец группы profile
@@ -0,0 +1,18 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "../common.h"
+
+#define PROFILE_DEPTH 4     // Кадров цепочки вызовов на замер (0 - только EIP)
+#define PROFILE_TOP   15    // Строк в отчете
+
+void profile_init();
+s32 profile_start(u32 interval);
+void profile_stop();
+void profile_report();
+
+#endif //PROFILE_H
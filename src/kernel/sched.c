@@ -0,0 +1,484 @@
+/**
+* @file sched.c
+ * @brief Потоки ядра и вытесняющий планировщик с приоритетами
+ *
+ * Периодического тика нет: планировщик сам заказывает прерывание таймера
+ * к ближайшему событию - пробуждению первого спящего или концу кванта,
+ * если квант есть кому отдать. Когда все потоки ждут, процессор стоит в
+ * HLT в потоке простоя до прерывания от устройства.
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup sched Планировщик
+ * @{
+ */
+
+#include "sched.h"
+#include "../string.h"
+#include "../mm/slab.h"
+#include "../drivers/timer.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "../cpu/gdt.h"
+#include "../mm/paging.h"
+#include "command.h"
+
+extern void switch_context(u32 *old_esp, u32 new_esp);
+
+/**
+ * @brief Очереди готовых потоков, по одной на приоритет
+ * @details Бит i в run_bitmap выставлен, если очередь i не пуста, поэтому
+ * выбор следующего потока - одна инструкция BSF независимо от их числа
+ */
+static thread_t *run_head[SCHED_PRIORITIES];
+static thread_t *run_tail[SCHED_PRIORITIES];
+static u32 run_bitmap = 0;
+
+static thread_t boot_thread;        ///< Контекст kmain()
+static thread_t *current = 0;
+static thread_t *idle_thread;
+static thread_t *all_threads;
+static thread_t *sleepers;          ///< Спящие, по возрастанию wake_ns
+static thread_t *zombie;            ///< Завершенный поток, ждет освобождения
+static u32 next_tid = 0;
+static volatile u8 need_resched = 0;
+static u32 context_switches = 0;
+static u64 switch_ns;               ///< Момент последнего переключения
+
+static const char *state_names[] = {"run", "ready", "sleep", "block", "dead"};
+
+static void rq_push(thread_t *thread) {
+    const u32 prio = thread->priority;
+
+    thread->next = 0;
+    thread->prev = run_tail[prio];
+    if (run_tail[prio]) {
+        run_tail[prio]->next = thread;
+    } else {
+        run_head[prio] = thread;
+    }
+    run_tail[prio] = thread;
+    run_bitmap |= 1u << prio;
+}
+
+static thread_t *rq_pop() {
+    u32 prio;
+
+    __asm__("bsf %1, %0" : "=r" (prio) : "rm" (run_bitmap));
+    thread_t *thread = run_head[prio];
+    run_head[prio] = thread->next;
+    if (run_head[prio]) {
+        run_head[prio]->prev = 0;
+    } else {
+        run_tail[prio] = 0;
+        run_bitmap &= ~(1u << prio);
+    }
+    return thread;
+}
+
+/**
+ * @brief Переводит поток в готовые
+ * @note Вызывать при запрещенных прерываниях. Если у текущего потока
+ *       появился сосед того же приоритета, заказывает конец его кванта.
+ *       Простой уступает любому готовому потоку
+ */
+static void make_ready(thread_t *thread) {
+    thread->state = THREAD_READY;
+    rq_push(thread);
+    if (current == 0) {
+        return;
+    }
+    if (current == idle_thread) {
+        need_resched = 1;
+        return;
+    }
+    if (thread->priority < current->priority) {
+        need_resched = 1;
+    } else if (thread->priority == current->priority) {
+        timer_program(current->slice_end);
+    }
+}
+
+/**
+ * @brief Вытесняет текущий поток ближайшим прерыванием таймера
+ * @details Без периодического тика пробуждение более приоритетного потока
+ * из обработчика прерывания иначе ждало бы конца кванта. Поток простоя
+ * проверяет need_resched сам после HLT.
+ * @note Вызывать при запрещенных прерываниях
+ */
+static void preempt_kick() {
+    if (need_resched && current != idle_thread) {
+        timer_program(ktime_ns());
+    }
+}
+
+/**
+ * @brief Завершение переключения в контексте нового потока
+ */
+static void sched_tail() {
+    if (zombie && zombie != current) {
+        kfree(zombie->stack);
+        kfree(zombie);
+        zombie = 0;
+    }
+}
+
+/**
+ * @brief Выбирает следующий поток и переключается на него
+ * @note Вызывать при запрещенных прерываниях. Состояние текущего потока
+ *       выставляет вызывающий: RUNNING - поток остается готовым
+ */
+static void schedule() {
+    thread_t *prev = current;
+    const u64 now = ktime_ns();
+
+    prev->run_ns += now - switch_ns;
+    switch_ns = now;
+    if (prev->state == THREAD_RUNNING) {
+        prev->state = THREAD_READY;
+        rq_push(prev);
+    }
+
+    thread_t *next = rq_pop();
+    next->state = THREAD_RUNNING;
+    need_resched = 0;
+    if (next != prev || next->slice_end <= now) {
+        next->slice_end = now + SCHED_SLICE_MS * 1000000ull;
+    }
+    // Квант имеет смысл ограничивать, только если его есть кому отдать
+    if (next != idle_thread && (run_bitmap & (1u << next->priority))) {
+        timer_program(next->slice_end);
+    }
+    if (next == prev) {
+        return;
+    }
+
+    current = next;
+    if (next->user_esp0) {
+        tss_set_stack(next->user_esp0);
+    }
+    if (next->page_directory != prev->page_directory) {
+        paging_switch(next->page_directory);
+    }
+    next->switches++;
+    context_switches++;
+    switch_context(&prev->esp, next->esp);
+    sched_tail();
+}
+
+/**
+ * @brief Первая функция нового потока (адрес возврата switch_context)
+ */
+static void thread_start() {
+    sched_tail();
+    interrupts_enable(); // Переключение произошло при запрещенных прерываниях
+    current->entry(current->arg);
+    thread_exit();
+}
+
+/**
+ * @brief Поток простоя: спит в HLT, пока никто не готов
+ * @note need_resched проверяется при запрещенных прерываниях, а STI; HLT
+ *       неразрывны: пробуждение между проверкой и HLT не теряется
+ */
+static void idle_loop(void *arg) {
+    while (1) {
+        interrupts_disable();
+        if (!need_resched) {
+            wait_for_interrupt();
+        }
+        interrupts_enable();
+        if (need_resched) {
+            yield();
+        }
+    }
+}
+
+/**
+ * @brief Прерывание таймера: пробуждение спящих, конец кванта
+ * @details Прерывание приходит к сроку, заказанному кем угодно, поэтому
+ * обработчик каждый раз заново заказывает свои ближайшие сроки.
+ */
+static void sched_tick(registers_t *regs) {
+    const u64 now = ktime_ns();
+
+    while (sleepers && sleepers->wake_ns <= now) {
+        thread_t *thread = sleepers;
+        sleepers = thread->next;
+        make_ready(thread);
+    }
+    if (sleepers) {
+        timer_program(sleepers->wake_ns);
+    }
+
+    if (current != idle_thread && (run_bitmap & (1u << current->priority))) {
+        if (current->slice_end <= now) {
+            need_resched = 1;
+        } else {
+            timer_program(current->slice_end);
+        }
+    }
+    if (need_resched) {
+        schedule();
+    }
+}
+
+/**
+ * @brief Запускает планировщик
+ *
+ * Текущий контекст (kmain) становится потоком 0, создается поток простоя,
+ * планировщик подписывается на прерывание таймера. Вызывать после kmalloc_init()
+ * и timer_init().
+ */
+void sched_init() {
+    strcpy(boot_thread.name, "kmain");
+    boot_thread.tid = next_tid++;
+    boot_thread.state = THREAD_RUNNING;
+    boot_thread.priority = SCHED_PRIO_NORMAL;
+    all_threads = &boot_thread;
+    current = &boot_thread;
+    switch_ns = ktime_ns();
+    boot_thread.slice_end = switch_ns + SCHED_SLICE_MS * 1000000ull;
+
+    idle_thread = thread_create("idle", idle_loop, 0, SCHED_PRIO_IDLE);
+    timer_register_hook(sched_tick);
+}
+
+/**
+ * @brief Создает поток ядра
+ * @param[in] name     Имя для ps (обрезается до THREAD_NAME_LEN - 1)
+ * @param[in] entry    Функция потока; возврат из нее завершает поток
+ * @param[in] arg      Аргумент entry
+ * @param[in] priority 0 (высший) .. SCHED_PRIO_IDLE
+ * @return Поток или 0, если не хватило памяти
+ */
+thread_t *thread_create(const char *name, void (*entry)(void *), void *arg, u32 priority) {
+    thread_t *thread = kzalloc(sizeof(thread_t));
+    if (thread == 0) {
+        return 0;
+    }
+    thread->stack = kmalloc(THREAD_STACK_SIZE);
+    if (thread->stack == 0) {
+        kfree(thread);
+        return 0;
+    }
+
+    u32 i;
+    for (i = 0; i < THREAD_NAME_LEN - 1 && name[i]; i++) {
+        thread->name[i] = name[i];
+    }
+    thread->priority = priority < SCHED_PRIORITIES ? priority : SCHED_PRIO_IDLE;
+    thread->entry = entry;
+    thread->arg = arg;
+
+    // Кадр, который снимет switch_context: EDI, ESI, EBX, EBP, адрес возврата
+    u32 *sp = (u32 *) ((u8 *) thread->stack + THREAD_STACK_SIZE);
+    *--sp = 0;                  // Адрес возврата thread_start (не используется)
+    *--sp = (u32) thread_start;
+    *--sp = 0;                  // EBP
+    *--sp = 0;                  // EBX
+    *--sp = 0;                  // ESI
+    *--sp = 0;                  // EDI
+    thread->esp = (u32) sp;
+
+    const u32 flags = irq_save();
+    thread->tid = next_tid++;
+    thread->all_next = all_threads;
+    all_threads = thread;
+    make_ready(thread);
+    preempt_kick();
+    irq_restore(flags);
+    return thread;
+}
+
+/**
+ * @brief Завершает текущий поток
+ * @note Стек освобождается следующим потоком в sched_tail()
+ */
+void thread_exit() {
+    interrupts_disable();
+
+    thread_t **link = &all_threads;
+    while (*link != current) {
+        link = &(*link)->all_next;
+    }
+    *link = current->all_next;
+
+    current->state = THREAD_DEAD;
+    if (current != &boot_thread) {
+        zombie = current;
+    }
+    schedule();
+    while (1) {
+    }
+}
+
+/**
+ * @brief Текущий поток (0 до sched_init())
+ */
+thread_t *thread_current() {
+    return current;
+}
+
+/**
+ * @brief Уступает процессор потокам того же или более высокого приоритета
+ */
+void yield() {
+    if (current == 0) {
+        return;
+    }
+    const u32 flags = irq_save();
+    schedule();
+    irq_restore(flags);
+}
+
+/**
+ * @brief Усыпляет текущий поток до момента until
+ * @param[in] until Момент по ktime_ns()
+ *
+ * @note До sched_init() ждет в HLT, сам заказывая прерывание таймера
+ */
+static void sleep_until(const u64 until) {
+    if (current == 0) {
+        interrupts_disable();
+        while (ktime_ns() < until) {
+            timer_program(until);
+            wait_for_interrupt();
+            interrupts_disable();
+        }
+        interrupts_enable();
+        return;
+    }
+
+    const u32 flags = irq_save();
+    current->wake_ns = until;
+    current->state = THREAD_SLEEPING;
+
+    thread_t **link = &sleepers;
+    while (*link && (*link)->wake_ns <= current->wake_ns) {
+        link = &(*link)->next;
+    }
+    current->next = *link;
+    *link = current;
+    timer_program(until);
+
+    schedule();
+    irq_restore(flags);
+}
+
+/**
+ * @brief Усыпляет текущий поток на короткое время
+ * @param[in] us Микросекунды
+ *
+ * @note Точность - микросекунды в режимах APIC и тик в режиме PIT.
+ *       Вставка в список спящих - O(n), поэтому для длинных ожиданий и
+ *       таймаутов есть msleep() и колесо таймеров (ktimer.c)
+ */
+void usleep(const u32 us) {
+    sleep_until(ktime_ns() + (u64) us * 1000);
+}
+
+/**
+ * @brief Блокирует текущий поток до sched_wake()
+ * @note Вызывать при запрещенных прерываниях после проверки условия,
+ *       иначе пробуждение может прийти раньше блокировки и потеряться
+ */
+void sched_block() {
+    current->state = THREAD_BLOCKED;
+    schedule();
+}
+
+/**
+ * @brief Будит спящий или заблокированный поток
+ * @param[in] thread Поток
+ *
+ * @note Можно вызывать из обработчика прерывания. Переключение на более
+ *       приоритетный поток произойдет в ближайшем прерывании таймера
+ *       (preempt_kick) или в idle
+ */
+void sched_wake(thread_t *thread) {
+    const u32 flags = irq_save();
+
+    if (thread->state == THREAD_SLEEPING) {
+        thread_t **link = &sleepers;
+        while (*link != thread) {
+            link = &(*link)->next;
+        }
+        *link = thread->next;
+    }
+    if (thread->state == THREAD_SLEEPING || thread->state == THREAD_BLOCKED) {
+        make_ready(thread);
+        preempt_kick();
+    }
+
+    irq_restore(flags);
+}
+
+/**
+ * @brief Засыпает в очереди ожидания
+ * @param[in,out] queue Очередь
+ *
+ * @note Вызывать при запрещенных прерываниях сразу после проверки
+ *       условия; возвращается тоже при запрещенных. До sched_init()
+ *       просто ждет ближайшего прерывания.
+ */
+void wait_queue_sleep(wait_queue_t *queue) {
+    if (current == 0) {
+        wait_for_interrupt();
+        interrupts_disable();
+        return;
+    }
+
+    current->next = 0;
+    if (queue->tail) {
+        queue->tail->next = current;
+    } else {
+        queue->head = current;
+    }
+    queue->tail = current;
+    sched_block();
+}
+
+/**
+ * @brief Будит все потоки очереди
+ * @param[in,out] queue Очередь
+ */
+void wait_queue_wake_all(wait_queue_t *queue) {
+    const u32 flags = irq_save();
+    thread_t *thread = queue->head;
+
+    queue->head = 0;
+    queue->tail = 0;
+    while (thread) {
+        thread_t *next = thread->next;
+        sched_wake(thread);
+        thread = next;
+    }
+    irq_restore(flags);
+}
+
+/**
+ * @brief Печатает таблицу потоков (команда ps)
+ */
+void sched_print_threads() {
+    const u32 flags = irq_save();
+    const thread_t *thread;
+
+    printf(" TID PRIO STATE  TIME ms  SWITCH NAME\n");
+    for (thread = all_threads; thread; thread = thread->all_next) {
+        u64 ms = thread->run_ns;
+        div64(&ms, 1000000);
+        printf("%4u %4u %-5s %8llu %7u %s\n", thread->tid, thread->priority,
+               state_names[thread->state], ms, thread->switches, thread->name);
+    }
+    printf("context switches: %u, timer interrupts: %llu\n", context_switches, timer_interrupts());
+    irq_restore(flags);
+}
+
+static s32 cmd_ps(u32 argc, char **argv) {
+    sched_print_threads();
+    return 0;
+}
+
+COMMAND("ps", cmd_ps, "", "Kernel threads");
+
+/** @} */ // Конец группы sched
@@ -0,0 +1,72 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "../common.h"
+
+#define SCHED_PRIORITIES   32   // Уровней приоритета: 0 - высший
+#define SCHED_PRIO_HIGH    8
+#define SCHED_PRIO_NORMAL  16
+#define SCHED_PRIO_LOW     24
+#define SCHED_PRIO_IDLE    (SCHED_PRIORITIES - 1)
+
+#define SCHED_SLICE_MS     50   // Квант времени потока
+#define THREAD_STACK_SIZE  8192
+#define THREAD_NAME_LEN    16
+
+typedef enum {
+    THREAD_RUNNING,
+    THREAD_READY,
+    THREAD_SLEEPING,    // Ждет момента wake_ns
+    THREAD_BLOCKED,     // Ждет sched_wake() / очереди ожидания
+    THREAD_DEAD
+} thread_state_t;
+
+typedef struct thread {
+    u32 esp;                    ///< Сохраненный стек (switch_context)
+    u32 tid;
+    char name[THREAD_NAME_LEN];
+    thread_state_t state;
+    u32 priority;
+    u64 slice_end;              ///< Конец кванта (ktime_ns)
+    u64 wake_ns;                ///< Для THREAD_SLEEPING (ktime_ns)
+    u64 run_ns;                 ///< Сколько поток был текущим
+    u32 switches;               ///< Сколько раз поток получал процессор
+    u32 user_esp0;              ///< Стек ядра для входа из кольца 3, 0 - поток не в нем
+    u32 *page_directory;        ///< Адресное пространство программы, 0 - ядра
+    struct exec_image *image;   ///< Исполняемая программа (exec.c)
+    void *stack;                ///< Стек из kmalloc() (0 у потока kmain)
+    void (*entry)(void *);
+    void *arg;
+    struct thread *next;        ///< Очередь готовых / ожидания / сна
+    struct thread *prev;
+    struct thread *all_next;    ///< Список всех потоков
+} thread_t;
+
+/**
+ * @brief Очередь ожидания: потоки, ждущие одного события
+ */
+typedef struct {
+    thread_t *head;
+    thread_t *tail;
+} wait_queue_t;
+
+void sched_init();
+thread_t *thread_create(const char *name, void (*entry)(void *), void *arg, u32 priority);
+void thread_exit();
+thread_t *thread_current();
+
+void yield();
+void usleep(u32 us);
+void sched_block();
+void sched_wake(thread_t *thread);
+
+void wait_queue_sleep(wait_queue_t *queue);
+void wait_queue_wake_all(wait_queue_t *queue);
+
+void sched_print_threads();
+
+#endif //SCHED_H
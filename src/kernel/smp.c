@@ -0,0 +1,377 @@
+/**
+* @file smp.c
+ * @brief Запуск прикладных процессоров и раздача им заданий
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup smp Многопроцессорность
+ * @{
+ */
+
+#include "smp.h"
+#include "sched.h"
+#include "syscall.h"
+#include "command.h"
+#include "../string.h"
+#include "../cpu/gdt.h"
+#include "../cpu/idt.h"
+#include "../cpu/isr.h"
+#include "../cpu/lapic.h"
+#include "../drivers/acpi.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "../drivers/timer.h"
+#include "../mm/pmm.h"
+#include "../mm/paging.h"
+
+#define SMP_BENCH_LIMIT 1000000     // Простые числа ниже этого для "cpus bench"
+#define SMP_BENCH_CHUNK 4096        // Числа раздаются полосами такой ширины
+
+percpu_t percpu[SMP_MAX_CPUS];
+
+static u32 cpu_count = 1;
+static volatile u32 ap_booting;     ///< Номер AP, которому адресован SIPI
+
+extern u8 trampoline_start[];
+extern u8 trampoline_end[];
+extern u8 trampoline_cr3[];
+extern u8 trampoline_cr4[];
+extern u8 trampoline_stack[];
+extern u8 trampoline_entry[];
+
+static inline u32 read_cr4() {
+    u32 value;
+    __asm__ volatile("mov %%cr4, %0" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr3(const u32 value) {
+    __asm__ volatile("mov %0, %%cr3" : : "r" (value) : "memory");
+}
+
+/**
+ * @brief Поле данных в копии трамплина
+ */
+static u32 *trampoline_field(const u8 *field) {
+    return (u32 *) ((u8 *) PHYS_TO_VIRT(TRAMPOLINE_ADDR) + (field - trampoline_start));
+}
+
+/**
+ * @brief Обработчик IPI_CALL_VECTOR
+ * @note Сам по себе ничего не делает: IPI нужно, чтобы вывести AP из hlt,
+ *       задание забирает цикл ap_idle()
+ */
+static void ipi_call_callback(registers_t *regs) {
+    this_cpu()->ipis++;
+}
+
+/**
+ * @brief Цикл AP: выполняет задания smp_call(), в остальное время спит
+ *
+ * @note Проверка задания и засыпание идут при запрещенных прерываниях, а
+ *       STI действует только после следующей инструкции: IPI, пришедшее
+ *       между проверкой и HLT, разбудит процессор, а не потеряется
+ */
+static void ap_idle(percpu_t *pc) {
+    while (1) {
+        interrupts_disable();
+        const smp_fn_t fn = pc->call_fn;
+        if (fn == 0) {
+            __asm__ volatile("sti; hlt" : : : "memory");
+            continue;
+        }
+        interrupts_enable();
+
+        fn(pc->call_arg);
+        pc->calls++;
+        pc->call_fn = 0;
+        __asm__ volatile("" : : : "memory");
+        pc->call_busy = 0;
+    }
+}
+
+/**
+ * @brief Точка входа AP из трамплина
+ * @details Процессор уже в защищенном режиме со страничной адресацией на
+ * временном каталоге и на собственном стеке. Здесь он переходит на каталог
+ * ядра, загружает свою GDT (с ней - %gs), общую IDT и включает свой APIC.
+ */
+static void ap_main() {
+    percpu_t *pc = &percpu[ap_booting];
+
+    write_cr3(VIRT_TO_PHYS(paging_kernel_directory()));
+    gdt_init_cpu(pc->id);
+    load_idt();
+    syscall_init_cpu(pc->id);
+    lapic_enable();
+
+    pc->online = 1;
+    ap_idle(pc);
+}
+
+/**
+ * @brief Будит один AP последовательностью INIT-SIPI-SIPI
+ * @param[in] id      Номер, который получит процессор
+ * @param[in] apic_id APIC ID из MADT
+ * @return 0 или -1, если процессор не отметился за SMP_AP_TIMEOUT_MS
+ *
+ * @note Задержки - по Intel MultiProcessor Specification: 10 мс после INIT,
+ *       200 мкс после каждого SIPI. Второй SIPI уже запущенный процессор
+ *       игнорирует
+ */
+static s32 smp_boot_ap(const u32 id, const u32 apic_id) {
+    percpu_t *pc = &percpu[id];
+    const u32 stack = alloc_pages(SMP_STACK_ORDER);
+    u32 i;
+
+    if (stack == 0) {
+        return -1;
+    }
+    pc->id = id;
+    pc->apic_id = apic_id;
+    pc->stack = (u32) PHYS_TO_VIRT(stack) + (PAGE_SIZE << SMP_STACK_ORDER);
+
+    *trampoline_field(trampoline_stack) = pc->stack;
+    ap_booting = id;
+
+    lapic_send_ipi(apic_id, ICR_INIT | ICR_LEVEL | ICR_ASSERT);
+    udelay(10000);
+    for (i = 0; i < 2 && !pc->online; i++) {
+        lapic_send_ipi(apic_id, ICR_STARTUP | (TRAMPOLINE_ADDR >> PAGE_SHIFT));
+        udelay(200);
+    }
+    for (i = 0; i < SMP_AP_TIMEOUT_MS && !pc->online; i++) {
+        udelay(1000);
+    }
+
+    // Стек не освобождается: процессор мог проснуться позже и уже на нем
+    return pc->online ? 0 : -1;
+}
+
+/**
+ * @brief Находит процессоры в MADT и запускает их
+ *
+ * Трамплин копируется в первый мегабайт, для него строится временный
+ * каталог страниц. AP запускаются по одному, потому что делят трамплин
+ * (поле стека) и ap_booting.
+ *
+ * @note Вызывать до interrupts_enable(): udelay() не зависит от прерываний.
+ *       Без APIC или MADT система остается однопроцессорной. Планировщик
+ *       по-прежнему работает только на загрузочном процессоре; AP
+ *       выполняют то, что им поручено через smp_call()
+ */
+void smp_init() {
+    acpi_madt_info_t madt;
+    u32 i;
+
+    percpu[0].online = 1;
+    if (acpi_init() != 0 || acpi_parse_madt(&madt) != 0) {
+        madt.lapic_address = 0;
+        madt.cpu_count = 0;
+    }
+    if (lapic_init(madt.lapic_address) != 0) {
+        return;
+    }
+    percpu[0].apic_id = lapic_id();
+    register_interrupt_handler(IPI_CALL_VECTOR, ipi_call_callback);
+
+    if (madt.cpu_count < 2) {
+        return;
+    }
+
+    const u32 directory = alloc_page();
+    if (directory == 0) {
+        return;
+    }
+    u32 *pd = PHYS_TO_VIRT(directory);
+    memcpy(pd, paging_kernel_directory(), PAGE_SIZE);
+    pd[0] = PTE_PRESENT | PTE_WRITE | PDE_LARGE; // Трамплин: первые 4 MB как есть
+
+    memcpy(PHYS_TO_VIRT(TRAMPOLINE_ADDR), trampoline_start, trampoline_end - trampoline_start);
+    *trampoline_field(trampoline_cr3) = directory;
+    *trampoline_field(trampoline_cr4) = read_cr4();
+    *trampoline_field(trampoline_entry) = (u32) ap_main;
+
+    u8 failed = 0;
+    for (i = 0; i < madt.cpu_count && cpu_count < SMP_MAX_CPUS; i++) {
+        if (madt.apic_ids[i] == percpu[0].apic_id) {
+            continue;
+        }
+        if (smp_boot_ap(cpu_count, madt.apic_ids[i]) == 0) {
+            cpu_count++;
+        } else {
+            colored_print(0x04, "smp: CPU with APIC ID %u did not start\n", madt.apic_ids[i]);
+            failed = 1;
+        }
+    }
+
+    // Опоздавший процессор еще может пройти через временный каталог
+    if (!failed) {
+        free_page(directory);
+    }
+}
+
+/**
+ * @brief Число работающих процессоров
+ */
+u32 smp_cpu_count() {
+    return cpu_count;
+}
+
+/**
+ * @brief Поручает процессору выполнить fn(arg)
+ * @param[in] cpu Номер AP (1..smp_cpu_count() - 1)
+ * @param[in] fn  Функция; выполняется вне планировщика, поэтому не должна
+ *                спать и ждать событий, но может брать спин-блокировки
+ *                (печать, kmalloc)
+ * @param[in] arg Аргумент
+ * @return 0 или -1, если такого AP нет
+ *
+ * @note Если процессор занят предыдущим заданием, ждет его окончания.
+ *       Слот занимается атомарно, поэтому вызывать можно из любого потока
+ */
+s32 smp_call(const u32 cpu, const smp_fn_t fn, void *arg) {
+    if (cpu == 0 || cpu >= cpu_count) {
+        return -1;
+    }
+
+    percpu_t *pc = &percpu[cpu];
+    while (!__sync_bool_compare_and_swap(&pc->call_busy, 0, 1)) {
+        yield();
+    }
+    pc->call_arg = arg;
+    __asm__ volatile("" : : : "memory");
+    pc->call_fn = fn;
+    lapic_send_ipi(pc->apic_id, ICR_FIXED | IPI_CALL_VECTOR);
+    return 0;
+}
+
+/**
+ * @brief Ждет, пока процессор выполнит задание
+ * @note Уступает процессор другим потокам, пока ждет
+ */
+void smp_wait(const u32 cpu) {
+    if (cpu >= cpu_count) {
+        return;
+    }
+    while (percpu[cpu].call_busy) {
+        yield();
+    }
+}
+
+/**
+ * @brief Задание "cpus bench": простые числа в полосах first, first + step, ...
+ */
+typedef struct {
+    u32 first;
+    u32 step;
+    u32 found;
+} prime_job_t;
+
+static u8 is_prime(const u32 n) {
+    u32 d;
+
+    if (n < 4) {
+        return n >= 2;
+    }
+    if (n % 2 == 0) {
+        return 0;
+    }
+    for (d = 3; d * d <= n; d += 2) {
+        if (n % d == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void count_primes(void *arg) {
+    prime_job_t *job = arg;
+    u32 chunk, n;
+    u32 found = 0;
+
+    for (chunk = job->first; chunk * SMP_BENCH_CHUNK < SMP_BENCH_LIMIT; chunk += job->step) {
+        const u32 end = (chunk + 1) * SMP_BENCH_CHUNK;
+        for (n = chunk * SMP_BENCH_CHUNK; n < end && n < SMP_BENCH_LIMIT; n++) {
+            found += is_prime(n);
+        }
+    }
+    job->found = found;
+}
+
+/**
+ * @brief Считает простые числа на cpus процессорах
+ * @param[in] cpus Участников, включая текущий (загрузочный) процессор
+ * @param[out] found Найдено простых (для проверки: не зависит от cpus)
+ * @return Время в микросекундах
+ */
+static u64 smp_bench_run(const u32 cpus, u32 *found) {
+    static prime_job_t jobs[SMP_MAX_CPUS];
+    u32 i;
+
+    for (i = 0; i < cpus; i++) {
+        jobs[i].first = i;
+        jobs[i].step = cpus;
+        jobs[i].found = 0;
+    }
+
+    const u64 start = ktime_ns();
+    for (i = 1; i < cpus; i++) {
+        smp_call(i, count_primes, &jobs[i]);
+    }
+    count_primes(&jobs[0]);
+    for (i = 1; i < cpus; i++) {
+        smp_wait(i);
+    }
+    u64 us = ktime_ns() - start;
+    div64(&us, 1000);
+
+    *found = 0;
+    for (i = 0; i < cpus; i++) {
+        *found += jobs[i].found;
+    }
+    return us;
+}
+
+/**
+ * @brief Печатает таблицу процессоров
+ */
+static void smp_print_cpus() {
+    u32 i;
+
+    printf("CPU APIC STATE     CALLS   IPIS\n");
+    for (i = 0; i < cpu_count; i++) {
+        const percpu_t *pc = &percpu[i];
+        printf("%3u %4u %-6s %8u %6u\n", i, pc->apic_id, i == 0 ? "boot" : "online",
+               pc->calls, pc->ipis);
+    }
+    printf("local APIC: %s\n", lapic_present() ? "enabled" : "not found");
+}
+
+static s32 cmd_cpus(u32 argc, char **argv) {
+    if (argc == 1) {
+        smp_print_cpus();
+        return 0;
+    }
+    if (strcmp(argv[1], "bench") != 0) {
+        colored_print(0x04, "Usage: cpus [bench]\n");
+        return -1;
+    }
+
+    u32 found;
+    const u64 one = smp_bench_run(1, &found);
+    printf("primes below %u: %u\n", SMP_BENCH_LIMIT, found);
+    printf("1 CPU:  %llu us\n", one);
+    if (cpu_count > 1) {
+        const u64 all = smp_bench_run(cpu_count, &found);
+        u64 speedup = one * 100;
+        div64(&speedup, all ? (u32) all : 1);
+        const u32 frac = div64(&speedup, 100);
+        printf("%u CPUs: %llu us, speedup x%llu.%02u (%u primes)\n", cpu_count, all,
+               speedup, frac, found);
+    }
+    return 0;
+}
+
+COMMAND("cpus", cmd_cpus, "[bench]", "Processors and parallel prime count");
+
+/** @} */ // Конец группы smp
@@ -0,0 +1,64 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SMP_H
+#define SMP_H
+
+#include "../common.h"
+
+#define SMP_MAX_CPUS       8        // Процессоров, которые запускает smp_init()
+#define SMP_STACK_ORDER    1        // Стек AP: 2^1 страниц = 8 KB
+#define SMP_AP_TIMEOUT_MS  100      // Сколько ждать отметки AP о запуске
+#define TRAMPOLINE_ADDR    0x8000   // Трамплин (cpu/trampoline.asm), вектор SIPI 0x08
+
+typedef void (*smp_fn_t)(void *arg);
+
+/**
+ * @brief Данные одного процессора
+ * @details Сегмент GDT_PERCPU каждого процессора начинается с его записи,
+ * поэтому %gs:0 - указатель на собственную запись, а поля читаются одной
+ * инструкцией без номера процессора. Запись выровнена на строку кэша:
+ * процессоры не делят строки, в которые пишут.
+ */
+typedef struct percpu {
+    struct percpu *self;        // %gs:0
+    u32 id;                     // Порядковый номер: 0 - загрузочный процессор
+    u32 apic_id;
+    volatile u32 online;        // AP дошел до ap_main()
+    u32 stack;                  // Вершина стека (для AP)
+    volatile u32 call_busy;     // Слот задания занят (от smp_call() до выполнения)
+    volatile smp_fn_t call_fn;  // Задание от smp_call(), 0 - нет
+    void *call_arg;
+    u32 calls;                  // Выполнено заданий
+    u32 ipis;                   // Принято IPI_CALL_VECTOR
+} __attribute__((aligned(64))) percpu_t;
+
+extern percpu_t percpu[SMP_MAX_CPUS];
+
+/**
+ * @brief Запись текущего процессора
+ */
+static inline percpu_t *this_cpu() {
+    percpu_t *self;
+    __asm__ volatile("mov %%gs:0, %0" : "=r" (self));
+    return self;
+}
+
+/**
+ * @brief Номер текущего процессора (0..smp_cpu_count() - 1)
+ * @note Потоки планировщика живут только на загрузочном процессоре и
+ *       не мигрируют, поэтому прочитанный номер не устаревает
+ */
+static inline u32 smp_cpu_id() {
+    u32 id;
+    __asm__ volatile("mov %%gs:%c1, %0" : "=r" (id) : "i" (__builtin_offsetof(percpu_t, id)));
+    return id;
+}
+
+void smp_init();
+u32 smp_cpu_count();
+s32 smp_call(u32 cpu, smp_fn_t fn, void *arg);
+void smp_wait(u32 cpu);
+
+#endif //SMP_H
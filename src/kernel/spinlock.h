@@ -0,0 +1,68 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include "../common.h"
+#include "../drivers/asm_io.h"
+
+/**
+ * @brief Билетная спин-блокировка
+ * @details Захватывающий берет билет (next++) атомарным LOCK XADD и ждет,
+ * пока owner не дойдет до его номера. Процессоры получают блокировку
+ * строго в порядке очереди, поэтому ни один из них не голодает, а
+ * ожидающие только читают owner и не гоняют строку кэша записью.
+ * Нулевая структура - свободная блокировка.
+ */
+typedef struct {
+    volatile u16 owner;     ///< Билет, который сейчас обслуживается
+    volatile u16 next;      ///< Следующий свободный билет
+} spinlock_t;
+
+#define SPINLOCK_INIT {0, 0}
+
+/**
+ * @brief Захватывает блокировку
+ * @warning Не запрещает прерываний: если блокировку берет и обработчик
+ *          прерывания, используйте spin_lock_irqsave()
+ */
+static inline void spin_lock(spinlock_t *lock) {
+    u16 ticket = 1;
+
+    __asm__ volatile("lock xaddw %0, %1" : "+r" (ticket), "+m" (lock->next) : : "memory");
+    while (lock->owner != ticket) {
+        __asm__ volatile("pause" : : : "memory");
+    }
+}
+
+/**
+ * @brief Освобождает блокировку
+ * @note Обычной записи достаточно: на x86 запись не обгоняет предыдущие
+ *       обращения к памяти, а менять owner может только владелец
+ */
+static inline void spin_unlock(spinlock_t *lock) {
+    __asm__ volatile("" : : : "memory");
+    lock->owner = lock->owner + 1;
+}
+
+/**
+ * @brief Запрещает прерывания на своем процессоре и захватывает блокировку
+ * @return Сохраненный EFLAGS для spin_unlock_irqrestore()
+ */
+static inline u32 spin_lock_irqsave(spinlock_t *lock) {
+    const u32 flags = irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+/**
+ * @brief Освобождает блокировку и восстанавливает флаг прерываний
+ */
+static inline void spin_unlock_irqrestore(spinlock_t *lock, const u32 flags) {
+    spin_unlock(lock);
+    irq_restore(flags);
+}
+
+#endif //SPINLOCK_H
@@ -0,0 +1,167 @@
+/**
+* @file syscall.c
+ * @brief Системные вызовы: таблица, вход через SYSENTER и int 0x80
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup syscall Системные вызовы
+ * @{
+ */
+
+#include "syscall.h"
+#include "user.h"
+#include "sched.h"
+#include "ktimer.h"
+#include "../string.h"
+#include "../cpu/idt.h"
+#include "../cpu/isr.h"
+#include "../cpu/gdt.h"
+#include "../cpu/msr.h"
+#include "../cpu/cpuid.h"
+#include "../mm/pmm.h"
+#include "../drivers/print.h"
+#include "../drivers/screen.h"
+#include "../drivers/serial.h"
+#include "command.h"
+
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+extern u32 isr_stub_table[ISR_STUB_COUNT];
+extern void sysenter_entry();
+extern u8 user_bench_start[];
+extern u8 user_bench_end[];
+
+static u8 sysenter_ok = 0;      ///< Процессор поддерживает SYSENTER/SYSEXIT
+
+static s32 sys_exit(const u32 code, const u32 a2, const u32 a3) {
+    user_exit_current((s32) code);
+    return 0;
+}
+
+static s32 sys_write(const u32 buf, const u32 len, const u32 a3) {
+    if (!user_access_ok(buf, len)) {
+        return -1;
+    }
+    screen_write((const char *) buf, len, GREEN_ON_BLACK);
+    serial_write((const char *) buf, len);
+    return (s32) len;
+}
+
+static s32 sys_gettid(const u32 a1, const u32 a2, const u32 a3) {
+    return (s32) thread_current()->tid;
+}
+
+static s32 sys_sleep(const u32 ms, const u32 a2, const u32 a3) {
+    msleep(ms);
+    return 0;
+}
+
+/**
+ * @brief Таблица вызовов: номер - индекс, пустая запись - ENOSYS
+ */
+static const syscall_t syscall_table[SYS_COUNT] = {
+    [SYS_EXIT] = sys_exit,
+    [SYS_WRITE] = sys_write,
+    [SYS_GETTID] = sys_gettid,
+    [SYS_SLEEP] = sys_sleep,
+};
+
+/**
+ * @brief Общая часть обоих путей входа
+ * @param[in] num Номер вызова (EAX)
+ * @return Результат для EAX, -1 для неизвестного номера
+ */
+s32 syscall_dispatch(const u32 num, const u32 a1, const u32 a2, const u32 a3) {
+    if (num >= SYS_COUNT || syscall_table[num] == 0) {
+        return -1;
+    }
+    return syscall_table[num](a1, a2, a3);
+}
+
+/**
+ * @brief Вход через int 0x80: аргументы и результат - в кадре прерывания
+ */
+static void syscall_interrupt(registers_t *regs) {
+    regs->eax = (u32) syscall_dispatch(regs->eax, regs->ebx, regs->esi, regs->edi);
+}
+
+/**
+ * @brief Настраивает SYSENTER на своем процессоре
+ * @param[in] cpu Номер процессора
+ *
+ * SYSENTER берет CS из MSR_SYSENTER_CS (SS - следующий селектор), а ESP
+ * - прямо из MSR. Стек ядра у каждого потока свой, поэтому в MSR лежит
+ * адрес поля esp0 в TSS процессора: точка входа первой инструкцией
+ * переходит на стек, который туда положил планировщик.
+ */
+void syscall_init_cpu(const u32 cpu) {
+    if (!sysenter_ok) {
+        return;
+    }
+    wrmsr(MSR_SYSENTER_CS, GDT_KERNEL_CODE);
+    wrmsr(MSR_SYSENTER_ESP, tss_stack_slot(cpu));
+    wrmsr(MSR_SYSENTER_EIP, (u32) sysenter_entry);
+}
+
+/**
+ * @brief Открывает int 0x80 для кольца 3 и включает SYSENTER
+ *
+ * @note Шлюз int 0x80 - ловушка: прерывания во время вызова не запрещены.
+ *       Вызывать после isr_install() и gdt_init(); AP вызывают
+ *       syscall_init_cpu() сами
+ */
+void syscall_init() {
+    set_idt_gate(SYSCALL_VECTOR, isr_stub_table[SYSCALL_VECTOR], IDT_GATE_TRAP32_USER);
+    register_interrupt_handler(SYSCALL_VECTOR, syscall_interrupt);
+
+    sysenter_ok = (cpuid_features_edx() & (CPUID_FEAT_EDX_SEP | CPUID_FEAT_EDX_MSR))
+                  == (CPUID_FEAT_EDX_SEP | CPUID_FEAT_EDX_MSR);
+    syscall_init_cpu(0);
+}
+
+/**
+ * @brief Сравнивает стоимость int 0x80 и SYSENTER из кольца 3
+ *
+ * Программа user_bench (syscall.asm) копируется на страницу пользователя
+ * и выполняет SYSCALL_BENCH_ITERS вызовов SYS_GETTID каждым путем. Такты
+ * она оставляет на вершине своего стека, откуда их читает ядро.
+ */
+static s32 cmd_sysbench(u32 argc, char **argv) {
+    const u32 size = user_bench_end - user_bench_start;
+    const u32 stack = USER_STACK_TOP - PAGE_SIZE;
+
+    if (user_map(USER_BASE, size, PTE_WRITE) != 0 || user_map(stack, PAGE_SIZE, PTE_WRITE) != 0) {
+        user_unmap(USER_BASE, size);
+        colored_print(0x04, "sysbench: out of memory\n");
+        return -1;
+    }
+    memcpy((void *) USER_BASE, user_bench_start, size);
+
+    u32 *results = (u32 *) (USER_STACK_TOP - 16);
+    results[0] = sysenter_ok;
+    const s32 code = user_run(USER_BASE, (u32) results);
+
+    u64 int80 = ((u64) results[1] << 32) | results[0];
+    u64 sysenter = ((u64) results[3] << 32) | results[2];
+    user_unmap(USER_BASE, size);
+    user_unmap(stack, PAGE_SIZE);
+    if (code != 0) {
+        colored_print(0x04, "sysbench: user program failed (%d)\n", code);
+        return -1;
+    }
+
+    div64(&int80, SYSCALL_BENCH_ITERS);
+    printf("int 0x80: %llu cycles/call\n", int80);
+    if (sysenter_ok) {
+        div64(&sysenter, SYSCALL_BENCH_ITERS);
+        printf("sysenter: %llu cycles/call\n", sysenter);
+    } else {
+        printf("sysenter: not supported\n");
+    }
+    return 0;
+}
+
+COMMAND("sysbench", cmd_sysbench, "", "Compare int 0x80 and SYSENTER cost");
+
+/** @} */ // Конец группы syscall
@@ -0,0 +1,32 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include "../common.h"
+
+/**
+ * Соглашение о вызовах: номер в EAX, аргументы в EBX, ESI, EDI, результат
+ * в EAX. Через int 0x80 остальные регистры сохраняются. Для SYSENTER
+ * программа кладет в ECX свой ESP, а в EDX адрес возврата - их
+ * использует SYSEXIT, поэтому ECX и EDX не сохраняются.
+ */
+#define SYSCALL_VECTOR 0x80
+
+#define SYS_EXIT    0       // (код)
+#define SYS_WRITE   1       // (буфер, длина) -> записано байт
+#define SYS_GETTID  2       // () -> номер потока
+#define SYS_SLEEP   3       // (мс)
+#define SYS_COUNT   4
+
+#define SYSCALL_BENCH_ITERS 10000 // Должен совпадать с syscall.asm
+
+typedef s32 (*syscall_t)(u32 a1, u32 a2, u32 a3);
+
+void syscall_init();
+void syscall_init_cpu(u32 cpu);
+s32 syscall_dispatch(u32 num, u32 a1, u32 a2, u32 a3);
+
+#endif //SYSCALL_H
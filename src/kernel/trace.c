@@ -0,0 +1,147 @@
+/**
+* @file trace.c
+ * @brief Кольцевой буфер трассировки с метками TSC
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup trace Трассировка
+ * @{
+ */
+
+#include "trace.h"
+#include "../string.h"
+#include "../cpu/tsc.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "../drivers/timer.h"
+#include "command.h"
+
+/**
+ * @brief Кольцо одного процессора
+ * @details head только растет; запись i лежит в слоте i % TRACE_RING_SIZE,
+ * новые записи затирают самые старые
+ */
+typedef struct {
+    trace_record_t records[TRACE_RING_SIZE];
+    u32 head;
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_MAX_CPUS];
+
+u32 trace_mask = TRACE_CAT_DEFAULT;
+
+/**
+ * @brief Имя события для расшифровки
+ */
+static const char *trace_name(const u16 event) {
+    switch (event) {
+        case TRACE_BOOT_STAGE: return "boot";
+        case TRACE_PUTCHAR: return "putchar";
+        case TRACE_SCROLL_BEGIN: return "scroll>";
+        case TRACE_SCROLL_END: return "scroll<";
+        case TRACE_GETCHAR: return "getchar";
+        default: return "?";
+    }
+}
+
+/**
+ * @brief Добавляет запись (вызывается из TRACE_EVENT)
+ * @param[in] event Идентификатор события
+ * @param[in] a0,a1,a2 Данные события
+ *
+ * @note Безопасна в обработчиках прерываний: слот занимается при
+ *       запрещенных прерываниях. Каждый процессор пишет только в свое
+ *       кольцо, поэтому блокировок между процессорами нет
+ */
+void trace_record(const u16 event, const u32 a0, const u32 a1, const u32 a2) {
+    const u32 flags = irq_save();
+    const u32 cpu = smp_cpu_id();
+    trace_ring_t *ring = &rings[cpu];
+    trace_record_t *rec = &ring->records[ring->head++ & (TRACE_RING_SIZE - 1)];
+
+    rec->tsc = rdtsc();
+    rec->event = event;
+    rec->cpu = cpu;
+    rec->args[0] = a0;
+    rec->args[1] = a1;
+    rec->args[2] = a2;
+    irq_restore(flags);
+}
+
+/**
+ * @brief Очищает кольца всех процессоров
+ */
+void trace_clear() {
+    const u32 flags = irq_save();
+    u32 cpu;
+
+    for (cpu = 0; cpu < TRACE_MAX_CPUS; cpu++) {
+        rings[cpu].head = 0;
+    }
+    irq_restore(flags);
+}
+
+/**
+ * @brief Печатает содержимое колец от старых записей к новым
+ *
+ * Время выводится в микросекундах от первой записи и от предыдущей:
+ * разница между scroll> и scroll< - длительность прокрутки. Вывод идет
+ * через printf, то есть и в COM1. На время печати трассировка
+ * выключается, чтобы дамп не записывал сам себя.
+ */
+void trace_dump() {
+    const u32 saved_mask = trace_mask;
+    u32 cpu;
+
+    trace_mask = 0;
+    for (cpu = 0; cpu < smp_cpu_count(); cpu++) {
+        const trace_ring_t *ring = &rings[cpu];
+        const u32 head = ring->head;
+        const u32 count = head < TRACE_RING_SIZE ? head : TRACE_RING_SIZE;
+        u32 i;
+
+        printf("cpu %u: %u records (%u lost)\n", cpu, count, head - count);
+        printf("     at us    +us event    data\n");
+        if (count == 0) {
+            continue;
+        }
+
+        const u64 first = ring->records[(head - count) & (TRACE_RING_SIZE - 1)].tsc;
+        u64 prev = first;
+        for (i = head - count; i != head; i++) {
+            const trace_record_t *rec = &ring->records[i & (TRACE_RING_SIZE - 1)];
+            u64 at = cycles_to_ns(rec->tsc - first);
+            u64 delta = cycles_to_ns(rec->tsc - prev);
+            div64(&at, 1000);
+            div64(&delta, 1000);
+            prev = rec->tsc;
+
+            printf("%10llu %8llu %-8s ", at, delta, trace_name(rec->event));
+            if (rec->event == TRACE_BOOT_STAGE) {
+                printf("%s\n", (const char *) rec->args[0]);
+            } else {
+                printf("%x %x %x\n", rec->args[0], rec->args[1], rec->args[2]);
+            }
+        }
+    }
+    trace_mask = saved_mask;
+}
+
+static s32 cmd_trace(u32 argc, char **argv) {
+    if (argc == 1) {
+        trace_dump();
+    } else if (!strcmp(argv[1], "on")) {
+        trace_mask = TRACE_CAT_ALL;
+    } else if (!strcmp(argv[1], "off")) {
+        trace_mask = 0;
+    } else if (!strcmp(argv[1], "clear")) {
+        trace_clear();
+    } else {
+        colored_print(0x04, "Usage: trace [on|off|clear]\n");
+        return -1;
+    }
+    return 0;
+}
+
+COMMAND("trace", cmd_trace, "[on|off|clear]", "Dump or control the trace ring");
+
+/** @} */ // Конец группы trace
@@ -0,0 +1,73 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "../common.h"
+#include "smp.h"
+
+#define TRACE_RING_SIZE 4096    // Записей в кольце (степень двойки)
+#define TRACE_MAX_CPUS  SMP_MAX_CPUS // Кольцо на каждый процессор
+
+/**
+ * Категории событий: маска trace_mask включает их по отдельности.
+ * По умолчанию пишутся только этапы загрузки и ввод - редкие события,
+ * которые не вытесняют друг друга из кольца.
+ */
+#define TRACE_CAT_BOOT    0x01
+#define TRACE_CAT_CONSOLE 0x02
+#define TRACE_CAT_INPUT   0x04
+#define TRACE_CAT_ALL     0xFF
+#define TRACE_CAT_DEFAULT (TRACE_CAT_BOOT | TRACE_CAT_INPUT)
+
+/**
+ * Идентификатор события: категория в старшем байте.
+ * Имена для расшифровки - в trace.c (trace_name()).
+ */
+typedef enum {
+    TRACE_BOOT_STAGE   = (TRACE_CAT_BOOT << 8) | 0,    // a0 - имя этапа (const char *)
+    TRACE_PUTCHAR      = (TRACE_CAT_CONSOLE << 8) | 0, // a0 - символ, a1 - позиция курсора
+    TRACE_SCROLL_BEGIN = (TRACE_CAT_CONSOLE << 8) | 1, // a0 - origin
+    TRACE_SCROLL_END   = (TRACE_CAT_CONSOLE << 8) | 2, // a0 - origin
+    TRACE_GETCHAR      = (TRACE_CAT_INPUT << 8) | 0,   // a0 - символ
+} trace_event_t;
+
+/**
+ * @brief Запись трассы: фиксированные 24 байта
+ */
+typedef struct {
+    u64 tsc;
+    u16 event;
+    u16 cpu;
+    u32 args[3];
+} __attribute__((packed)) trace_record_t;
+
+extern u32 trace_mask;
+
+void trace_record(u16 event, u32 a0, u32 a1, u32 a2);
+void trace_clear();
+void trace_dump();
+
+#ifndef NO_TRACE
+/**
+ * Точка трассировки. Выключенная категория стоит одного сравнения с
+ * переходом, который предсказатель быстро выучивает как "не взят";
+ * с -DNO_TRACE точки исчезают из кода совсем.
+ */
+#define TRACE_EVENT(event, a0, a1, a2) \
+    do { \
+        if (__builtin_expect(trace_mask & ((event) >> 8), 0)) { \
+            trace_record((event), (u32) (a0), (u32) (a1), (u32) (a2)); \
+        } \
+    } while (0)
+#else
+#define TRACE_EVENT(event, a0, a1, a2) do { } while (0)
+#endif
+
+#define TRACE_EVENT0(event) TRACE_EVENT(event, 0, 0, 0)
+#define TRACE_EVENT1(event, a0) TRACE_EVENT(event, a0, 0, 0)
+#define TRACE_EVENT2(event, a0, a1) TRACE_EVENT(event, a0, a1, 0)
+
+#endif //TRACE_H
@@ -0,0 +1,140 @@
+/**
+* @file user.c
+ * @brief Пользовательский режим: страницы программы, вход в кольцо 3 и выход
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup user Пользовательский режим
+ * @{
+ */
+
+#include "user.h"
+#include "sched.h"
+#include "exec.h"
+#include "../string.h"
+#include "../mm/pmm.h"
+#include "../drivers/print.h"
+
+/**
+ * @brief Переход в кольцо 3 (syscall.asm)
+ * @param[in]  eip        Точка входа программы
+ * @param[in]  esp        Вершина стека программы
+ * @param[out] kernel_esp Сюда сохраняется стек ядра для user_exit()
+ * @return Код, переданный в user_exit()
+ */
+extern s32 user_enter(u32 eip, u32 esp, u32 *kernel_esp);
+
+/**
+ * @brief Возврат из user_enter() на сохраненный стек ядра (syscall.asm)
+ */
+extern void user_exit(u32 kernel_esp, s32 code);
+
+/**
+ * @brief Отображает обнуленные страницы пользователя
+ * @param[in] virt  Начало (выравнивается вниз до страницы)
+ * @param[in] size  Размер в байтах
+ * @param[in] flags PTE_WRITE и т.п.; PTE_USER добавляется всегда
+ * @return 0 или -1 (нет памяти или диапазон задевает ядро); при ошибке
+ *         уже отображенные страницы снимаются
+ */
+s32 user_map(const u32 virt, const u32 size, const u32 flags) {
+    const u32 start = PAGE_ALIGN_DOWN(virt);
+    const u32 end = PAGE_ALIGN_UP(virt + size);
+    u32 page;
+
+    if (end > USER_STACK_TOP || end < start) {
+        return -1;
+    }
+    for (page = start; page < end; page += PAGE_SIZE) {
+        const u32 phys = alloc_page();
+        if (phys == 0 || map_page(page, phys, flags | PTE_USER) != 0) {
+            if (phys) {
+                free_page(phys);
+            }
+            user_unmap(start, page - start);
+            return -1;
+        }
+        memset(PHYS_TO_VIRT(phys), 0, PAGE_SIZE);
+    }
+    return 0;
+}
+
+/**
+ * @brief Снимает страницы пользователя и освобождает их
+ * @param[in] virt Начало (выравнивается вниз до страницы)
+ * @param[in] size Размер в байтах
+ */
+void user_unmap(const u32 virt, const u32 size) {
+    const u32 end = PAGE_ALIGN_UP(virt + size);
+    u32 page;
+
+    for (page = PAGE_ALIGN_DOWN(virt); page < end; page += PAGE_SIZE) {
+        const u32 phys = paging_translate(page);
+        if (phys) {
+            unmap_page(page);
+            free_page(PAGE_ALIGN_DOWN(phys));
+        }
+    }
+}
+
+/**
+ * @brief Проверяет буфер, переданный системному вызову
+ * @return 1, если весь диапазон ниже ядра и отображен, иначе 0
+ *
+ * @note Без проверки ядро по указателю программы прочитало бы свою память
+ *       или упало бы на неотображенной странице. Еще не подкачанные
+ *       страницы программы подкачиваются здесь же
+ */
+s32 user_access_ok(const u32 addr, const u32 size) {
+    u32 page;
+
+    if (addr + size < addr || addr + size > USER_STACK_TOP || addr < USER_BASE) {
+        return 0;
+    }
+    for (page = PAGE_ALIGN_DOWN(addr); page < addr + size; page += PAGE_SIZE) {
+        if (paging_translate(page) == 0 && exec_page_fault(page, 0, 1) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Исполняет код в кольце 3 до системного вызова exit
+ * @param[in] entry Точка входа (страницы уже отображены с PTE_USER)
+ * @param[in] esp   Вершина стека программы
+ * @return Код завершения или -1, если поток уже исполняет программу
+ *
+ * @note Прерывания и системные вызовы из кольца 3 приходят на стек ядра
+ *       текущего потока ниже кадра user_enter(); планировщик переключает
+ *       esp0 в TSS по thread_t.user_esp0
+ */
+s32 user_run(const u32 entry, const u32 esp) {
+    thread_t *self = thread_current();
+
+    if (self == 0 || self->user_esp0) {
+        return -1;
+    }
+    const s32 code = user_enter(entry, esp, &self->user_esp0);
+    self->user_esp0 = 0;
+    return code;
+}
+
+/**
+ * @brief Завершает программу текущего потока: возврат из user_run()
+ * @note Вызывать из системного вызова или исключения кольца 3
+ */
+void user_exit_current(const s32 code) {
+    user_exit(thread_current()->user_esp0, code);
+}
+
+/**
+ * @brief Снимает программу, вызвавшую исключение
+ * @param[in] regs   Кадр исключения из кольца 3
+ * @param[in] reason Описание для сообщения
+ */
+void user_kill(registers_t *regs, const char *reason) {
+    colored_print(0x04, "\nUser program killed: %s (eip %p)\n", reason, regs->eip);
+    user_exit_current(-(s32) regs->int_no - 1);
+}
+
+/** @} */ // Конец группы user
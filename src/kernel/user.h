@@ -0,0 +1,23 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef USER_H
+#define USER_H
+
+#include "../common.h"
+#include "../cpu/isr.h"
+#include "../mm/paging.h"
+
+#define USER_BASE       0x00400000          // Ниже - ловушка нулевых указателей
+#define USER_STACK_TOP  KERNEL_VIRT_BASE    // Стек растет вниз от границы ядра
+#define USER_STACK_SIZE 0x100000            // Стек программы (exec.c), страницы по требованию
+
+s32 user_map(u32 virt, u32 size, u32 flags);
+void user_unmap(u32 virt, u32 size);
+s32 user_access_ok(u32 addr, u32 size);
+s32 user_run(u32 entry, u32 esp);
+void user_exit_current(s32 code);
+void user_kill(registers_t *regs, const char *reason);
+
+#endif //USER_H
@@ -0,0 +1,321 @@
+/**
+* @file paging.c
+ * @brief Страничная адресация: ядро в верхней половине, страницы 4 MB и 4 KB
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup paging Страничная адресация
+ * @{
+ */
+
+#include "paging.h"
+#include "pmm.h"
+#include "../string.h"
+#include "../cpu/isr.h"
+#include "../cpu/cpuid.h"
+#include "../drivers/print.h"
+#include "../kernel/user.h"
+#include "../kernel/exec.h"
+
+#define CR4_PGE 0x80
+
+extern u32 boot_page_directory[]; ///< Собран в _start (kernel_entry.asm)
+
+static u32 *kernel_directory;
+static u32 *current_directory;   ///< Нижняя половина - программа (exec.c) или ядро
+static u32 global_flag;          ///< PTE_GLOBAL, если процессор поддерживает PGE
+static u32 kmap_next = KMAP_WINDOW_BASE; ///< Начало свободной части окна 4 KB
+
+static inline u32 read_cr2() {
+    u32 value;
+    __asm__ volatile("mov %%cr2, %0" : "=r" (value));
+    return value;
+}
+
+static inline u32 read_cr4() {
+    u32 value;
+    __asm__ volatile("mov %%cr4, %0" : "=r" (value));
+    return value;
+}
+
+static inline void write_cr4(const u32 value) {
+    __asm__ volatile("mov %0, %%cr4" : : "r" (value) : "memory");
+}
+
+static inline void write_cr3(const u32 value) {
+    __asm__ volatile("mov %0, %%cr3" : : "r" (value) : "memory");
+}
+
+/**
+ * @brief Каталог, отвечающий за адрес: нижняя половина - текущей программы
+ */
+static u32 *directory_for(const u32 virt) {
+    return virt < KERNEL_VIRT_BASE ? current_directory : kernel_directory;
+}
+
+/**
+ * @brief Обработчик #PF: подкачка страниц программы, иначе сообщение и остановка
+ * @note Обращение к нижней половине сначала отдается exec_page_fault():
+ *       страницы программы появляются при первом обращении, в том числе
+ *       из системного вызова. Ошибка в кольце 3 снимает программу
+ */
+static void page_fault_handler(registers_t *regs) {
+    const u32 addr = read_cr2();
+    const u32 err = regs->err_code;
+
+    if (addr < KERNEL_VIRT_BASE && exec_page_fault(addr, err, regs->eflags & 0x200) == 0) {
+        return; // 0x200 - IF прерванного кода
+    }
+    if (err & PF_ERR_USER) {
+        colored_print(0x04, "\nPage fault at %p: %s, %s\n", addr,
+                      (err & PF_ERR_PRESENT) ? "protection" : "not present",
+                      (err & PF_ERR_WRITE) ? "write" : "read");
+        user_kill(regs, "Page Fault");
+    }
+
+    colored_print(0x04, "\nPage fault at %p (eip %p): %s, %s, %s\n", addr, regs->eip,
+                  (err & PF_ERR_PRESENT) ? "protection" : "not present",
+                  (err & PF_ERR_WRITE) ? "write" : "read",
+                  (err & PF_ERR_USER) ? "user" : "kernel");
+    while (1) {
+        __asm__ volatile("cli; hlt");
+    }
+}
+
+/**
+ * @brief Таблица страниц для записи каталога
+ * @param[in] virt   Виртуальный адрес
+ * @param[in] create Создать таблицу, если ее нет
+ * @return Указатель на таблицу (через прямое отображение) или 0
+ *
+ * @note Запись с PDE_LARGE разбивается на таблицу из 1024 страниц 4 KB,
+ *       отображающих те же 4 MB с теми же правами
+ */
+static u32 *get_table(const u32 virt, const u8 create) {
+    u32 *pde = &directory_for(virt)[PDE_INDEX(virt)];
+
+    if ((*pde & PTE_PRESENT) && !(*pde & PDE_LARGE)) {
+        return PHYS_TO_VIRT(*pde & ~PTE_FLAGS_MASK);
+    }
+    if (!create) {
+        return 0;
+    }
+
+    const u32 table_phys = alloc_page();
+    if (table_phys == 0) {
+        return 0;
+    }
+    u32 *table = PHYS_TO_VIRT(table_phys);
+
+    if (*pde & PTE_PRESENT) {
+        const u32 base = *pde & ~(LARGE_PAGE_SIZE - 1);
+        const u32 flags = *pde & PTE_FLAGS_MASK & ~PDE_LARGE;
+        u32 i;
+        for (i = 0; i < 1024; i++) {
+            table[i] = (base + i * PAGE_SIZE) | flags;
+        }
+    } else {
+        memset(table, 0, PAGE_SIZE);
+    }
+
+    // Права задаются на уровне PTE, каталог их не ограничивает
+    *pde = table_phys | PTE_PRESENT | PTE_WRITE | PTE_USER;
+    invlpg(virt & ~(LARGE_PAGE_SIZE - 1));
+    return table;
+}
+
+/**
+ * @brief Включает глобальные страницы и убирает тождественное окно загрузки
+ *
+ * Каталог страниц собирает _start: 0-768 MB физической памяти отображены
+ * с KERNEL_VIRT_BASE страницами 4 MB, так что ядро, его данные и все
+ * метаданные PMM покрываются парой записей TLB. Записи ядра помечаются
+ * глобальными и переживают смену CR3 при переключении адресных пространств.
+ *
+ * @note Вызывать после gdt_init(): GDT загрузчика лежит в первом мегабайте
+ */
+void paging_init() {
+    u32 i;
+
+    kernel_directory = boot_page_directory;
+    current_directory = kernel_directory;
+
+    if (cpuid_features_edx() & CPUID_FEAT_EDX_PGE) {
+        global_flag = PTE_GLOBAL;
+        write_cr4(read_cr4() | CR4_PGE);
+        for (i = PDE_INDEX(KERNEL_VIRT_BASE); i < 1024; i++) {
+            if (kernel_directory[i] & PTE_PRESENT) {
+                kernel_directory[i] |= PTE_GLOBAL;
+            }
+        }
+    }
+
+    kernel_directory[0] = 0; // Нулевой указатель теперь вызывает #PF
+    write_cr3(VIRT_TO_PHYS(kernel_directory));
+
+    register_interrupt_handler(14, page_fault_handler);
+}
+
+/**
+ * @brief Отображает страницу 4 KB
+ * @param[in] virt  Виртуальный адрес (выравнивается вниз до страницы)
+ * @param[in] phys  Физический адрес
+ * @param[in] flags PTE_WRITE, PTE_USER, PTE_NOCACHE и т.д.
+ * @return 0 или -1, если не хватило памяти под таблицу страниц
+ *
+ * @note Страницы ядра (выше KERNEL_VIRT_BASE) становятся глобальными
+ */
+s32 map_page(const u32 virt, const u32 phys, u32 flags) {
+    u32 *table = get_table(virt, 1);
+    if (table == 0) {
+        return -1;
+    }
+
+    if (virt >= KERNEL_VIRT_BASE) {
+        flags |= global_flag;
+    }
+    table[PTE_INDEX(virt)] = PAGE_ALIGN_DOWN(phys) | (flags & PTE_FLAGS_MASK) | PTE_PRESENT;
+    invlpg(virt);
+    return 0;
+}
+
+/**
+ * @brief Снимает отображение страницы 4 KB
+ * @param[in] virt Виртуальный адрес
+ *
+ * @note Физическая страница не освобождается - ею владеет вызывающий
+ */
+void unmap_page(const u32 virt) {
+    u32 *table = get_table(virt, 0);
+    if (table == 0 && (directory_for(virt)[PDE_INDEX(virt)] & PDE_LARGE)) {
+        table = get_table(virt, 1); // Дыра внутри страницы 4 MB
+    }
+    if (table == 0) {
+        return;
+    }
+
+    table[PTE_INDEX(virt)] = 0;
+    invlpg(virt);
+}
+
+/**
+ * @brief Переводит виртуальный адрес в физический по таблицам страниц
+ * @param[in] virt Виртуальный адрес
+ * @return Физический адрес или 0, если адрес не отображен
+ */
+u32 paging_translate(const u32 virt) {
+    const u32 pde = directory_for(virt)[PDE_INDEX(virt)];
+
+    if (!(pde & PTE_PRESENT)) {
+        return 0;
+    }
+    if (pde & PDE_LARGE) {
+        return (pde & ~(LARGE_PAGE_SIZE - 1)) + (virt & (LARGE_PAGE_SIZE - 1));
+    }
+
+    const u32 *table = PHYS_TO_VIRT(pde & ~PTE_FLAGS_MASK);
+    const u32 pte = table[PTE_INDEX(virt)];
+    if (!(pte & PTE_PRESENT)) {
+        return 0;
+    }
+    return (pte & ~PTE_FLAGS_MASK) + (virt & PTE_FLAGS_MASK);
+}
+
+/**
+ * @brief Отображает физический диапазон (регистры устройств, таблицы BIOS)
+ * @param[in] phys  Физический адрес
+ * @param[in] size  Размер в байтах
+ * @param[in] flags Дополнительные флаги PTE (PTE_NOCACHE для MMIO)
+ * @return Виртуальный адрес, соответствующий phys, или 0
+ *
+ * @note Диапазон внутри прямого отображения возвращается как есть, иначе
+ *       под него занимаются страницы окна KMAP_WINDOW_BASE. Окно выделяется
+ *       навсегда: отображения устройств ядра не снимаются. Вызывать при
+ *       инициализации, до запуска других процессоров
+ */
+void *ioremap(const u32 phys, const u32 size, const u32 flags) {
+    if (phys < DIRECT_MAP_SIZE && size <= DIRECT_MAP_SIZE - phys) {
+        return PHYS_TO_VIRT(phys);
+    }
+
+    const u32 offset = phys & (PAGE_SIZE - 1);
+    const u32 pages = PAGE_ALIGN_UP(offset + size) >> PAGE_SHIFT;
+    u32 i;
+
+    if (pages > (0u - kmap_next) >> PAGE_SHIFT) {
+        return 0;
+    }
+    for (i = 0; i < pages; i++) {
+        if (map_page(kmap_next + i * PAGE_SIZE, PAGE_ALIGN_DOWN(phys) + i * PAGE_SIZE,
+                     PTE_WRITE | flags) != 0) {
+            return 0;
+        }
+    }
+
+    const u32 virt = kmap_next;
+    kmap_next += pages * PAGE_SIZE;
+    return (void *) (virt + offset);
+}
+
+/**
+ * @brief Каталог страниц ядра (виртуальный адрес)
+ */
+u32 *paging_kernel_directory() {
+    return kernel_directory;
+}
+
+/**
+ * @brief Создает каталог для адресного пространства программы
+ * @return Каталог (виртуальный адрес) или 0, если нет памяти
+ * @details Нижняя половина пуста, верхняя - копия записей ядра
+ */
+u32 *paging_create_directory() {
+    const u32 phys = alloc_page();
+    if (phys == 0) {
+        return 0;
+    }
+
+    u32 *directory = PHYS_TO_VIRT(phys);
+    const u32 kernel_pdes = PDE_INDEX(KERNEL_VIRT_BASE);
+    memset(directory, 0, kernel_pdes * 4);
+    memcpy(&directory[kernel_pdes], &kernel_directory[kernel_pdes], (1024 - kernel_pdes) * 4);
+    return directory;
+}
+
+/**
+ * @brief Освобождает каталог программы и таблицы его нижней половины
+ * @note Страницы программы освобождает владелец (exec.c); каталог не
+ *       должен быть текущим
+ */
+void paging_destroy_directory(u32 *directory) {
+    u32 i;
+
+    for (i = 0; i < PDE_INDEX(KERNEL_VIRT_BASE); i++) {
+        if ((directory[i] & PTE_PRESENT) && !(directory[i] & PDE_LARGE)) {
+            free_page(directory[i] & ~PTE_FLAGS_MASK);
+        }
+    }
+    free_page(VIRT_TO_PHYS(directory));
+}
+
+/**
+ * @brief Переключает адресное пространство своего процессора
+ * @param[in] directory Каталог программы или 0 - каталог ядра
+ *
+ * @note Записи ядра копируются заново: новые таблицы страниц (ioremap())
+ *       появляются только в каталоге ядра. Записи ядра глобальные и при
+ *       смене CR3 остаются в TLB. Потоки живут на загрузочном процессоре,
+ *       поэтому текущий каталог один на всю систему
+ */
+void paging_switch(u32 *directory) {
+    const u32 kernel_pdes = PDE_INDEX(KERNEL_VIRT_BASE);
+
+    if (directory == 0) {
+        directory = kernel_directory;
+    } else {
+        memcpy(&directory[kernel_pdes], &kernel_directory[kernel_pdes], (1024 - kernel_pdes) * 4);
+    }
+    current_directory = directory;
+    write_cr3(VIRT_TO_PHYS(directory));
+}
+
+/** @} */ // Конец группы paging
@@ -0,0 +1,59 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef PAGING_H
+#define PAGING_H
+
+#include "../common.h"
+
+/**
+ * Раскладка виртуальной памяти:
+ *   0x00000000 - 0xBFFFFFFF  пространство пользователя
+ *   0xC0000000 - 0xEFFFFFFF  прямое отображение физической памяти 0-768 MB
+ *                            страницами 4 MB (в нем лежит и само ядро)
+ *   0xF0000000 - 0xFFFFFFFF  окно для страниц 4 KB (MMIO, временные отображения)
+ * Должно совпадать с boot/kernel_entry.asm.
+ */
+#define KERNEL_VIRT_BASE 0xC0000000
+#define DIRECT_MAP_SIZE  0x30000000
+#define KMAP_WINDOW_BASE (KERNEL_VIRT_BASE + DIRECT_MAP_SIZE)
+
+#define PTE_PRESENT  0x001
+#define PTE_WRITE    0x002
+#define PTE_USER     0x004
+#define PTE_PWT      0x008
+#define PTE_NOCACHE  0x010
+#define PTE_ACCESSED 0x020
+#define PTE_DIRTY    0x040
+#define PDE_LARGE    0x080  // PSE: запись каталога отображает 4 MB
+#define PTE_GLOBAL   0x100  // Не сбрасывается из TLB при смене CR3
+
+#define PF_ERR_PRESENT 0x1   // Код ошибки #PF: нарушение прав, а не отсутствие
+#define PF_ERR_WRITE   0x2
+#define PF_ERR_USER    0x4
+
+#define PTE_FLAGS_MASK 0xFFF
+#define LARGE_PAGE_SIZE 0x400000
+
+#define PDE_INDEX(virt) ((virt) >> 22)
+#define PTE_INDEX(virt) (((virt) >> 12) & 0x3FF)
+
+void paging_init();
+s32 map_page(u32 virt, u32 phys, u32 flags);
+void unmap_page(u32 virt);
+u32 paging_translate(u32 virt);
+void *ioremap(u32 phys, u32 size, u32 flags);
+u32 *paging_kernel_directory();
+u32 *paging_create_directory();
+void paging_destroy_directory(u32 *directory);
+void paging_switch(u32 *directory);
+
+/**
+ * @brief Сбрасывает одну запись TLB
+ */
+static inline void invlpg(const u32 virt) {
+    __asm__ volatile("invlpg (%0)" : : "r" (virt) : "memory");
+}
+
+#endif //PAGING_H
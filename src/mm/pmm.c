@@ -0,0 +1,408 @@
+/**
+* @file pmm.c
+ * @brief Менеджер физической памяти: битовая карта и система двойников
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup pmm Физическая память
+ * @{
+ */
+
+#include "pmm.h"
+#include "../string.h"
+#include "../drivers/print.h"
+#include "../kernel/command.h"
+#include "../kernel/spinlock.h"
+
+/**
+ * @brief Конец образа ядра вместе с .bss (из linker.ld)
+ */
+extern u8 _kernel_end[];
+
+/**
+ * @brief Узел списка свободных блоков
+ * @details Хранится прямо в первой странице свободного блока,
+ * поэтому списки не требуют отдельной памяти
+ */
+typedef struct free_block {
+    struct free_block *next;
+    struct free_block *prev;
+} free_block_t;
+
+/**
+ * @brief Карта занятости страниц: бит N = 1 - страница N занята
+ */
+static u32 *frame_bitmap;
+
+/**
+ * @brief Карты свободных блоков по порядкам
+ * @details Бит i в order_bitmap[k] означает, что блок из 2^k страниц,
+ * начинающийся со страницы i << k, свободен и лежит в free_area[k].
+ * Через них за O(1) проверяется, свободен ли двойник при слиянии.
+ */
+static u32 *order_bitmap[PMM_MAX_ORDER + 1];
+
+static free_block_t *free_area[PMM_MAX_ORDER + 1];
+static u32 free_blocks[PMM_MAX_ORDER + 1];
+
+static u32 frame_count = 0;     ///< Страниц до верхней границы памяти
+static u32 total_frames = 0;    ///< Страниц в свободных областях E820
+static u32 free_frames = 0;
+static u32 reserved_frames = 0;
+
+static const boot_info_t *boot_info = 0;
+
+/**
+ * @brief Блокировка списков и карт: страницы берут все процессоры
+ * @details Прерывания на время захвата запрещаются, поэтому выделять
+ * страницы можно и из обработчиков.
+ */
+static spinlock_t pmm_lock = SPINLOCK_INIT;
+
+static u8 bit_test(const u32 *map, const u32 bit) {
+    return (map[bit >> 5] >> (bit & 31)) & 1;
+}
+
+static void bit_set(u32 *map, const u32 bit) {
+    map[bit >> 5] |= 1u << (bit & 31);
+}
+
+static void bit_clear(u32 *map, const u32 bit) {
+    map[bit >> 5] &= ~(1u << (bit & 31));
+}
+
+/**
+ * @brief Заполняет диапазон страниц в frame_bitmap
+ * @param[in] start Первая страница
+ * @param[in] end Страница за последней (обрезается по frame_count)
+ * @param[in] value 1 - занять, 0 - освободить
+ *
+ * @note Целые слова заполняются за одну запись
+ */
+static void frames_fill(u32 start, u32 end, const u8 value) {
+    if (end > frame_count) {
+        end = frame_count;
+    }
+
+    while (start < end && (start & 31)) {
+        value ? bit_set(frame_bitmap, start) : bit_clear(frame_bitmap, start);
+        start++;
+    }
+    while (start + 32 <= end) {
+        frame_bitmap[start >> 5] = value ? 0xFFFFFFFF : 0;
+        start += 32;
+    }
+    while (start < end) {
+        value ? bit_set(frame_bitmap, start) : bit_clear(frame_bitmap, start);
+        start++;
+    }
+}
+
+/**
+ * @brief Добавляет блок в список свободных блоков порядка order
+ */
+static void block_push(const u32 frame, const u32 order) {
+    free_block_t *block = PHYS_TO_VIRT(frame << PAGE_SHIFT);
+
+    block->prev = 0;
+    block->next = free_area[order];
+    if (block->next) {
+        block->next->prev = block;
+    }
+    free_area[order] = block;
+
+    bit_set(order_bitmap[order], frame >> order);
+    free_blocks[order]++;
+}
+
+/**
+ * @brief Удаляет блок из середины списка за O(1)
+ */
+static void block_remove(const u32 frame, const u32 order) {
+    free_block_t *block = PHYS_TO_VIRT(frame << PAGE_SHIFT);
+
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        free_area[order] = block->next;
+    }
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+
+    bit_clear(order_bitmap[order], frame >> order);
+    free_blocks[order]--;
+}
+
+/**
+ * @brief Разбивает диапазон свободных страниц на максимальные выровненные блоки
+ * @param[in] start Первая страница
+ * @param[in] end Страница за последней
+ */
+static void free_range(u32 start, const u32 end) {
+    while (start < end) {
+        u32 order = PMM_MAX_ORDER;
+        while ((start & ((1u << order) - 1)) || start + (1u << order) > end) {
+            order--;
+        }
+        block_push(start, order);
+        start += 1u << order;
+    }
+}
+
+/**
+ * @brief Считает свободные (нулевые) биты frame_bitmap
+ */
+static u32 count_free_frames() {
+    u32 count = 0;
+    u32 frame = 0;
+
+    while (frame < frame_count) {
+        if (frame_bitmap[frame >> 5] == 0xFFFFFFFF && frame + 32 <= frame_count) {
+            frame += 32;
+            continue;
+        }
+        count += !bit_test(frame_bitmap, frame);
+        frame++;
+    }
+    return count;
+}
+
+/**
+ * @brief Инициализирует менеджер физической памяти по карте E820
+ * @param[in] info Информация от загрузчика
+ *
+ * @note Алгоритм:
+ * 1. Верхняя граница памяти - конец последней свободной области (до 4 GB)
+ * 2. Метаданные (карта страниц и карты порядков) размещаются сразу
+ *    за ядром (и за initrd, который загрузчик кладет вслед за ядром),
+ *    их размер пропорционален объему памяти
+ * 3. Свободные области E820 снимаются в карте, остальные области
+ *    (в том числе перекрывающие свободные) помечаются занятыми
+ * 4. Первый мегабайт, ядро, initrd и метаданные резервируются
+ * 5. Свободные участки карты раскладываются по спискам двойников
+ *
+ * Если BIOS не вернул карту, используется область 1-16 MB.
+ */
+void pmm_init(const boot_info_t *info) {
+    static const e820_entry_t fallback = {0x100000, 0xF00000, E820_USABLE, 1};
+    const e820_entry_t *map = info->e820;
+    u32 entries = info->e820_count;
+    u64 top = 0;
+    u32 i;
+
+    boot_info = info;
+    if (entries == 0) {
+        map = &fallback;
+        entries = 1;
+    }
+
+    for (i = 0; i < entries; i++) {
+        const u64 end = map[i].base + map[i].length;
+        if (map[i].type == E820_USABLE && end > top) {
+            top = end;
+        }
+    }
+    // Страницы выше прямого отображения ядру недоступны: в них не положить
+    // даже узел списка свободных блоков
+    if (top > DIRECT_MAP_SIZE) {
+        top = DIRECT_MAP_SIZE;
+    }
+    frame_count = (u32) (top >> PAGE_SHIFT);
+
+    // Метаданные за концом ядра или initrd
+    u32 meta = PAGE_ALIGN_UP((u32) _kernel_end);
+    if (info->initrd_addr && (u32) PHYS_TO_VIRT(info->initrd_addr + info->initrd_size) > meta) {
+        meta = PAGE_ALIGN_UP((u32) PHYS_TO_VIRT(info->initrd_addr + info->initrd_size));
+    }
+    const u32 bitmap_words = (frame_count + 31) / 32;
+    frame_bitmap = (u32 *) meta;
+    memset(frame_bitmap, 0xFF, bitmap_words * 4);
+    meta += bitmap_words * 4;
+
+    for (i = 0; i <= PMM_MAX_ORDER; i++) {
+        const u32 words = ((frame_count >> i) + 32) / 32;
+        order_bitmap[i] = (u32 *) meta;
+        memset(order_bitmap[i], 0, words * 4);
+        meta += words * 4;
+        free_area[i] = 0;
+        free_blocks[i] = 0;
+    }
+    meta = PAGE_ALIGN_UP(meta);
+
+    for (i = 0; i < entries; i++) {
+        if (map[i].type != E820_USABLE || map[i].base >= top) {
+            continue;
+        }
+        u64 end = map[i].base + map[i].length;
+        if (end > top) {
+            end = top;
+        }
+        frames_fill((u32) (PAGE_ALIGN_UP(map[i].base) >> PAGE_SHIFT),
+                    (u32) (PAGE_ALIGN_DOWN(end) >> PAGE_SHIFT), 0);
+    }
+    for (i = 0; i < entries; i++) {
+        if (map[i].type == E820_USABLE || map[i].base >= top) {
+            continue;
+        }
+        u64 end = PAGE_ALIGN_UP(map[i].base + map[i].length);
+        if (end > top) {
+            end = top;
+        }
+        frames_fill((u32) (map[i].base >> PAGE_SHIFT), (u32) (end >> PAGE_SHIFT), 1);
+    }
+    total_frames = count_free_frames();
+
+    frames_fill(0, VIRT_TO_PHYS(meta) >> PAGE_SHIFT, 1);
+    free_frames = count_free_frames();
+    reserved_frames = total_frames - free_frames;
+
+    // Свободные участки карты -> списки двойников
+    u32 frame = 0;
+    while (frame < frame_count) {
+        if (bit_test(frame_bitmap, frame)) {
+            frame++;
+            continue;
+        }
+        u32 end = frame;
+        while (end < frame_count && !bit_test(frame_bitmap, end)) {
+            end++;
+        }
+        free_range(frame, end);
+        frame = end;
+    }
+}
+
+/**
+ * @brief Выделяет 2^order физически непрерывных страниц
+ * @param[in] order Порядок блока (0..PMM_MAX_ORDER)
+ * @return Физический адрес блока (выровнен на его размер) или 0
+ *
+ * @note Берет наименьший подходящий свободный блок и отщепляет
+ *       лишние половины в списки меньших порядков: O(PMM_MAX_ORDER)
+ */
+u32 alloc_pages(const u32 order) {
+    if (order > PMM_MAX_ORDER) {
+        return 0;
+    }
+
+    const u32 flags = spin_lock_irqsave(&pmm_lock);
+    u32 k = order;
+    while (k <= PMM_MAX_ORDER && free_area[k] == 0) {
+        k++;
+    }
+    if (k > PMM_MAX_ORDER) {
+        spin_unlock_irqrestore(&pmm_lock, flags);
+        return 0;
+    }
+
+    const u32 frame = VIRT_TO_PHYS(free_area[k]) >> PAGE_SHIFT;
+    block_remove(frame, k);
+    while (k > order) {
+        k--;
+        block_push(frame + (1u << k), k);
+    }
+
+    frames_fill(frame, frame + (1u << order), 1);
+    free_frames -= 1u << order;
+    spin_unlock_irqrestore(&pmm_lock, flags);
+    return frame << PAGE_SHIFT;
+}
+
+/**
+ * @brief Освобождает блок, выделенный alloc_pages()
+ * @param[in] addr Физический адрес блока
+ * @param[in] order Порядок, с которым блок выделялся
+ *
+ * @note Пока двойник свободен (бит в order_bitmap), блоки сливаются
+ *       в блок следующего порядка: O(PMM_MAX_ORDER)
+ * @warning Повторное освобождение обнаруживается по frame_bitmap
+ *          и игнорируется с предупреждением
+ */
+void free_pages(const u32 addr, u32 order) {
+    u32 frame = addr >> PAGE_SHIFT;
+    const u32 flags = spin_lock_irqsave(&pmm_lock);
+
+    if (order > PMM_MAX_ORDER || frame >= frame_count || !bit_test(frame_bitmap, frame)) {
+        spin_unlock_irqrestore(&pmm_lock, flags);
+        colored_print(0x04, "free_pages: bad free of %p (order %u)\n", addr, order);
+        return;
+    }
+
+    frames_fill(frame, frame + (1u << order), 0);
+    free_frames += 1u << order;
+
+    while (order < PMM_MAX_ORDER) {
+        const u32 buddy = frame ^ (1u << order);
+        if (buddy + (1u << order) > frame_count
+            || !bit_test(order_bitmap[order], buddy >> order)) {
+            break;
+        }
+        block_remove(buddy, order);
+        frame &= ~(1u << order);
+        order++;
+    }
+    block_push(frame, order);
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
+/**
+ * @brief Выделяет одну страницу
+ * @return Физический адрес или 0
+ */
+u32 alloc_page() {
+    return alloc_pages(0);
+}
+
+/**
+ * @brief Освобождает одну страницу
+ */
+void free_page(const u32 addr) {
+    free_pages(addr, 0);
+}
+
+/**
+ * @brief Возвращает снимок статистики
+ */
+void pmm_get_stats(pmm_stats_t *stats) {
+    const u32 flags = spin_lock_irqsave(&pmm_lock);
+    stats->total = total_frames;
+    stats->free = free_frames;
+    stats->reserved = reserved_frames;
+    for (u32 i = 0; i <= PMM_MAX_ORDER; i++) {
+        stats->blocks[i] = free_blocks[i];
+    }
+    spin_unlock_irqrestore(&pmm_lock, flags);
+}
+
+/**
+ * @brief Выводит карту памяти E820 и статистику страниц
+ */
+void pmm_print_stats() {
+    static const char *types[] = {"?", "usable", "reserved", "acpi", "nvs", "bad"};
+
+    if (boot_info) {
+        for (u32 i = 0; i < boot_info->e820_count; i++) {
+            const e820_entry_t *e = &boot_info->e820[i];
+            printf(" %016llx-%016llx %s\n", e->base, e->base + e->length - 1,
+                   e->type <= E820_BAD ? types[e->type] : "?");
+        }
+    }
+
+    printf("Memory: %u KB total, %u KB free, %u KB used (%u KB kernel)\n",
+           total_frames * 4, free_frames * 4,
+           (total_frames - free_frames) * 4, reserved_frames * 4);
+    printf("Free blocks by order:");
+    for (u32 i = 0; i <= PMM_MAX_ORDER; i++) {
+        printf(" %u", free_blocks[i]);
+    }
+    printf("\n");
+}
+
+static s32 cmd_mem(u32 argc, char **argv) {
+    pmm_print_stats();
+    return 0;
+}
+
+COMMAND("mem", cmd_mem, "", "Physical memory map and usage");
+
+/** @} */ // Конец группы pmm
@@ -0,0 +1,45 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef PMM_H
+#define PMM_H
+
+#include "../common.h"
+#include "../kernel/boot_info.h"
+#include "paging.h"
+
+#define PAGE_SIZE  4096
+#define PAGE_SHIFT 12
+
+#define PMM_MAX_ORDER 10 // Крупнейший блок: 2^10 страниц = 4 MB
+
+#define PAGE_ALIGN_UP(addr)   (((addr) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+#define PAGE_ALIGN_DOWN(addr) ((addr) & ~(PAGE_SIZE - 1))
+
+/**
+ * @brief Перевод физического адреса в адрес, доступный ядру
+ * @details Вся управляемая память лежит в прямом отображении (см. paging.h)
+ */
+#define PHYS_TO_VIRT(addr) ((void *) ((u32) (addr) + KERNEL_VIRT_BASE))
+#define VIRT_TO_PHYS(addr) ((u32) (addr) - KERNEL_VIRT_BASE)
+
+/**
+ * @brief Статистика физической памяти (в страницах)
+ */
+typedef struct {
+    u32 total;                      // Управляемые страницы (E820 usable)
+    u32 free;                       // Свободные страницы
+    u32 reserved;                   // Заняты ядром и метаданными при старте
+    u32 blocks[PMM_MAX_ORDER + 1];  // Свободные блоки по порядкам
+} pmm_stats_t;
+
+void pmm_init(const boot_info_t *info);
+u32 alloc_pages(u32 order);
+void free_pages(u32 addr, u32 order);
+u32 alloc_page();
+void free_page(u32 addr);
+void pmm_get_stats(pmm_stats_t *stats);
+void pmm_print_stats();
+
+#endif //PMM_H
@@ -0,0 +1,406 @@
+/**
+* @file slab.c
+ * @brief Куча ядра: slab-кэши объектов и kmalloc()
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup slab Куча ядра
+ * @{
+ */
+
+#include "slab.h"
+#include "pmm.h"
+#include "../string.h"
+#include "../drivers/asm_io.h"
+#include "../drivers/print.h"
+#include "../kernel/command.h"
+#include "../kernel/spinlock.h"
+
+#define SLAB_MAGIC  0x51AB51AB  ///< Заголовок slab
+#define LARGE_MAGIC 0x1A26E000  ///< Заголовок крупного выделения kmalloc()
+#define LARGE_HDR   16          ///< Размер заголовка крупного выделения
+
+/**
+ * @brief Заголовок slab - блока страниц, нарезанного на объекты
+ * @details Лежит в начале блока; свободные объекты связаны в список
+ * через свое первое слово, поэтому выделение и освобождение - O(1)
+ */
+typedef struct slab {
+    u32 magic;
+    kmem_cache_t *cache;
+    struct slab *next;
+    struct slab *prev;
+    void *free;     ///< Список свободных объектов
+    u32 inuse;      ///< Выданных объектов
+} slab_t;
+
+/**
+ * @brief Заголовок крупного выделения (больше 2^KMALLOC_MAX_SHIFT)
+ */
+typedef struct {
+    u32 magic;
+    u32 order;
+} large_hdr_t;
+
+/**
+ * @brief Кэш объектов одного размера
+ * @details slab кочуют между тремя списками по заполненности:
+ * partial (есть и занятые, и свободные объекты), full и empty
+ */
+struct kmem_cache {
+    const char *name;
+    u32 size;           ///< Размер объекта с учетом выравнивания
+    u32 order;          ///< Порядок блока страниц под один slab
+    u32 per_slab;       ///< Объектов в одном slab
+    u32 offset;         ///< Смещение первого объекта от заголовка
+    slab_t *partial;
+    slab_t *full;
+    slab_t *empty;
+    u32 empty_count;
+    u32 slabs;          ///< Всего slab у кэша
+    u32 active;         ///< Выданных объектов
+    u32 allocs;         ///< Счетчик выделений
+    u32 frees;          ///< Счетчик освобождений
+    spinlock_t lock;    ///< Списки slab и счетчики кэша
+    struct kmem_cache *next;
+};
+
+static kmem_cache_t cache_cache;    ///< Кэш дескрипторов кэшей
+static kmem_cache_t *kmalloc_caches[KMALLOC_CLASSES];
+static kmem_cache_t *cache_list = 0;
+
+static u32 large_allocs = 0;
+static u32 large_frees = 0;
+static u32 large_pages = 0;
+
+/**
+ * @brief Блокировка списка кэшей и счетчиков крупных выделений
+ * @details Объекты каждого кэша защищает его собственная блокировка,
+ * так что процессоры, работающие с разными классами, не мешают друг другу.
+ */
+static spinlock_t heap_lock = SPINLOCK_INIT;
+
+static const char *kmalloc_names[KMALLOC_CLASSES] = {
+    "kmalloc-8", "kmalloc-16", "kmalloc-32", "kmalloc-64",
+    "kmalloc-128", "kmalloc-256", "kmalloc-512", "kmalloc-1024"
+};
+
+static void slab_list_push(slab_t **head, slab_t *slab) {
+    slab->prev = 0;
+    slab->next = *head;
+    if (*head) {
+        (*head)->prev = slab;
+    }
+    *head = slab;
+}
+
+static void slab_list_remove(slab_t **head, slab_t *slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        *head = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+}
+
+/**
+ * @brief Заполняет дескриптор кэша и регистрирует его
+ * @param[in] order Порядок slab; для классов kmalloc всегда 0,
+ *                  чтобы kfree() находил заголовок по маске страницы
+ */
+static void cache_setup(kmem_cache_t *cache, const char *name, u32 size,
+                        const u32 align, const u32 order) {
+    if (size < sizeof(void *)) {
+        size = sizeof(void *);
+    }
+    size = (size + align - 1) & ~(align - 1);
+
+    memset(cache, 0, sizeof(*cache));
+    cache->name = name;
+    cache->size = size;
+    cache->order = order;
+    cache->offset = (sizeof(slab_t) + align - 1) & ~(align - 1);
+    cache->per_slab = ((PAGE_SIZE << order) - cache->offset) / size;
+
+    const u32 flags = spin_lock_irqsave(&heap_lock);
+    cache->next = cache_list;
+    cache_list = cache;
+    spin_unlock_irqrestore(&heap_lock, flags);
+}
+
+/**
+ * @brief Выделяет и нарезает новый slab
+ * @return Новый slab со всеми объектами в списке свободных или 0
+ */
+static slab_t *cache_grow(kmem_cache_t *cache) {
+    const u32 phys = alloc_pages(cache->order);
+    if (phys == 0) {
+        return 0;
+    }
+
+    slab_t *slab = PHYS_TO_VIRT(phys);
+    slab->magic = SLAB_MAGIC;
+    slab->cache = cache;
+    slab->inuse = 0;
+    slab->free = 0;
+
+    u8 *obj = (u8 *) slab + cache->offset + (cache->per_slab - 1) * cache->size;
+    u32 i = cache->per_slab;
+    while (i--) {
+        *(void **) obj = slab->free;
+        slab->free = obj;
+        obj -= cache->size;
+    }
+
+    cache->slabs++;
+    return slab;
+}
+
+/**
+ * @brief Инициализирует кучу: кэш дескрипторов и классы kmalloc
+ *
+ * @note Вызывать после pmm_init()
+ */
+void kmalloc_init() {
+    cache_list = 0;
+    cache_setup(&cache_cache, "kmem_cache", sizeof(kmem_cache_t), 8, 0);
+
+    for (u32 i = 0; i < KMALLOC_CLASSES; i++) {
+        kmem_cache_t *cache = kmem_cache_alloc(&cache_cache);
+        cache_setup(cache, kmalloc_names[i], 1u << (i + KMALLOC_MIN_SHIFT), 8, 0);
+        kmalloc_caches[i] = cache;
+    }
+}
+
+/**
+ * @brief Создает кэш для объектов одного типа
+ * @param[in] name Имя для статистики (строка должна жить вечно)
+ * @param[in] size Размер объекта
+ * @param[in] align Выравнивание объектов (степень двойки, 0 - 8 байт)
+ * @return Дескриптор кэша или 0 (нет памяти, size == 0, align не степень
+ *         двойки или объект не помещается даже в slab порядка PMM_MAX_ORDER)
+ *
+ * @note Порядок slab подбирается так, чтобы в него помещалось не менее
+ *       SLAB_MIN_OBJECTS объектов
+ */
+kmem_cache_t *kmem_cache_create(const char *name, const u32 size, u32 align) {
+    const u32 max_slab = (u32) PAGE_SIZE << PMM_MAX_ORDER;
+
+    if (align == 0) {
+        align = 8;
+    }
+    if (size == 0 || size > max_slab || align > max_slab || (align & (align - 1))) {
+        return 0;
+    }
+
+    // Размер и смещение первого объекта - как в cache_setup()
+    const u32 obj = ((size < sizeof(void *) ? sizeof(void *) : size) + align - 1) & ~(align - 1);
+    const u32 offset = (sizeof(slab_t) + align - 1) & ~(align - 1);
+    u32 order = 0;
+    while (order < PMM_MAX_ORDER
+           && (((u32) PAGE_SIZE << order) < offset
+               || (((u32) PAGE_SIZE << order) - offset) / obj < SLAB_MIN_OBJECTS)) {
+        order++;
+    }
+    if (((u32) PAGE_SIZE << order) < offset + obj) {
+        return 0; // per_slab был бы 0
+    }
+
+    kmem_cache_t *cache = kmem_cache_alloc(&cache_cache);
+    if (cache == 0) {
+        return 0;
+    }
+    cache_setup(cache, name, size, align, order);
+    return cache;
+}
+
+/**
+ * @brief Выделяет объект из кэша
+ * @return Указатель на объект или 0, если закончилась память
+ *
+ * @note O(1): объект берется из частично заполненного slab,
+ *       при их отсутствии - из пустого или нового
+ */
+void *kmem_cache_alloc(kmem_cache_t *cache) {
+    const u32 flags = spin_lock_irqsave(&cache->lock);
+
+    slab_t *slab = cache->partial;
+    if (slab == 0) {
+        slab = cache->empty;
+        if (slab) {
+            slab_list_remove(&cache->empty, slab);
+            cache->empty_count--;
+        } else {
+            slab = cache_grow(cache);
+            if (slab == 0) {
+                spin_unlock_irqrestore(&cache->lock, flags);
+                return 0;
+            }
+        }
+        slab_list_push(&cache->partial, slab);
+    }
+
+    void *obj = slab->free;
+    slab->free = *(void **) obj;
+    slab->inuse++;
+    if (slab->inuse == cache->per_slab) {
+        slab_list_remove(&cache->partial, slab);
+        slab_list_push(&cache->full, slab);
+    }
+
+    cache->active++;
+    cache->allocs++;
+    spin_unlock_irqrestore(&cache->lock, flags);
+    return obj;
+}
+
+/**
+ * @brief Возвращает объект в кэш
+ * @param[in] cache Кэш, из которого объект был выделен
+ * @param[in] obj Объект
+ *
+ * @note O(1). Опустевший slab остается в запасе (до SLAB_KEEP_EMPTY
+ *       штук), остальные пустые slab сразу возвращаются в pmm
+ */
+void kmem_cache_free(kmem_cache_t *cache, void *obj) {
+    const u32 flags = spin_lock_irqsave(&cache->lock);
+    slab_t *slab = (slab_t *) ((u32) obj & ~((PAGE_SIZE << cache->order) - 1));
+
+    *(void **) obj = slab->free;
+    slab->free = obj;
+
+    if (slab->inuse == cache->per_slab) {
+        slab_list_remove(&cache->full, slab);
+        slab_list_push(&cache->partial, slab);
+    }
+    slab->inuse--;
+
+    if (slab->inuse == 0) {
+        slab_list_remove(&cache->partial, slab);
+        if (cache->empty_count < SLAB_KEEP_EMPTY) {
+            slab_list_push(&cache->empty, slab);
+            cache->empty_count++;
+        } else {
+            slab->magic = 0;
+            free_pages(VIRT_TO_PHYS(slab), cache->order);
+            cache->slabs--;
+        }
+    }
+
+    cache->active--;
+    cache->frees++;
+    spin_unlock_irqrestore(&cache->lock, flags);
+}
+
+/**
+ * @brief Выделяет память из кучи ядра
+ * @param[in] size Размер в байтах
+ * @return Указатель (выровнен минимум на 8 байт) или 0
+ *
+ * @note До 2^KMALLOC_MAX_SHIFT байт - из кэша ближайшего класса
+ *       степени двойки, больше - целыми страницами из pmm (не больше
+ *       блока порядка PMM_MAX_ORDER)
+ */
+void *kmalloc(const u32 size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    if (size <= (1u << KMALLOC_MAX_SHIFT)) {
+        u32 index = 0;
+        while ((1u << (index + KMALLOC_MIN_SHIFT)) < size) {
+            index++;
+        }
+        return kmem_cache_alloc(kmalloc_caches[index]);
+    }
+
+    u32 order = 0;
+    while (order <= PMM_MAX_ORDER && ((u32) PAGE_SIZE << order) < size + LARGE_HDR) {
+        order++;
+    }
+    if (order > PMM_MAX_ORDER || size + LARGE_HDR < size) {
+        return 0; // Больше крупнейшего блока pmm
+    }
+    const u32 phys = alloc_pages(order);
+    if (phys == 0) {
+        return 0;
+    }
+
+    large_hdr_t *hdr = PHYS_TO_VIRT(phys);
+    hdr->magic = LARGE_MAGIC;
+    hdr->order = order;
+    const u32 flags = spin_lock_irqsave(&heap_lock);
+    large_allocs++;
+    large_pages += 1u << order;
+    spin_unlock_irqrestore(&heap_lock, flags);
+    return (u8 *) hdr + LARGE_HDR;
+}
+
+/**
+ * @brief Выделяет обнуленную память из кучи ядра
+ * @see kmalloc()
+ */
+void *kzalloc(const u32 size) {
+    void *ptr = kmalloc(size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Освобождает память, выделенную kmalloc()
+ * @param[in] ptr Указатель (0 допускается)
+ *
+ * @note Заголовок (slab или крупного выделения) всегда лежит в начале
+ *       страницы, которой принадлежит указатель
+ */
+void kfree(void *ptr) {
+    if (ptr == 0) {
+        return;
+    }
+
+    const u32 page = (u32) ptr & ~(PAGE_SIZE - 1);
+    if (*(u32 *) page == SLAB_MAGIC) {
+        const slab_t *slab = (const slab_t *) page;
+        kmem_cache_free(slab->cache, ptr);
+        return;
+    }
+
+    large_hdr_t *hdr = (large_hdr_t *) page;
+    if (hdr->magic == LARGE_MAGIC && (u8 *) ptr == (u8 *) hdr + LARGE_HDR) {
+        hdr->magic = 0;
+        const u32 flags = spin_lock_irqsave(&heap_lock);
+        large_frees++;
+        large_pages -= 1u << hdr->order;
+        spin_unlock_irqrestore(&heap_lock, flags);
+        free_pages(VIRT_TO_PHYS(hdr), hdr->order);
+        return;
+    }
+
+    colored_print(0x04, "kfree: bad pointer %p\n", ptr);
+}
+
+/**
+ * @brief Выводит статистику всех кэшей
+ */
+void slab_print_stats() {
+    printf("%-14s %5s %7s %7s %5s %8s %8s\n",
+           "cache", "size", "active", "total", "slabs", "allocs", "frees");
+    for (const kmem_cache_t *c = cache_list; c; c = c->next) {
+        printf("%-14s %5u %7u %7u %5u %8u %8u\n", c->name, c->size, c->active,
+               c->slabs * c->per_slab, c->slabs, c->allocs, c->frees);
+    }
+    printf("large: %u active, %u pages, %u allocs, %u frees\n",
+           large_allocs - large_frees, large_pages, large_allocs, large_frees);
+}
+
+static s32 cmd_slabinfo(u32 argc, char **argv) {
+    slab_print_stats();
+    return 0;
+}
+
+COMMAND("slabinfo", cmd_slabinfo, "", "Kernel heap caches");
+
+/** @} */ // Конец группы slab
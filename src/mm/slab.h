@@ -0,0 +1,31 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "../common.h"
+
+#define KMALLOC_MIN_SHIFT 3     // Наименьший класс kmalloc: 8 байт
+#define KMALLOC_MAX_SHIFT 10    // Наибольший класс kmalloc: 1024 байта
+#define KMALLOC_CLASSES (KMALLOC_MAX_SHIFT - KMALLOC_MIN_SHIFT + 1)
+
+#define SLAB_MIN_OBJECTS 8      // Минимум объектов в slab пользовательского кэша
+#define SLAB_KEEP_EMPTY  1      // Пустых slab, которые кэш держит про запас
+
+typedef struct kmem_cache kmem_cache_t;
+
+void kmalloc_init();
+
+kmem_cache_t *kmem_cache_create(const char *name, u32 size, u32 align);
+void *kmem_cache_alloc(kmem_cache_t *cache);
+void kmem_cache_free(kmem_cache_t *cache, void *obj);
+
+void *kmalloc(u32 size);
+void *kzalloc(u32 size);
+void kfree(void *ptr);
+
+void slab_print_stats();
+
+#endif //SLAB_H
@@ -0,0 +1,284 @@
+/**
+* @file string.c
+ * @brief Функции работы с памятью и строками для ядра
+ * @author getname
+ * @date 18.10.2026
+ * @defgroup string Память и строки
+ * @{
+ */
+
+#include "string.h"
+#include "cpu/cpuid.h"
+
+/**
+ * @brief Машинное слово, которому разрешено псевдонимить любые данные
+ * @details Нужно для пословного чтения строк без нарушения strict aliasing
+ */
+typedef u32 __attribute__((may_alias)) word_t;
+
+/**
+ * @brief Ненулевое значение, если в слове есть нулевой байт
+ */
+#define HAS_ZERO(w) (((w) - 0x01010101u) & ~(w) & 0x80808080u)
+
+/**
+ * @brief Процессор поддерживает ERMS (быстрые rep movsb/stosb)
+ */
+static u8 string_erms = 0;
+
+/**
+ * @brief Определяет возможности процессора для строковых операций
+ *
+ * @note До вызова используются пути rep movsd/stosd, корректные
+ *       на любом процессоре, поэтому функции можно вызывать и раньше
+ */
+void string_init() {
+    if (cpuid_max_leaf() >= 7) {
+        u32 a, b, c, d;
+        cpuid(7, 0, &a, &b, &c, &d);
+        string_erms = (b & CPUID_EXT_EBX_ERMS) != 0;
+    }
+}
+
+/**
+ * @brief Копирует данные между непересекающимися буферами
+ * @param[out] dst Указатель на приемник данных
+ * @param[in] src Указатель на источник данных
+ * @param[in] len Количество байт для копирования
+ * @return dst
+ *
+ * @note При наличии ERMS копирует одной rep movsb, иначе
+ *       rep movsd по 4 байта и rep movsb для остатка
+ *
+ * @warning Не обрабатывает перекрывающиеся области, см. memmove()
+ */
+void *memcpy(void *dst, const void *src, u32 len) {
+    void *ret = dst;
+
+    if (string_erms) {
+        __asm__ volatile("rep movsb"
+            : "+D" (dst), "+S" (src), "+c" (len) : : "memory");
+        return ret;
+    }
+
+    u32 dwords = len >> 2;
+    len &= 3;
+    __asm__ volatile("rep movsl\n\t"
+                     "mov %3, %%ecx\n\t"
+                     "rep movsb"
+        : "+D" (dst), "+S" (src), "+c" (dwords) : "r" (len) : "memory");
+    return ret;
+}
+
+/**
+ * @brief Копирует данные с учетом перекрытия областей
+ * @param[out] dst Указатель на приемник данных
+ * @param[in] src Указатель на источник данных
+ * @param[in] len Количество байт для копирования
+ * @return dst
+ *
+ * @note Если приемник не начинается внутри источника, используется
+ *       memcpy(). Иначе копирование идет с конца (флаг DF=1):
+ *       сначала хвост побайтно, затем слова по 4 байта.
+ */
+void *memmove(void *dst, const void *src, u32 len) {
+    // Беззнаковое сравнение: dst < src или dst >= src + len
+    if ((u32) dst - (u32) src >= len) {
+        return memcpy(dst, src, len);
+    }
+
+    u8 *d = (u8 *) dst + len - 1;
+    const u8 *s = (const u8 *) src + len - 1;
+    u32 tail = len & 3;
+    const u32 dwords = len >> 2;
+
+    __asm__ volatile("std\n\t"
+                     "rep movsb\n\t"
+                     "sub $3, %%edi\n\t"
+                     "sub $3, %%esi\n\t"
+                     "mov %3, %%ecx\n\t"
+                     "rep movsl\n\t"
+                     "cld"
+        : "+D" (d), "+S" (s), "+c" (tail) : "r" (dwords) : "memory");
+    return dst;
+}
+
+/**
+ * @brief Заполняет память байтом
+ * @param[out] dst Начало области
+ * @param[in] value Значение (используется младший байт)
+ * @param[in] len Количество байт
+ * @return dst
+ */
+void *memset(void *dst, const int value, u32 len) {
+    void *ret = dst;
+    const u32 fill = (u8) value * 0x01010101u;
+
+    if (string_erms) {
+        __asm__ volatile("rep stosb"
+            : "+D" (dst), "+c" (len) : "a" (fill) : "memory");
+        return ret;
+    }
+
+    u32 dwords = len >> 2;
+    len &= 3;
+    __asm__ volatile("rep stosl\n\t"
+                     "mov %3, %%ecx\n\t"
+                     "rep stosb"
+        : "+D" (dst), "+c" (dwords) : "a" (fill), "r" (len) : "memory");
+    return ret;
+}
+
+/**
+ * @brief Заполняет память 16-битными значениями
+ * @param[out] dst Начало области
+ * @param[in] value Значение (например, ячейка VGA: атрибут << 8 | символ)
+ * @param[in] count Количество 16-битных элементов
+ * @return dst
+ *
+ * @note Пишет по две ячейки за раз через rep stosd
+ */
+u16 *memsetw(u16 *dst, const u16 value, const u32 count) {
+    u16 *ret = dst;
+    const u32 fill = value | ((u32) value << 16);
+    u32 dwords = count >> 1;
+
+    __asm__ volatile("rep stosl"
+        : "+D" (dst), "+c" (dwords) : "a" (fill) : "memory");
+    if (count & 1) {
+        *dst = value;
+    }
+    return ret;
+}
+
+/**
+ * @brief Сравнивает две области памяти
+ * @return 0 - области равны, иначе разница первых различных байт
+ */
+int memcmp(const void *s1, const void *s2, u32 len) {
+    const u8 *a = s1;
+    const u8 *b = s2;
+
+    while (len--) {
+        if (*a != *b) {
+            return *a - *b;
+        }
+        a++;
+        b++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Вычисляет длину строки
+ * @param[in] str Нуль-терминированная строка
+ * @return Количество символов до нулевого байта
+ *
+ * @note После выравнивания проверяет по 4 байта за раз (HAS_ZERO).
+ *       Выровненное чтение не пересекает границу страницы, поэтому
+ *       байты за терминатором читать безопасно.
+ */
+u32 strlen(const char *str) {
+    const char *p = str;
+
+    while ((u32) p & 3) {
+        if (*p == '\0') {
+            return p - str;
+        }
+        p++;
+    }
+
+    const word_t *w = (const word_t *) p;
+    while (!HAS_ZERO(*w)) {
+        w++;
+    }
+
+    p = (const char *) w;
+    while (*p) {
+        p++;
+    }
+    return p - str;
+}
+
+/**
+ * @brief Сравнивает две строки
+ * @param[in] s1 Первая строка для сравнения
+ * @param[in] s2 Вторая строка для сравнения
+ * @return Разницу ASCII-кодов первых различных символов:
+ *         - 0: строки идентичны
+ *         - >0: s1 > s2
+ *         - <0: s1 < s2
+ *
+ * @note Если строки одинаково выровнены, совпадающие части
+ *       сравниваются по 4 байта, пока в слове нет терминатора
+ */
+int strcmp(const char *s1, const char *s2) {
+    if ((((u32) s1 ^ (u32) s2) & 3) == 0) {
+        while ((u32) s1 & 3) {
+            if (*s1 == '\0' || *s1 != *s2) {
+                return *(const unsigned char *) s1 - *(const unsigned char *) s2;
+            }
+            s1++;
+            s2++;
+        }
+
+        const word_t *w1 = (const word_t *) s1;
+        const word_t *w2 = (const word_t *) s2;
+        while (*w1 == *w2 && !HAS_ZERO(*w1)) {
+            w1++;
+            w2++;
+        }
+        s1 = (const char *) w1;
+        s2 = (const char *) w2;
+    }
+
+    // Пока символы совпадают и не достигнут конец строки
+    while (*s1 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+    }
+
+    // Возвращаем разницу между ASCII-кодами символов
+    return *(const unsigned char *) s1 - *(const unsigned char *) s2;
+}
+
+/**
+ * @brief Сравнивает не более n символов двух строк
+ * @return Аналогично strcmp()
+ */
+int strncmp(const char *s1, const char *s2, u32 n) {
+    while (n && *s1 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+        n--;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    return *(const unsigned char *) s1 - *(const unsigned char *) s2;
+}
+
+/**
+ * @brief Копирует строку вместе с терминатором
+ * @return dst
+ *
+ * @warning Не проверяет размер приемника
+ */
+char *strcpy(char *dst, const char *src) {
+    return memcpy(dst, src, strlen(src) + 1);
+}
+
+/**
+ * @brief Разбирает десятичное число без знака
+ * @return Значение начальных цифр строки (0, если цифр нет)
+ */
+u32 atoi(const char *str) {
+    u32 value = 0;
+
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str++ - '0');
+    }
+    return value;
+}
+
+/** @} */ // Конец группы string
@@ -0,0 +1,24 @@
+//
+// Created by getname on 18.10.2026.
+//
+
+#ifndef STRING_H
+#define STRING_H
+
+#include "common.h"
+
+void string_init();
+
+void *memcpy(void *dst, const void *src, u32 len);
+void *memmove(void *dst, const void *src, u32 len);
+void *memset(void *dst, int value, u32 len);
+u16 *memsetw(u16 *dst, u16 value, u32 count);
+int memcmp(const void *s1, const void *s2, u32 len);
+
+u32 strlen(const char *str);
+int strcmp(const char *s1, const char *s2);
+int strncmp(const char *s1, const char *s2, u32 n);
+char *strcpy(char *dst, const char *src);
+u32 atoi(const char *str);
+
+#endif //STRING_H
@@ -0,0 +1,46 @@
+; Пример программы для команды run (kernel/exec.c)
+; ------------------------------------------------------------------------------
+;	Собирается в ELF32 с адресом загрузки USER_BASE и кладется в /bin/hello
+;	initrd. BSS на 4 MB: run отображает его на нулевую страницу, и память
+;	занимают только страницы, куда программа пишет, - по одной на каждые
+;	256 KB. Системные вызовы - через int 0x80 (kernel/syscall.h).
+; ------------------------------------------------------------------------------
+
+[bits 32]
+
+SYS_EXIT  equ 0
+SYS_WRITE equ 1
+BSS_SIZE  equ 0x400000
+BSS_STEP  equ 0x40000
+
+global _start
+
+section .text
+
+_start:
+	mov eax, SYS_WRITE
+	mov ebx, message
+	mov esi, message_len
+	int 0x80
+
+	mov edi, buffer         ; Запись выделяет страницу, чтение - нет
+	xor ecx, ecx
+.touch:
+	mov [edi + ecx], ecx
+	add ecx, BSS_STEP
+	cmp ecx, BSS_SIZE
+	jb .touch
+
+	mov eax, [buffer + BSS_SIZE - 4] ; Нетронутая страница читается как 0
+	mov ebx, eax
+	mov eax, SYS_EXIT
+	int 0x80
+
+section .data
+
+message: db "Hello from ring 3", 10
+message_len equ $ - message
+
+section .bss
+
+buffer: resb BSS_SIZE